@@ -6,29 +6,58 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <iostream>
-
-#include "utilities/Shader.h"
-#include "thirdparty/stb_image.h"
-
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+#include "utilities/FixedTimestep.h"
+#include "utilities/FrameArena.h"
+#include "utilities/FrameTimings.h"
+#include "utilities/GLExtensions.h"
+#include "utilities/JobSystem.h"
+#include "utilities/MemoryTracker.h"
+#include "utilities/PngWriter.h"
+#include "utilities/Profiler.h"
+#include "rendering/BlockTextures.h"
+#include "rendering/FrameExchange.h"
+#include "rendering/GLBackend.h"
+#include "rendering/HeadlessContext.h"
+#include "rendering/NullBackend.h"
+#include "rendering/PerfOverlay.h"
+#include "rendering/RenderBackend.h"
+#include "rendering/RenderQueue.h"
+#include "rendering/RenderThread.h"
+
+int framebufferWidth = 0;
+int framebufferHeight = 0;
+bool projectionDirty = true;
+
+// Runs on the main thread, the render thread applies the viewport from the snapshot
 void framebuffer_size_callback(GLFWwindow* window, int width, int height)
 {
-    glViewport(0, 0, width, height);
+    framebufferWidth = width;
+    framebufferHeight = height;
+    projectionDirty = true;
 }
 
+bool vsyncEnabled = true;
+bool vKeyPressed = false;
+
+bool overlayEnabled = false;
+bool f3KeyPressed = false;
+
 int currentDrawMode = 0;
 bool fKeyPressed = false;
 void switchDrawMode()
 {
-    if (currentDrawMode == 0)
-    {
-        currentDrawMode = 1;
-        glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-    }
-    else
-    {
-        currentDrawMode = 0;
-        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-    }
+    // The render thread picks the polygon mode up from the next snapshot
+    currentDrawMode = (currentDrawMode == 0) ? 1 : 0;
 }
 
 void processInput(GLFWwindow* window)
@@ -45,42 +74,250 @@ void processInput(GLFWwindow* window)
     }
 
     fKeyPressed = isFPressed;
+
+    // Toggles between vsync and uncapped rendering, the simulation rate is unaffected
+    bool isVPressed = (glfwGetKey(window, GLFW_KEY_V) == GLFW_PRESS);
+    if (isVPressed && !vKeyPressed)
+    {
+        vsyncEnabled = !vsyncEnabled;
+    }
+
+    vKeyPressed = isVPressed;
+
+    // Shows or hides the performance overlay
+    bool isF3Pressed = (glfwGetKey(window, GLFW_KEY_F3) == GLFW_PRESS);
+    if (isF3Pressed && !f3KeyPressed)
+    {
+        overlayEnabled = !overlayEnabled;
+    }
+
+    f3KeyPressed = isF3Pressed;
 }
 
-int main() {
-    // Initialize GLFW
-    if (!glfwInit()) {
-        std::cerr << "Failed to initialize GLFW" << std::endl;
-        return -1;
+// Everything the fixed-rate simulation produces, interpolated for rendering
+struct SimulationState
+{
+    float SwingDegrees = 0.0f;
+    float SpinDegrees = 0.0f;
+};
+
+SimulationState simulate(double simulationTime)
+{
+    SimulationState state;
+    state.SwingDegrees = (float)(sin(simulationTime) * 100.0);
+    state.SpinDegrees = (float)(simulationTime * 100.0);
+    return state;
+}
+
+// Runs after main returns, once everything tracked should have been freed
+void reportLeaks()
+{
+    MemoryTracker::printLeaks(std::cout);
+}
+
+SimulationState interpolate(const SimulationState& previous, const SimulationState& current, float alpha)
+{
+    SimulationState state;
+    state.SwingDegrees = previous.SwingDegrees + (current.SwingDegrees - previous.SwingDegrees) * alpha;
+    state.SpinDegrees = previous.SpinDegrees + (current.SpinDegrees - previous.SpinDegrees) * alpha;
+    return state;
+}
+
+int main(int argc, char** argv) {
+    // Command line: --tick-rate <hz> sets the simulation rate, --uncapped starts without vsync,
+    // --cubes <count> adds a field of instanced cubes.
+    // --headless renders --frames <count> frames of --width x --height into an offscreen
+    // framebuffer without a window, --timings <csv> writes the frame times,
+    // --pass-timings <csv> the CPU and GPU time of every render pass, and
+    // --capture <directory> saves every --capture-every <n>th frame as a PNG.
+    // --null-backend runs the same frames without any GL context at all.
+    // --trace <json> keeps profiler zones and writes the most recent as a Chrome trace on exit,
+    // --overlay starts with the performance overlay shown (F3 toggles it).
+    // --memory-report <seconds> logs tracked memory per tag that often (once
+    // at the end of headless runs), --leak-report lists what is left at exit.
+    double tickRate = 60.0;
+    int cubeCount = 0;
+    bool headless = false;
+    bool nullBackend = false;
+    int headlessFrames = 300;
+    int headlessWidth = 1280;
+    int headlessHeight = 720;
+    std::string timingsPath;
+    std::string passTimingsPath;
+    std::string tracePath;
+    std::string captureDirectory;
+    int captureEvery = 60;
+    double memoryReportSeconds = 0.0;
+    bool leakReport = false;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        if (argument == "--tick-rate" && i + 1 < argc)
+        {
+            tickRate = std::atof(argv[++i]);
+        }
+        else if (argument == "--cubes" && i + 1 < argc)
+        {
+            cubeCount = std::max(0, std::atoi(argv[++i]));
+        }
+        else if (argument == "--uncapped")
+        {
+            vsyncEnabled = false;
+        }
+        else if (argument == "--headless")
+        {
+            headless = true;
+        }
+        else if (argument == "--null-backend")
+        {
+            nullBackend = true;
+        }
+        else if (argument == "--frames" && i + 1 < argc)
+        {
+            headlessFrames = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (argument == "--width" && i + 1 < argc)
+        {
+            headlessWidth = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (argument == "--height" && i + 1 < argc)
+        {
+            headlessHeight = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (argument == "--timings" && i + 1 < argc)
+        {
+            timingsPath = argv[++i];
+        }
+        else if (argument == "--pass-timings" && i + 1 < argc)
+        {
+            passTimingsPath = argv[++i];
+        }
+        else if (argument == "--trace" && i + 1 < argc)
+        {
+            tracePath = argv[++i];
+        }
+        else if (argument == "--memory-report" && i + 1 < argc)
+        {
+            memoryReportSeconds = std::max(0.0, std::atof(argv[++i]));
+        }
+        else if (argument == "--leak-report")
+        {
+            leakReport = true;
+        }
+        else if (argument == "--overlay")
+        {
+            overlayEnabled = true;
+        }
+        else if (argument == "--capture" && i + 1 < argc)
+        {
+            captureDirectory = argv[++i];
+        }
+        else if (argument == "--capture-every" && i + 1 < argc)
+        {
+            captureEvery = std::max(1, std::atoi(argv[++i]));
+        }
     }
 
-    // Set window flags
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-
-    // Create a window with OpenGL context
-    const int WIN_WIDTH = 1280;
-    const int WIN_HEIGHT = 720;
-    GLFWwindow* window = glfwCreateWindow(WIN_WIDTH, WIN_HEIGHT, "GLFW Test Window", nullptr, nullptr);
-    if (!window) {
-        std::cerr << "Failed to create GLFW window" << std::endl;
-        glfwTerminate();
-        return -1;
+    Profiler::setThreadName("Main");
+    if (!tracePath.empty())
+    {
+        Profiler::beginCapture();
     }
 
-    // Make the window's context current
-    glfwMakeContextCurrent(window);
+    // One worker per core, this thread is worker 0 and runs jobs while it waits
+    JobSystem jobs;
+    if (leakReport)
+    {
+        std::atexit(reportLeaks);
+    }
+    MemoryTracker::Snapshot lastMemoryReport = MemoryTracker::takeSnapshot();
+
+    // Headless runs get their context from EGL instead of a GLFW window
+    GLFWwindow* window = nullptr;
+    HeadlessContext headlessContext;
+    GLADloadproc loadProc = nullptr;
+
+    if (nullBackend)
+    {
+        framebufferWidth = headlessWidth;
+        framebufferHeight = headlessHeight;
+    }
+    else if (headless)
+    {
+        if (!headlessContext.create()) {
+            std::cerr << "Failed to create headless context" << std::endl;
+            return -1;
+        }
+        loadProc = (GLADloadproc)HeadlessContext::getProcAddress;
+        framebufferWidth = headlessWidth;
+        framebufferHeight = headlessHeight;
+    }
+    else
+    {
+        // Initialize GLFW
+        if (!glfwInit()) {
+            std::cerr << "Failed to initialize GLFW" << std::endl;
+            return -1;
+        }
+
+        // Set window flags
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+        // Create a window with OpenGL context
+        const int WIN_WIDTH = 1280;
+        const int WIN_HEIGHT = 720;
+        window = glfwCreateWindow(WIN_WIDTH, WIN_HEIGHT, "GLFW Test Window", nullptr, nullptr);
+        if (!window) {
+            std::cerr << "Failed to create GLFW window" << std::endl;
+            glfwTerminate();
+            return -1;
+        }
+
+        // Make the window's context current
+        glfwMakeContextCurrent(window);
+        loadProc = (GLADloadproc)glfwGetProcAddress;
+    }
 
     // Initialize GLAD
-    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+    if (loadProc && !gladLoadGLLoader(loadProc)) {
         std::cerr << "Failed to initialize GLAD" << std::endl;
-        glfwDestroyWindow(window);
-        glfwTerminate();
+        if (window)
+        {
+            glfwDestroyWindow(window);
+            glfwTerminate();
+        }
         return -1;
     }
 
-    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    if (window)
+    {
+        glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    }
+
+    // Everything GPU-side goes through the backend, the null backend only counts
+    std::unique_ptr<RenderBackend> backend;
+    GLBackend* glBackend = nullptr;
+    if (nullBackend)
+    {
+        backend = std::make_unique<NullBackend>();
+    }
+    else
+    {
+        GLExtensions::load(loadProc);
+        std::unique_ptr<GLBackend> createdBackend = std::make_unique<GLBackend>(std::string(PROJECT_ROOT) + "/cache/shaders");
+        glBackend = createdBackend.get();
+        backend = std::move(createdBackend);
+    }
+
+    // Request every program up front so the driver compiles them while the
+    // rest of startup runs, warm starts load linked binaries from the cache
+    backend->registerProgram("default", "default_vertex.glsl", "default_fragment.glsl", { "INSTANCED", "VERTEX_COLOR" });
+    backend->registerProgram("overlay", "overlay_vertex.glsl", "overlay_fragment.glsl", {});
+    ProgramHandle defaultProgram = backend->createProgram("default", {});
+    ProgramHandle instancedProgram = backend->createProgram("default", { "INSTANCED" });
+    ProgramHandle overlayProgram = backend->createProgram("overlay", {});
 
     // Triangle data
     float cubeVertices[] = {
@@ -148,153 +385,341 @@ int main() {
         21, 22, 23
     };
 
-    // Triangle Texture Object
-    unsigned int texture;
-    glGenTextures(1, &texture);
-    glBindTexture(GL_TEXTURE_2D, texture);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    
-    // Load the texture data
-    int textureWidth;
-    int textureHeight;
-    int numOfColorChannels;
-    stbi_set_flip_vertically_on_load(true);
-
-    std::string imagePath = std::string(PROJECT_ROOT) + "/assets/textures/test_texture.png";
-    unsigned char* data = stbi_load(imagePath.c_str(), & textureWidth, & textureHeight, & numOfColorChannels, 0);
-
-    if (data)
+    // Block Textures
+    // Every block texture is a layer of one texture array, decoded in parallel
+    BlockTextures blockTextures;
+    int testTextureLayer = blockTextures.registerTexture("test_texture.png");
+
+    // Warm starts map the baked cache instead of decoding PNGs
+    auto textureLoadStart = std::chrono::steady_clock::now();
+    std::string textureCachePath = std::string(PROJECT_ROOT) + "/cache/block_textures.bin";
+    bool textureCacheHit = blockTextures.load(*backend, textureCachePath, jobs);
+    std::chrono::duration<double, std::milli> textureLoadTime = std::chrono::steady_clock::now() - textureLoadStart;
+
+    std::cout << "Block textures loaded in " << textureLoadTime.count() << " ms ("
+        << (textureCacheHit ? "warm, from cache" : "cold, decoded") << ")\n";
+
+    // Cube mesh, shared by the single cube and every instanced one
+    MeshData cubeData;
+    cubeData.Vertices.assign(std::begin(cubeVertices), std::end(cubeVertices));
+    cubeData.Indices.assign(std::begin(indices), std::end(indices));
+    MeshHandle cubeMesh = backend->createMesh(cubeData);
+
+    // Each cube spins around its own axis, laid out on a grid in front of the camera
+    struct CubeMotion
     {
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, textureWidth, textureHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-        //glGenerateMipmap(GL_TEXTURE_2D);
-    }
-    else
+        glm::vec3 Position;
+        glm::vec3 Axis;
+        float Speed;
+    };
+    std::vector<CubeMotion> cubeMotions(cubeCount);
+    int gridSide = (int)std::ceil(std::cbrt((double)cubeCount));
+    for (int i = 0; i < cubeCount; i++)
     {
-        std::cout << "Texture image data did not load successfully: " << imagePath << '\n';
+        int x = i % gridSide;
+        int y = (i / gridSide) % gridSide;
+        int z = i / (gridSide * gridSide);
+        float spacing = 1.5f;
+        float offset = (gridSide - 1) * spacing * 0.5f;
+
+        CubeMotion& motion = cubeMotions[i];
+        motion.Position = glm::vec3(x * spacing - offset, y * spacing - offset, -z * spacing - 4.0f);
+        motion.Axis = glm::normalize(glm::vec3((float)(i % 7) - 3.0f, 1.0f + (float)(i % 5), (float)(i % 3) - 1.0f));
+        motion.Speed = 0.5f + (float)(i % 11) * 0.25f;
     }
 
-    // Free memory 
-    stbi_image_free(data);
-
-    // ==================================
-    // Triangle ONE
-    // ==================================
-    // Generate VAO
-    unsigned int VAO;
-    glGenVertexArrays(1, &VAO);
-    glBindVertexArray(VAO);
-
-    // Generate VBO to go into VAO
-    unsigned int VBO;
-    glGenBuffers(1, &VBO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(cubeVertices), cubeVertices, GL_STATIC_DRAW);
-
-    // Position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 8, (void*)0);
-    glEnableVertexAttribArray(0);
-
-    // Color attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 8, (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-
-    // Texture coordinate attribute
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 8, (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-
-    // Generate EBO to go into VAO
-    unsigned int EBO;
-    glGenBuffers(1, &EBO);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-    
-    Shader normalShader("default_vertex.glsl", "default_fragment.glsl");
-
-    glViewport(0, 0, WIN_WIDTH, WIN_HEIGHT);
-
-    // Enable depth test
-    glEnable(GL_DEPTH_TEST);
-    
-    // Main loop
-    while (!glfwWindowShouldClose(window)) {
-        // =============================
-        // Input
-        //
-        processInput(window);
+    // Frame time graphs and counters, drawn over everything while enabled
+    PerfOverlay perfOverlay;
+    TextureHandle overlayAtlas = backend->createTextureArray(perfOverlay.getAtlas());
 
-        // =============================
-        // Render
-        //
-        glClearColor(1.0f, 1.0f, 1.0f, 0.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    // Draws are recorded as sorted packets and replayed in state change order.
+    // Their per-frame buffers come from arenas owned by the rendering thread.
+    RenderQueue renderQueue(jobs.getWorkerCount());
+    FrameArenas renderArenas(renderQueue.getMaxThreads());
 
-        // =============================
-        // Collect time
-        //
-        float timeValue = glfwGetTime();
-        float sineValue = sin(timeValue) * 100.0f;
+    // The framebuffer can differ from the window size on high DPI displays
+    if (window)
+    {
+        glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+    }
 
-        // =============================
-        // Active Default Shader
-        //
-        normalShader.use();
+    glm::mat4 projectionMatrix = glm::mat4(1.0f);
+
+    // =============================
+    // Render a frame
+    //
+    // Draws whatever a snapshot describes, on whichever thread owns the context
+    auto renderFrame = [&](const FrameSnapshot& frame)
+    {
+        PROFILE_SCOPE("Render frame");
+        backend->beginFrame(frame);
+
+        renderArenas.reset();
+        renderQueue.beginFrame(renderArenas);
+        RenderQueue::Recorder& recorder = renderQueue.getRecorder(0);
+        for (const DrawPacket& packet : frame.Draws)
+        {
+            recorder.submit(packet);
+        }
+        renderQueue.sort();
+        backend->drawPackets(renderQueue.getSorted());
+
+        backend->drawInstances(cubeMesh, instancedProgram, blockTextures.getTexture(), frame.Cubes);
+
+        perfOverlay.recordFrame();
+        if (frame.ShowOverlay)
+        {
+            perfOverlay.build(frame, backend->getFrameStats(), backend->getPassTimings());
+            backend->drawOverlay(overlayProgram, overlayAtlas, perfOverlay.getVertices());
+        }
+
+        backend->endFrame();
+    };
+
+    // =============================
+    // Build a frame
+    //
+    // Describes everything visible at displayTime, the simulation state is already interpolated
+    auto buildFrame = [&](FrameSnapshot& frame, const SimulationState& displayState, double displayTime)
+    {
+        PROFILE_SCOPE("Build frame");
 
         // =============================
         // Create Transformations
         // 
         // Model Matrix
         glm::mat4 modelMatrix = glm::mat4(1.0f);
-        modelMatrix = glm::rotate(modelMatrix, glm::radians(-55.0f + sineValue), glm::vec3(0.0f, 1.0f, 0.0f));
-        modelMatrix = glm::rotate(modelMatrix, glm::radians(-55.0f + (timeValue * 100.0f)), glm::vec3(1.0f, 0.0f, 1.0f));
+        modelMatrix = glm::rotate(modelMatrix, glm::radians(-55.0f + displayState.SwingDegrees), glm::vec3(0.0f, 1.0f, 0.0f));
+        modelMatrix = glm::rotate(modelMatrix, glm::radians(-55.0f + displayState.SpinDegrees), glm::vec3(1.0f, 0.0f, 1.0f));
 
         // View Matrix
-        glm::mat4 viewMatrix = glm::mat4(1.0f);
-        viewMatrix = glm::translate(viewMatrix, glm::vec3(0.0f, 0.0f, -3.0));
-
-        // Projection Matrix
-        glm::mat4 projectionMatrix;
-        projectionMatrix = glm::perspective(glm::radians(45.0f), 800.0f / 600.0f, 0.1f, 100.0f);
+        glm::vec3 cameraPosition = glm::vec3(0.0f, 0.0f, 3.0f);
+        glm::mat4 viewMatrix = glm::translate(glm::mat4(1.0f), -cameraPosition);
+
+        // Projection Matrix, only rebuilt when the framebuffer is resized
+        if (projectionDirty && framebufferWidth > 0 && framebufferHeight > 0)
+        {
+            float aspectRatio = (float)framebufferWidth / (float)framebufferHeight;
+            projectionMatrix = glm::perspective(glm::radians(45.0f), aspectRatio, 0.1f, 100.0f);
+            projectionDirty = false;
+        }
+
+        frame.FramebufferWidth = framebufferWidth;
+        frame.FramebufferHeight = framebufferHeight;
+        frame.Wireframe = (currentDrawMode == 1);
+        frame.SwapInterval = vsyncEnabled ? 1 : 0;
+        frame.ShowOverlay = overlayEnabled;
+        frame.View = viewMatrix;
+        frame.Projection = projectionMatrix;
+        frame.CameraPosition = cameraPosition;
+        frame.Counters.JobsQueued = jobs.getQueuedCount();
+
+        DrawPacket cubePacket;
+        cubePacket.Program = defaultProgram;
+        cubePacket.Mesh = cubeMesh;
+        cubePacket.Texture = blockTextures.getTexture();
+        cubePacket.TextureLayer = (float)testTextureLayer;
+        cubePacket.Model = modelMatrix;
+        cubePacket.Key = RenderQueue::makeKey(RenderQueue::PASS_OPAQUE, cubePacket.Program, cubePacket.Texture,
+            glm::length(glm::vec3(modelMatrix[3]) - cameraPosition));
+        frame.Draws.push_back(cubePacket);
+
+        frame.Cubes.resize(cubeMotions.size());
+        for (size_t i = 0; i < cubeMotions.size(); i++)
+        {
+            const CubeMotion& motion = cubeMotions[i];
+            MeshInstance& instance = frame.Cubes[i];
+            instance.Position = motion.Position;
+            instance.Scale = 0.5f;
+            instance.setRotation(glm::angleAxis((float)displayTime * motion.Speed, motion.Axis));
+            instance.TextureLayer = (float)testTextureLayer;
+        }
+    };
 
-        // Send matrices to the default shader
-        int modelLoc = glGetUniformLocation(normalShader.Id, "sModelMatrix");
-        glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(modelMatrix));
+    FixedTimestep timestep(tickRate);
 
-        int viewLoc = glGetUniformLocation(normalShader.Id, "sViewMatrix");
-        glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(viewMatrix));
+    // =============================
+    // Headless benchmark
+    //
+    // Renders a fixed number of frames into an FBO (or nowhere, with the null
+    // backend) on this thread. Every frame advances the simulation by exactly
+    // one tick, so runs are reproducible.
+    if (headless || nullBackend)
+    {
+        if (glBackend && !glBackend->useOffscreenTarget(framebufferWidth, framebufferHeight))
+        {
+            return -1;
+        }
+
+        FrameSnapshot frame;
+        FrameTimings frameTimings;
+        frameTimings.reserve(headlessFrames);
+        // Captures are written out by a low priority job while the next frames render
+        std::vector<unsigned char> capturePixels;
+        std::string capturePath;
+        JobCounter captureWrite;
+
+        for (int frameIndex = 0; frameIndex < headlessFrames; frameIndex++)
+        {
+            PROFILE_SCOPE("Frame");
+            auto frameStart = std::chrono::steady_clock::now();
+
+            double frameSimulationTime = frameIndex * timestep.getTickDelta();
+            frame.reset();
+            frame.FrameIndex = frameIndex;
+            buildFrame(frame, simulate(frameSimulationTime), frameSimulationTime);
+            frame.MainMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+            renderFrame(frame);
+
+            // Without a swap to pace frames, wait for the GPU so each timing covers the whole frame
+            backend->finish();
+            std::chrono::duration<double, std::milli> frameTime = std::chrono::steady_clock::now() - frameStart;
+            frameTimings.record(frameTime.count());
+
+            int captureWidth = 0;
+            int captureHeight = 0;
+            if (!captureDirectory.empty() && (frameIndex % captureEvery == 0 || frameIndex == headlessFrames - 1))
+            {
+                // The buffer is still in use until the last capture has been written
+                jobs.wait(captureWrite);
+                if (backend->capture(capturePixels, captureWidth, captureHeight))
+                {
+                    char fileName[32];
+                    std::snprintf(fileName, sizeof(fileName), "/frame_%05d.png", frameIndex);
+                    capturePath = captureDirectory + fileName;
+                    jobs.run([&capturePath, &capturePixels, captureWidth, captureHeight]()
+                    {
+                        PROFILE_SCOPE("Capture frame");
+                        writePng(capturePath, captureWidth, captureHeight, capturePixels.data());
+                    }, &captureWrite, JOB_PRIORITY_LOW);
+                }
+            }
+
+            // Empties the per-thread rings before they can wrap
+            Profiler::flush();
+        }
+        jobs.wait(captureWrite);
+
+        const RenderBackend::Stats& totals = backend->getTotalStats();
+        std::cout << "Backend: " << backend->getName();
+        if (glBackend)
+        {
+            std::cout << " (" << glGetString(GL_RENDERER) << ")";
+        }
+        std::cout << "\nPer frame: " << totals.DrawCalls / headlessFrames << " draw calls, "
+            << totals.StateChanges / headlessFrames << " state changes, "
+            << totals.Triangles / headlessFrames << " triangles, "
+            << totals.BytesUploaded / headlessFrames << " bytes uploaded\n";
+        frameTimings.printSummary(std::cout, "Headless");
+        backend->getPassTimings().printSummary(std::cout);
+        if (glBackend)
+        {
+            const OcclusionQueries::Stats& occlusion = glBackend->getOcclusionQueries().getStats();
+            std::cout << "Occlusion queries, last frame: " << occlusion.QueriesIssued << " issued, "
+                << occlusion.ObjectsDrawn << " drawn, " << occlusion.ObjectsConditional << " conditional, "
+                << occlusion.ObjectsSkipped << " skipped\n";
+        }
+        if (!timingsPath.empty())
+        {
+            frameTimings.writeCsv(timingsPath);
+        }
+        if (memoryReportSeconds > 0.0)
+        {
+            MemoryTracker::printReport(std::cout, lastMemoryReport, MemoryTracker::takeSnapshot());
+        }
+        if (!passTimingsPath.empty())
+        {
+            backend->getPassTimings().writeCsv(passTimingsPath);
+        }
+        if (!tracePath.empty())
+        {
+            Profiler::writeChromeTrace(tracePath);
+        }
+        return 0;
+    }
 
-        int projectionLoc = glGetUniformLocation(normalShader.Id, "sProjectionMatrix");
-        glUniformMatrix4fv(projectionLoc, 1, GL_FALSE, glm::value_ptr(projectionMatrix));
+    // =============================
+    // Render thread
+    //
+    // Owns the context from here on and draws whatever the last published
+    // snapshot describes, while the main thread simulates the next frame
+    RenderThread renderThread;
+    renderThread.start(window, renderFrame);
+    FrameExchange& frameExchange = renderThread.getExchange();
+
+    // =============================
+    // Simulation
+    //
+    // Runs at a fixed rate no matter how fast frames are produced, frames
+    // show the state interpolated between the last two ticks
+    double simulationTime = 0.0;
+    SimulationState previousState = simulate(simulationTime);
+    SimulationState currentState = previousState;
+    double lastFrameTime = glfwGetTime();
 
+    // Main loop
+    while (!glfwWindowShouldClose(window)) {
         // =============================
-        // Setup Model Textures
+        // Input
         //
-        // Bind the texture
-        glBindTexture(GL_TEXTURE_2D, texture);
-
+        glfwPollEvents();
+        processInput(window);
 
         // =============================
-        // Draw the objects
-        // 
-        // Bind the first bottom left triangle and draw it
-        glBindVertexArray(VAO);
-
-        //glDrawArrays(GL_TRIANGLES, 0, 3);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
+        // Collect time
+        //
+        auto mainStart = std::chrono::steady_clock::now();
+        double frameTime = glfwGetTime();
+        int ticks = timestep.advance(frameTime - lastFrameTime);
+        lastFrameTime = frameTime;
 
         // =============================
-        // Finish rendering
-        // 
-        // Swap the front buffer and back buffer
-        glfwSwapBuffers(window);
+        // Simulate
+        //
+        for (int tick = 0; tick < ticks; tick++)
+        {
+            PROFILE_SCOPE("Simulation tick");
+            simulationTime += timestep.getTickDelta();
+            previousState = currentState;
+            currentState = simulate(simulationTime);
+        }
+        SimulationState displayState = interpolate(previousState, currentState, timestep.getAlpha());
+        double displayTime = simulationTime - (1.0 - timestep.getAlpha()) * timestep.getTickDelta();
 
         // =============================
-        // Check for any events
+        // Publish the frame
         //
-        glfwPollEvents();
+        // Waits only if the render thread is still reading the slot from two frames ago,
+        // that wait is left out of the main thread time shown by the overlay
+        std::chrono::duration<float, std::milli> mainTime = std::chrono::steady_clock::now() - mainStart;
+        FrameSnapshot& frame = frameExchange.beginWrite();
+        auto buildStart = std::chrono::steady_clock::now();
+        buildFrame(frame, displayState, displayTime);
+        mainTime += std::chrono::steady_clock::now() - buildStart;
+        frame.MainMilliseconds = mainTime.count();
+        frameExchange.publish();
+
+        // Empties the per-thread rings before they can wrap
+        Profiler::flush();
+
+        if (memoryReportSeconds > 0.0)
+        {
+            MemoryTracker::Snapshot memory = MemoryTracker::takeSnapshot();
+            if (memory.Seconds - lastMemoryReport.Seconds >= memoryReportSeconds)
+            {
+                MemoryTracker::printReport(std::cout, lastMemoryReport, memory);
+                lastMemoryReport = memory;
+            }
+        }
+    }
+
+    // Takes the context back so GL objects are destroyed on this thread
+    renderThread.stop();
+    backend.reset();
+
+    if (!tracePath.empty())
+    {
+        Profiler::writeChromeTrace(tracePath);
     }
 
     // Cleanup and exit
@@ -302,4 +727,4 @@ int main() {
     glfwTerminate();
 
     return 0;
-}
\ No newline at end of file
+}
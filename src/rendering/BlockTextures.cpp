@@ -0,0 +1,298 @@
+// BlockTextures.cpp
+
+#include "BlockTextures.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BLOCK_TEXTURES_SSE2
+#include <emmintrin.h>
+#endif
+
+#include "rendering/TextureCache.h"
+#include "thirdparty/stb_image.h"
+#include "utilities/JobSystem.h"
+#include "utilities/Profiler.h"
+
+namespace
+{
+	const int FALLBACK_SIZE = 16;
+
+	void fillCheckerboard(unsigned char* pixels, int width, int height)
+	{
+		for (int y = 0; y < height; y++)
+		{
+			for (int x = 0; x < width; x++)
+			{
+				bool magenta = ((x * 2 / width) ^ (y * 2 / height)) & 1;
+				unsigned char* pixel = pixels + (y * width + x) * 4;
+				pixel[0] = magenta ? 255 : 0;
+				pixel[1] = 0;
+				pixel[2] = magenta ? 255 : 0;
+				pixel[3] = 255;
+			}
+		}
+	}
+}
+
+int TextureArrayData::getLevelSize(int size, int level)
+{
+	return std::max(1, size >> level);
+}
+
+size_t TextureArrayData::getLevelBytes(int level) const
+{
+	return (size_t)getLevelSize(Width, level) * getLevelSize(Height, level) * Layers * 4;
+}
+
+const unsigned char* TextureArrayData::getLevel(int level) const
+{
+	return Pixels.data() + LevelOffsets[level];
+}
+
+TextureArrayView::TextureArrayView(const TextureArrayData& data)
+	: Width(data.Width), Height(data.Height), Layers(data.Layers)
+{
+	for (int level = 0; level < data.MipCount; level++)
+	{
+		Levels.push_back(data.getLevel(level));
+	}
+}
+
+BlockTextures::BlockTextures()
+	: texture(0)
+{
+}
+
+int BlockTextures::registerTexture(const std::string& path)
+{
+	for (size_t i = 0; i < paths.size(); i++)
+	{
+		if (paths[i] == path)
+		{
+			return (int)i;
+		}
+	}
+
+	paths.push_back(path);
+	return (int)paths.size() - 1;
+}
+
+void BlockTextures::decode(JobSystem& jobs)
+{
+	struct DecodedImage
+	{
+		int Width = 0;
+		int Height = 0;
+		unsigned char* Pixels = nullptr;
+	};
+
+	std::vector<DecodedImage> images(paths.size());
+
+	// Always ask for 4 channels so every layer is RGBA regardless of the PNG
+	// One job per texture, so a slow PNG does not hold up a whole range
+	jobs.parallelFor((int)paths.size(), [&](int begin, int end)
+	{
+		for (int index = begin; index < end; index++)
+		{
+			PROFILE_SCOPE("Decode texture");
+			stbi_set_flip_vertically_on_load_thread(true);
+
+			std::string imagePath = std::string(PROJECT_ROOT) + "/assets/textures/" + paths[index];
+			int channels = 0;
+			DecodedImage& image = images[index];
+			image.Pixels = stbi_load(imagePath.c_str(), &image.Width, &image.Height, &channels, 4);
+		}
+	}, (int)paths.size());
+
+	// The first texture that loaded decides the layer size
+	data = TextureArrayData();
+	data.Width = FALLBACK_SIZE;
+	data.Height = FALLBACK_SIZE;
+	for (const DecodedImage& image : images)
+	{
+		if (image.Pixels)
+		{
+			data.Width = image.Width;
+			data.Height = image.Height;
+			break;
+		}
+	}
+
+	data.Layers = (int)paths.size();
+	data.MipCount = 1;
+	while ((data.Width >> data.MipCount) > 0 || (data.Height >> data.MipCount) > 0)
+	{
+		data.MipCount++;
+	}
+
+	size_t totalBytes = 0;
+	for (int level = 0; level < data.MipCount; level++)
+	{
+		data.LevelOffsets.push_back(totalBytes);
+		totalBytes += data.getLevelBytes(level);
+	}
+	data.Pixels.resize(totalBytes);
+
+	// Each layer copies its base level and then builds its own mip chain
+	size_t layerBytes = (size_t)data.Width * data.Height * 4;
+	jobs.parallelFor(data.Layers, [&](int begin, int end)
+	{
+		for (int layer = begin; layer < end; layer++)
+		{
+			DecodedImage& image = images[layer];
+			unsigned char* base = data.Pixels.data() + layer * layerBytes;
+
+			if (!image.Pixels)
+			{
+				std::cout << "Texture image data did not load successfully: " << paths[layer] << '\n';
+				fillCheckerboard(base, data.Width, data.Height);
+			}
+			else if (image.Width != data.Width || image.Height != data.Height)
+			{
+				std::cout << "Texture image has the wrong size for the block texture array: " << paths[layer] << '\n';
+				fillCheckerboard(base, data.Width, data.Height);
+			}
+			else
+			{
+				std::memcpy(base, image.Pixels, layerBytes);
+			}
+
+			stbi_image_free(image.Pixels);
+			image.Pixels = nullptr;
+
+			for (int level = 1; level < data.MipCount; level++)
+			{
+				int sourceWidth = TextureArrayData::getLevelSize(data.Width, level - 1);
+				int sourceHeight = TextureArrayData::getLevelSize(data.Height, level - 1);
+				size_t sourceLayerBytes = (size_t)sourceWidth * sourceHeight * 4;
+				size_t targetLayerBytes = data.getLevelBytes(level) / data.Layers;
+
+				downsample(
+					data.Pixels.data() + data.LevelOffsets[level - 1] + layer * sourceLayerBytes,
+					sourceWidth, sourceHeight,
+					data.Pixels.data() + data.LevelOffsets[level] + layer * targetLayerBytes);
+			}
+		}
+	}, data.Layers);
+}
+
+void BlockTextures::downsample(const unsigned char* source, int sourceWidth, int sourceHeight, unsigned char* target)
+{
+	int targetWidth = std::max(1, sourceWidth / 2);
+	int targetHeight = std::max(1, sourceHeight / 2);
+
+	for (int y = 0; y < targetHeight; y++)
+	{
+		const unsigned char* row0 = source + (size_t)std::min(y * 2, sourceHeight - 1) * sourceWidth * 4;
+		const unsigned char* row1 = source + (size_t)std::min(y * 2 + 1, sourceHeight - 1) * sourceWidth * 4;
+		unsigned char* out = target + (size_t)y * targetWidth * 4;
+
+		int x = 0;
+
+#ifdef BLOCK_TEXTURES_SSE2
+		// Four output pixels per iteration, widened to 16 bits so the sum of
+		// four texels plus rounding can not overflow
+		if (sourceWidth % 2 == 0)
+		{
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i rounding = _mm_set1_epi16(2);
+
+			for (; x + 4 <= targetWidth; x += 4)
+			{
+				__m128i a0 = _mm_loadu_si128((const __m128i*)(row0 + x * 8));
+				__m128i a1 = _mm_loadu_si128((const __m128i*)(row0 + x * 8 + 16));
+				__m128i b0 = _mm_loadu_si128((const __m128i*)(row1 + x * 8));
+				__m128i b1 = _mm_loadu_si128((const __m128i*)(row1 + x * 8 + 16));
+
+				// Vertical sums of source pixels (0,1) (2,3) (4,5) (6,7)
+				__m128i s01 = _mm_add_epi16(_mm_unpacklo_epi8(a0, zero), _mm_unpacklo_epi8(b0, zero));
+				__m128i s23 = _mm_add_epi16(_mm_unpackhi_epi8(a0, zero), _mm_unpackhi_epi8(b0, zero));
+				__m128i s45 = _mm_add_epi16(_mm_unpacklo_epi8(a1, zero), _mm_unpacklo_epi8(b1, zero));
+				__m128i s67 = _mm_add_epi16(_mm_unpackhi_epi8(a1, zero), _mm_unpackhi_epi8(b1, zero));
+
+				// Horizontal sums of neighbouring pixels
+				__m128i sumLow = _mm_add_epi16(_mm_unpacklo_epi64(s01, s23), _mm_unpackhi_epi64(s01, s23));
+				__m128i sumHigh = _mm_add_epi16(_mm_unpacklo_epi64(s45, s67), _mm_unpackhi_epi64(s45, s67));
+
+				sumLow = _mm_srli_epi16(_mm_add_epi16(sumLow, rounding), 2);
+				sumHigh = _mm_srli_epi16(_mm_add_epi16(sumHigh, rounding), 2);
+
+				_mm_storeu_si128((__m128i*)(out + x * 4), _mm_packus_epi16(sumLow, sumHigh));
+			}
+		}
+#endif
+
+		for (; x < targetWidth; x++)
+		{
+			int x0 = std::min(x * 2, sourceWidth - 1) * 4;
+			int x1 = std::min(x * 2 + 1, sourceWidth - 1) * 4;
+
+			for (int channel = 0; channel < 4; channel++)
+			{
+				int sum = row0[x0 + channel] + row0[x1 + channel] + row1[x0 + channel] + row1[x1 + channel];
+				out[x * 4 + channel] = (unsigned char)((sum + 2) >> 2);
+			}
+		}
+	}
+}
+
+bool BlockTextures::load(RenderBackend& backend, const std::string& cachePath, JobSystem& jobs)
+{
+	PROFILE_SCOPE("Load block textures");
+
+	uint64_t key = TextureCache::computeKey(paths);
+
+	TextureCache cache;
+	if (cache.open(cachePath, key))
+	{
+		upload(backend, cache.getView());
+		return true;
+	}
+
+	decode(jobs);
+	if (!TextureCache::write(cachePath, key, data))
+	{
+		std::cout << "Block texture cache could not be written: " << cachePath << '\n';
+	}
+
+	upload(backend);
+	releaseData();
+	return false;
+}
+
+void BlockTextures::upload(RenderBackend& backend)
+{
+	upload(backend, TextureArrayView(data));
+}
+
+void BlockTextures::upload(RenderBackend& backend, const TextureArrayView& view)
+{
+	if (texture != 0)
+	{
+		backend.destroyTexture(texture);
+	}
+	texture = backend.createTextureArray(view);
+}
+
+const std::vector<std::string>& BlockTextures::getPaths() const
+{
+	return paths;
+}
+
+const TextureArrayData& BlockTextures::getData() const
+{
+	return data;
+}
+
+void BlockTextures::releaseData()
+{
+	data = TextureArrayData();
+}
+
+TextureHandle BlockTextures::getTexture() const
+{
+	return texture;
+}
@@ -0,0 +1,89 @@
+// BlockTextures.h
+
+#ifndef BLOCK_TEXTURES_H
+#define BLOCK_TEXTURES_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "rendering/RenderBackend.h"
+#include "utilities/TrackingAllocator.h"
+
+class JobSystem;
+
+// Decoded RGBA8 pixels of every layer and mip level of a texture array.
+// Levels are stored one after another, each holding all of its layers, so
+// a level can be handed to glTexImage3D in one call.
+struct TextureArrayData
+{
+	int Width = 0;
+	int Height = 0;
+	int Layers = 0;
+	int MipCount = 0;
+
+	TrackedVector<unsigned char, MEMORY_TEXTURES> Pixels;
+	std::vector<size_t> LevelOffsets;
+
+	static int getLevelSize(int size, int level);
+	size_t getLevelBytes(int level) const;
+	const unsigned char* getLevel(int level) const;
+};
+
+// Non-owning view of texture array pixels, which may live in a
+// TextureArrayData or straight in a memory mapped cache file
+struct TextureArrayView
+{
+	int Width = 0;
+	int Height = 0;
+	int Layers = 0;
+	std::vector<const unsigned char*> Levels;
+
+	TextureArrayView() = default;
+	TextureArrayView(const TextureArrayData& data);
+};
+
+// Every block texture lives in one layer of a single texture array, so
+// all chunks draw with one texture bind. PNGs are decoded as jobs and the mip chain is built on the CPU.
+class BlockTextures
+{
+public:
+	BlockTextures();
+
+	BlockTextures(const BlockTextures&) = delete;
+	BlockTextures& operator=(const BlockTextures&) = delete;
+
+	// Returns the array layer the texture will occupy. Paths are relative to
+	// assets/textures.
+	int registerTexture(const std::string& path);
+
+	// Decodes every registered PNG, one job per texture, and builds the
+	// mip chains. Textures that fail to load or have the wrong size are
+	// replaced with a magenta checkerboard.
+	void decode(JobSystem& jobs);
+
+	// Loads the texture array from the baked cache at cachePath if it was
+	// built from the same source files, otherwise decodes the PNGs and
+	// rewrites the cache. Returns true on a cache hit.
+	bool load(RenderBackend& backend, const std::string& cachePath, JobSystem& jobs);
+
+	// Uploads the decoded data, which can then be released. The backend owns the texture.
+	void upload(RenderBackend& backend);
+	void upload(RenderBackend& backend, const TextureArrayView& view);
+
+	const std::vector<std::string>& getPaths() const;
+	const TextureArrayData& getData() const;
+	void releaseData();
+
+	TextureHandle getTexture() const;
+
+	// Averages every 2x2 block of an RGBA8 image into one pixel
+	static void downsample(const unsigned char* source, int sourceWidth, int sourceHeight, unsigned char* target);
+
+private:
+	std::vector<std::string> paths;
+	TextureArrayData data;
+	TextureHandle texture;
+};
+
+#endif
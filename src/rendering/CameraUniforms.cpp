@@ -0,0 +1,46 @@
+// CameraUniforms.cpp
+
+#include "CameraUniforms.h"
+
+static_assert(sizeof(CameraData) == 3 * 64 + 16, "CameraData must match the std140 Camera block");
+
+CameraUniforms::CameraUniforms()
+	: data()
+{
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(CameraData), nullptr, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	glBindBufferBase(GL_UNIFORM_BUFFER, BindingPoint, buffer);
+}
+
+CameraUniforms::~CameraUniforms()
+{
+	glDeleteBuffers(1, &buffer);
+}
+
+void CameraUniforms::update(RenderState& renderState, const glm::mat4& view, const glm::mat4& projection, const glm::vec3& position)
+{
+	data.View = view;
+	data.Projection = projection;
+	data.ViewProjection = projection * view;
+	data.Position = glm::vec4(position, 1.0f);
+
+	renderState.bindBuffer(GL_UNIFORM_BUFFER, buffer);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(CameraData), &data);
+}
+
+const CameraData& CameraUniforms::getData() const
+{
+	return data;
+}
+
+void CameraUniforms::bindProgram(const Shader& shader)
+{
+	GLuint blockIndex = shader.getUniformBlockIndex("Camera");
+	if (blockIndex != GL_INVALID_INDEX)
+	{
+		glUniformBlockBinding(shader.Id, blockIndex, BindingPoint);
+	}
+}
@@ -0,0 +1,49 @@
+// CameraUniforms.h
+
+#ifndef CAMERA_UNIFORMS_H
+#define CAMERA_UNIFORMS_H
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+
+#include "rendering/RenderState.h"
+#include "utilities/Shader.h"
+
+// Per-frame camera state shared by every program through the std140
+// "Camera" uniform block. The layout must match the block declared in the
+// shaders; std140 packs mat4 and vec4 members without padding.
+struct CameraData
+{
+	glm::mat4 View;
+	glm::mat4 Projection;
+	glm::mat4 ViewProjection;
+	glm::vec4 Position;
+};
+
+class CameraUniforms
+{
+public:
+	static const GLuint BindingPoint = 0;
+
+	CameraUniforms();
+	~CameraUniforms();
+
+	CameraUniforms(const CameraUniforms&) = delete;
+	CameraUniforms& operator=(const CameraUniforms&) = delete;
+
+	// Uploads the camera once for the frame, view-projection is computed here
+	// instead of per vertex
+	void update(RenderState& renderState, const glm::mat4& view, const glm::mat4& projection, const glm::vec3& position);
+
+	const CameraData& getData() const;
+
+	// Points a program's "Camera" block at the shared binding, if it has one
+	static void bindProgram(const Shader& shader);
+
+private:
+	GLuint buffer;
+	CameraData data;
+};
+
+#endif
@@ -0,0 +1,96 @@
+// CaveCuller.cpp
+
+#include "CaveCuller.h"
+
+#include "utilities/Profiler.h"
+
+namespace
+{
+	// Half the diagonal of a chunk, used to keep chunks the camera is partially inside of
+	const float CHUNK_RADIUS = Chunk::Size * 0.8660254f;
+
+	bool isInFrontOfCamera(const glm::ivec3& chunkPosition, const glm::vec3& cameraPosition, const glm::vec3& viewDirection)
+	{
+		glm::vec3 center = (glm::vec3(chunkPosition) + 0.5f) * (float)Chunk::Size;
+		return glm::dot(center - cameraPosition, viewDirection) >= -CHUNK_RADIUS;
+	}
+}
+
+const std::vector<const Chunk*>& CaveCuller::cull(const World& world, const glm::vec3& cameraPosition, const glm::vec3& viewDirection,
+	FrameArena& arena)
+{
+	PROFILE_SCOPE("Cave cull");
+
+	visibleChunks.clear();
+
+	stats = Stats();
+	stats.ChunksLoaded = world.getChunkCount();
+	visibleChunks.reserve(stats.ChunksLoaded);
+
+	// Sized for every loaded chunk up front, so neither ever grows
+	ArenaAllocator<Node> allocator(arena);
+	ArenaVector<Node> queue(allocator);
+	queue.reserve(stats.ChunksLoaded + 1);
+	std::unordered_set<glm::ivec3, ChunkPositionHash, std::equal_to<glm::ivec3>, ArenaAllocator<glm::ivec3>> visited(
+		stats.ChunksLoaded + 1, ChunkPositionHash(), std::equal_to<glm::ivec3>(), allocator);
+
+	glm::ivec3 cameraChunkPosition = World::worldToChunk(cameraPosition);
+	const Chunk* cameraChunk = world.getChunk(cameraChunkPosition);
+	if (!cameraChunk)
+	{
+		return visibleChunks;
+	}
+
+	queue.push_back({ cameraChunk, -1, 0 });
+	visited.insert(cameraChunkPosition);
+
+	// The queue is only ever appended to, so a read cursor is enough for BFS order
+	for (size_t head = 0; head < queue.size(); head++)
+	{
+		Node node = queue[head];
+		visibleChunks.push_back(node.chunk);
+
+		for (int face = 0; face < FACE_COUNT; face++)
+		{
+			// Never travel back along an axis direction we already moved in
+			if (node.travelledFaces & (1 << (face ^ 1)))
+			{
+				continue;
+			}
+
+			// The camera chunk can see out of every face
+			if (node.entryFace != -1 && !node.chunk->areFacesConnected(node.entryFace, face))
+			{
+				continue;
+			}
+
+			glm::ivec3 neighbourPosition = node.chunk->Position + Chunk::getFaceDirection(face);
+			if (visited.count(neighbourPosition) || !isInFrontOfCamera(neighbourPosition, cameraPosition, viewDirection))
+			{
+				continue;
+			}
+
+			const Chunk* neighbour = world.getChunk(neighbourPosition);
+			if (!neighbour)
+			{
+				continue;
+			}
+
+			visited.insert(neighbourPosition);
+			queue.push_back({ neighbour, face ^ 1, node.travelledFaces | (1 << face) });
+		}
+	}
+
+	stats.ChunksVisible = visibleChunks.size();
+	return visibleChunks;
+}
+
+const std::vector<const Chunk*>& CaveCuller::getVisibleChunks() const
+{
+	return visibleChunks;
+}
+
+const CaveCuller::Stats& CaveCuller::getStats() const
+{
+	return stats;
+}
@@ -0,0 +1,55 @@
+// CaveCuller.h
+
+#ifndef CAVE_CULLER_H
+#define CAVE_CULLER_H
+
+#include <cstddef>
+#include <unordered_set>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "utilities/ArenaAllocator.h"
+#include "world/World.h"
+
+// Breadth-first search over the chunk grid starting at the camera chunk.
+// A chunk is only entered if the chunk it is reached from connects the
+// entry and exit faces (see Chunk::rebuildVisibility), the search never
+// turns back on an axis it already travelled along, and the chunk is not
+// behind the camera.
+class CaveCuller
+{
+public:
+	struct Stats
+	{
+		size_t ChunksLoaded = 0;
+		size_t ChunksVisible = 0;
+
+		float getCullRate() const
+		{
+			return ChunksLoaded > 0 ? 1.0f - (float)ChunksVisible / (float)ChunksLoaded : 0.0f;
+		}
+	};
+
+	// Returns the chunks reachable from the camera. Chunks must have had
+	// their visibility rebuilt beforehand. The search's bookkeeping is
+	// allocated from arena.
+	const std::vector<const Chunk*>& cull(const World& world, const glm::vec3& cameraPosition, const glm::vec3& viewDirection,
+		FrameArena& arena);
+
+	const std::vector<const Chunk*>& getVisibleChunks() const;
+	const Stats& getStats() const;
+
+private:
+	struct Node
+	{
+		const Chunk* chunk;
+		int entryFace;
+		int travelledFaces;
+	};
+
+	std::vector<const Chunk*> visibleChunks;
+	Stats stats;
+};
+
+#endif
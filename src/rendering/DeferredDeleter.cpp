@@ -0,0 +1,76 @@
+// DeferredDeleter.cpp
+
+#include "DeferredDeleter.h"
+
+#include <algorithm>
+
+DeferredDeleter::~DeferredDeleter()
+{
+	flush();
+}
+
+void DeferredDeleter::retire(const GLObject& object, uint64_t lastUsedFrame)
+{
+	if (object.Name == 0)
+	{
+		return;
+	}
+	retired.push_back({ object, lastUsedFrame });
+}
+
+int DeferredDeleter::collect(uint64_t completedFrame)
+{
+	auto firstKept = std::partition(retired.begin(), retired.end(), [completedFrame](const Retired& entry)
+	{
+		return entry.Frame <= completedFrame;
+	});
+
+	for (auto it = retired.begin(); it != firstKept; ++it)
+	{
+		destroy(it->Object);
+		objectsDeleted++;
+	}
+	int deleted = (int)(firstKept - retired.begin());
+	retired.erase(retired.begin(), firstKept);
+	return deleted;
+}
+
+void DeferredDeleter::flush()
+{
+	for (const Retired& entry : retired)
+	{
+		destroy(entry.Object);
+		objectsDeleted++;
+	}
+	retired.clear();
+}
+
+DeferredDeleter::Stats DeferredDeleter::getStats() const
+{
+	Stats stats;
+	stats.ObjectsPending = (int)retired.size();
+	stats.ObjectsDeleted = objectsDeleted;
+	return stats;
+}
+
+void DeferredDeleter::destroy(const GLObject& object)
+{
+	switch (object.Type)
+	{
+	case GL_OBJECT_BUFFER:
+		glDeleteBuffers(1, &object.Name);
+		break;
+	case GL_OBJECT_TEXTURE:
+		glDeleteTextures(1, &object.Name);
+		break;
+	case GL_OBJECT_VERTEX_ARRAY:
+		glDeleteVertexArrays(1, &object.Name);
+		break;
+	case GL_OBJECT_QUERY:
+		glDeleteQueries(1, &object.Name);
+		break;
+	case GL_OBJECT_PROGRAM:
+		glDeleteProgram(object.Name);
+		break;
+	}
+}
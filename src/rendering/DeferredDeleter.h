@@ -0,0 +1,63 @@
+// DeferredDeleter.h
+
+#ifndef DEFERRED_DELETER_H
+#define DEFERRED_DELETER_H
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <vector>
+
+enum GLObjectType
+{
+	GL_OBJECT_BUFFER,
+	GL_OBJECT_TEXTURE,
+	GL_OBJECT_VERTEX_ARRAY,
+	GL_OBJECT_QUERY,
+	GL_OBJECT_PROGRAM
+};
+
+struct GLObject
+{
+	GLObjectType Type;
+	GLuint Name;
+};
+
+// Holds on to GL objects until the GPU has finished the last frame that
+// used them. Deleting an object the GPU is still reading can stall the
+// driver or make it copy the storage behind our back.
+class DeferredDeleter
+{
+public:
+	struct Stats
+	{
+		int ObjectsPending = 0;
+		uint64_t ObjectsDeleted = 0;
+	};
+
+	~DeferredDeleter();
+
+	void retire(const GLObject& object, uint64_t lastUsedFrame);
+
+	// Deletes everything whose last frame has completed, returns how many objects were deleted
+	int collect(uint64_t completedFrame);
+
+	// Deletes everything right away, for shutdown once the GPU is idle
+	void flush();
+
+	Stats getStats() const;
+
+private:
+	struct Retired
+	{
+		GLObject Object;
+		uint64_t Frame;
+	};
+
+	std::vector<Retired> retired;
+	uint64_t objectsDeleted = 0;
+
+	static void destroy(const GLObject& object);
+};
+
+#endif
@@ -0,0 +1,86 @@
+// FrameExchange.cpp
+
+#include "FrameExchange.h"
+
+#include "utilities/Profiler.h"
+
+FrameSnapshot& FrameExchange::beginWrite()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	if (readingSlot == writeSlot && !stopped)
+	{
+		stats.SimulationWaits++;
+		changed.wait(lock, [this]() { return readingSlot != writeSlot || stopped; });
+	}
+
+	FrameSnapshot& snapshot = slots[writeSlot];
+	snapshot.reset();
+	snapshot.FrameIndex = nextFrameIndex++;
+	return snapshot;
+}
+
+void FrameExchange::publish()
+{
+	PROFILE_SCOPE("Publish frame");
+
+	{
+		// Frames are never dropped, their upload requests have to run
+		std::unique_lock<std::mutex> lock(mutex);
+		if (readySlot >= 0 && !stopped)
+		{
+			stats.SimulationWaits++;
+			changed.wait(lock, [this]() { return readySlot < 0 || stopped; });
+		}
+
+		readySlot = writeSlot;
+		writeSlot = 1 - writeSlot;
+		stats.FramesPublished++;
+	}
+	changed.notify_all();
+}
+
+const FrameSnapshot* FrameExchange::acquire()
+{
+	PROFILE_SCOPE("Acquire frame");
+
+	std::unique_lock<std::mutex> lock(mutex);
+	if (readySlot < 0 && !stopped)
+	{
+		stats.RenderWaits++;
+		changed.wait(lock, [this]() { return readySlot >= 0 || stopped; });
+	}
+
+	if (stopped)
+	{
+		return nullptr;
+	}
+
+	readingSlot = readySlot;
+	readySlot = -1;
+	return &slots[readingSlot];
+}
+
+void FrameExchange::release()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		readingSlot = -1;
+		stats.FramesRendered++;
+	}
+	changed.notify_all();
+}
+
+void FrameExchange::shutdown()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopped = true;
+	}
+	changed.notify_all();
+}
+
+FrameExchange::Stats FrameExchange::getStats()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return stats;
+}
@@ -0,0 +1,108 @@
+// FrameExchange.h
+
+#ifndef FRAME_EXCHANGE_H
+#define FRAME_EXCHANGE_H
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "rendering/RenderQueue.h"
+#include "rendering/RenderTypes.h"
+
+// Everything the render thread needs to draw one frame. The simulation
+// thread fills it in and never touches it again once published.
+// Engine counters shown by the performance overlay, filled in by the simulation
+struct PerfCounters
+{
+	int ChunksLoaded = 0;
+	int ChunksMeshed = 0;
+	int ChunksVisible = 0;
+	int JobsQueued = 0;
+};
+
+struct FrameSnapshot
+{
+	uint64_t FrameIndex = 0;
+
+	int FramebufferWidth = 0;
+	int FramebufferHeight = 0;
+	bool Wireframe = false;
+	// 1 waits for vsync, 0 presents uncapped
+	int SwapInterval = 1;
+	bool ShowOverlay = false;
+
+	// Main thread time spent simulating and building this snapshot
+	float MainMilliseconds = 0.0f;
+	PerfCounters Counters;
+
+	glm::mat4 View = glm::mat4(1.0f);
+	glm::mat4 Projection = glm::mat4(1.0f);
+	glm::vec3 CameraPosition = glm::vec3(0.0f);
+
+	std::vector<DrawPacket> Draws;
+	std::vector<MeshInstance> Cubes;
+
+	// Mesh data produced by the simulation, uploaded before the frame is drawn
+	std::vector<MeshUpload> MeshUploads;
+
+	// Meshes the simulation is done with, e.g. those of unloaded chunks. The
+	// backend frees them once the GPU has finished every frame that used them.
+	std::vector<MeshHandle> MeshDeletions;
+
+	// Empties the lists but keeps their storage for the next frame
+	void reset()
+	{
+		Draws.clear();
+		Cubes.clear();
+		MeshUploads.clear();
+		MeshDeletions.clear();
+	}
+};
+
+// Double buffered hand-off between the simulation and render threads.
+// The simulation writes one slot while the render thread reads the other,
+// so the simulation runs at most one frame ahead of what is on screen.
+class FrameExchange
+{
+public:
+	struct Stats
+	{
+		uint64_t FramesPublished = 0;
+		uint64_t FramesRendered = 0;
+		uint64_t SimulationWaits = 0;
+		uint64_t RenderWaits = 0;
+	};
+
+	// Blocks until the render thread has let go of the slot, then clears it
+	FrameSnapshot& beginWrite();
+	void publish();
+
+	// Blocks until a frame is published, returns nullptr once shut down
+	const FrameSnapshot* acquire();
+	void release();
+
+	// Wakes both sides, acquire() returns nullptr from then on
+	void shutdown();
+
+	Stats getStats();
+
+private:
+	std::mutex mutex;
+	std::condition_variable changed;
+
+	std::array<FrameSnapshot, 2> slots;
+	int writeSlot = 0;
+	int readySlot = -1;
+	int readingSlot = -1;
+	bool stopped = false;
+	uint64_t nextFrameIndex = 0;
+
+	Stats stats;
+};
+
+#endif
@@ -0,0 +1,78 @@
+// FrameFences.cpp
+
+#include "FrameFences.h"
+
+FrameFences::FrameFences()
+	: frame(0), completedFrame(0)
+{
+}
+
+FrameFences::~FrameFences()
+{
+	for (Fence& fence : fences)
+	{
+		glDeleteSync(fence.Sync);
+	}
+}
+
+uint64_t FrameFences::beginFrame()
+{
+	poll();
+
+	if ((int)fences.size() >= MaxFramesInFlight)
+	{
+		stats.Waits++;
+		const GLuint64 OneSecond = 1000000000ull;
+		while (glClientWaitSync(fences.front().Sync, GL_SYNC_FLUSH_COMMANDS_BIT, OneSecond) == GL_TIMEOUT_EXPIRED)
+		{
+		}
+		retireOldest();
+	}
+
+	return ++frame;
+}
+
+void FrameFences::endFrame()
+{
+	Fence fence;
+	fence.Sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	fence.Frame = frame;
+	fences.push_back(fence);
+}
+
+uint64_t FrameFences::getFrame() const
+{
+	return frame;
+}
+
+uint64_t FrameFences::getCompletedFrame()
+{
+	poll();
+	return completedFrame;
+}
+
+const FrameFences::Stats& FrameFences::getStats() const
+{
+	return stats;
+}
+
+void FrameFences::poll()
+{
+	// Frames finish in order, so the first unsignalled fence ends the scan
+	while (!fences.empty())
+	{
+		GLenum status = glClientWaitSync(fences.front().Sync, 0, 0);
+		if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+		{
+			break;
+		}
+		retireOldest();
+	}
+}
+
+void FrameFences::retireOldest()
+{
+	completedFrame = fences.front().Frame;
+	glDeleteSync(fences.front().Sync);
+	fences.pop_front();
+}
@@ -0,0 +1,61 @@
+// FrameFences.h
+
+#ifndef FRAME_FENCES_H
+#define FRAME_FENCES_H
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <deque>
+
+// A fence per submitted frame, so CPU-side code can tell which frames the
+// GPU has finished with. Frame numbers start at 1, a completed frame of 0
+// means nothing has finished yet.
+class FrameFences
+{
+public:
+	static const int MaxFramesInFlight = 3;
+
+	struct Stats
+	{
+		// Times beginFrame had to block because the GPU fell too far behind
+		uint64_t Waits = 0;
+	};
+
+	FrameFences();
+	~FrameFences();
+
+	FrameFences(const FrameFences&) = delete;
+	FrameFences& operator=(const FrameFences&) = delete;
+
+	// Starts a new frame, blocking only when MaxFramesInFlight frames are still queued
+	uint64_t beginFrame();
+
+	// Fences everything submitted since beginFrame
+	void endFrame();
+
+	uint64_t getFrame() const;
+
+	// Latest frame the GPU has finished, polled without blocking
+	uint64_t getCompletedFrame();
+
+	const Stats& getStats() const;
+
+private:
+	struct Fence
+	{
+		GLsync Sync;
+		uint64_t Frame;
+	};
+
+	std::deque<Fence> fences;
+	uint64_t frame;
+	uint64_t completedFrame;
+
+	Stats stats;
+
+	void poll();
+	void retireOldest();
+};
+
+#endif
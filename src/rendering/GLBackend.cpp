@@ -0,0 +1,594 @@
+// GLBackend.cpp
+
+#include "GLBackend.h"
+
+#include <cstddef>
+#include <iostream>
+
+#include "rendering/BlockTextures.h"
+#include "rendering/FrameExchange.h"
+#include "utilities/MemoryTracker.h"
+#include "utilities/Profiler.h"
+
+namespace
+{
+	BoundingBox transformBounds(const BoundingBox& bounds, const glm::mat4& model)
+	{
+		glm::vec3 corner = glm::vec3(model * glm::vec4(bounds.getCorner(0), 1.0f));
+		BoundingBox transformed(corner, corner);
+		for (int i = 1; i < 8; i++)
+		{
+			corner = glm::vec3(model * glm::vec4(bounds.getCorner(i), 1.0f));
+			transformed.Min = glm::min(transformed.Min, corner);
+			transformed.Max = glm::max(transformed.Max, corner);
+		}
+		return transformed;
+	}
+}
+
+GLBackend::GLBackend(const std::string& shaderCacheDirectory)
+	: shaderManager(shaderCacheDirectory), stagingRing(16 * 1024 * 1024), overlayVertexArray(0), overlayVertexBuffer(0), overlayBufferBytes(0),
+	gpuFrame(0), viewportWidth(0), viewportHeight(0), wireframe(false)
+{
+	shaderManager.initialize();
+
+	framePass = passTimings.getPass("Frame");
+	instancesPass = passTimings.getPass("Instances");
+	overlayPass = passTimings.getPass("Debug overlay");
+
+	// Setup above bound objects directly
+	renderState.invalidate();
+}
+
+GLBackend::~GLBackend()
+{
+	for (auto& entry : meshes)
+	{
+		Mesh& mesh = entry.second;
+		mesh.Instances.reset();
+		glDeleteBuffers(1, &mesh.IndexBuffer);
+		glDeleteBuffers(1, &mesh.VertexBuffer);
+		glDeleteVertexArrays(1, &mesh.VertexArray);
+		MemoryTracker::remove(MEMORY_GPU_BUFFERS, mesh.BufferBytes);
+	}
+
+	glDeleteBuffers(1, &overlayVertexBuffer);
+	glDeleteVertexArrays(1, &overlayVertexArray);
+	if (overlayBufferBytes > 0)
+	{
+		MemoryTracker::remove(MEMORY_GPU_BUFFERS, overlayBufferBytes);
+	}
+
+	if (!textures.empty())
+	{
+		glDeleteTextures((GLsizei)textures.size(), textures.data());
+	}
+	for (size_t i = 0; i < textures.size(); i++)
+	{
+		if (textures[i] != 0)
+		{
+			MemoryTracker::remove(MEMORY_GPU_TEXTURES, textureBytes[i]);
+		}
+	}
+
+	// Nothing is in flight once the context is being torn down
+	deferredDeleter.flush();
+}
+
+const char* GLBackend::getName() const
+{
+	return "OpenGL";
+}
+
+void GLBackend::updateMesh(MeshHandle handle, const MeshData& data)
+{
+	Mesh& mesh = meshes[handle];
+	if (mesh.VertexArray == 0)
+	{
+		glGenVertexArrays(1, &mesh.VertexArray);
+		glGenBuffers(1, &mesh.VertexBuffer);
+		glGenBuffers(1, &mesh.IndexBuffer);
+		frameStats.ResourcesCreated++;
+
+		renderState.bindVertexArray(mesh.VertexArray);
+		renderState.bindBuffer(GL_ARRAY_BUFFER, mesh.VertexBuffer);
+
+		GLsizei stride = sizeof(float) * MeshVertexFloats;
+
+		// Position attribute
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
+		glEnableVertexAttribArray(0);
+
+		// Color attribute
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)(3 * sizeof(float)));
+		glEnableVertexAttribArray(1);
+
+		// Texture coordinate attribute
+		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)(6 * sizeof(float)));
+		glEnableVertexAttribArray(2);
+
+		renderState.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.IndexBuffer);
+	}
+	else
+	{
+		renderState.bindVertexArray(mesh.VertexArray);
+		renderState.bindBuffer(GL_ARRAY_BUFFER, mesh.VertexBuffer);
+	}
+
+	// Respecifying the storage orphans the old contents instead of waiting for draws still using them
+	size_t vertexBytes = data.Vertices.size() * sizeof(float);
+	size_t indexBytes = data.Indices.size() * sizeof(unsigned int);
+	glBufferData(GL_ARRAY_BUFFER, vertexBytes, data.Vertices.data(), GL_STATIC_DRAW);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBytes, data.Indices.data(), GL_STATIC_DRAW);
+	mesh.IndexCount = (GLsizei)data.Indices.size();
+
+	mesh.Bounds = BoundingBox();
+	if (data.Vertices.size() >= MeshVertexFloats)
+	{
+		mesh.Bounds.Min = mesh.Bounds.Max = glm::vec3(data.Vertices[0], data.Vertices[1], data.Vertices[2]);
+		for (size_t i = MeshVertexFloats; i + 2 < data.Vertices.size(); i += MeshVertexFloats)
+		{
+			glm::vec3 position(data.Vertices[i], data.Vertices[i + 1], data.Vertices[i + 2]);
+			mesh.Bounds.Min = glm::min(mesh.Bounds.Min, position);
+			mesh.Bounds.Max = glm::max(mesh.Bounds.Max, position);
+		}
+	}
+
+	if (mesh.BufferBytes > 0)
+	{
+		MemoryTracker::remove(MEMORY_GPU_BUFFERS, mesh.BufferBytes);
+	}
+	mesh.BufferBytes = vertexBytes + indexBytes;
+	MemoryTracker::add(MEMORY_GPU_BUFFERS, mesh.BufferBytes);
+
+	frameStats.BytesUploaded += vertexBytes + indexBytes;
+}
+
+void GLBackend::destroyMesh(MeshHandle handle)
+{
+	auto it = meshes.find(handle);
+	if (it == meshes.end())
+	{
+		return;
+	}
+
+	// The current frame may still draw it, so everything waits for its fence
+	Mesh& mesh = it->second;
+	uint64_t lastUsedFrame = frameFences.getFrame();
+	if (mesh.Instances)
+	{
+		deferredDeleter.retire({ GL_OBJECT_BUFFER, mesh.Instances->releaseInstanceBuffer() }, lastUsedFrame);
+	}
+	deferredDeleter.retire({ GL_OBJECT_VERTEX_ARRAY, mesh.VertexArray }, lastUsedFrame);
+	deferredDeleter.retire({ GL_OBJECT_BUFFER, mesh.VertexBuffer }, lastUsedFrame);
+	deferredDeleter.retire({ GL_OBJECT_BUFFER, mesh.IndexBuffer }, lastUsedFrame);
+	if (mesh.BufferBytes > 0)
+	{
+		MemoryTracker::remove(MEMORY_GPU_BUFFERS, mesh.BufferBytes);
+	}
+
+	occlusionQueries.forget(handle);
+	meshes.erase(it);
+	frameStats.ResourcesDestroyed++;
+}
+
+TextureHandle GLBackend::createTextureArray(const TextureArrayView& view)
+{
+	int mipCount = (int)view.Levels.size();
+
+	GLuint texture = 0;
+	glGenTextures(1, &texture);
+	renderState.bindTexture(0, GL_TEXTURE_2D_ARRAY, texture);
+
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, 0);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, mipCount - 1);
+
+	size_t bytes = 0;
+	for (int level = 0; level < mipCount; level++)
+	{
+		int width = TextureArrayData::getLevelSize(view.Width, level);
+		int height = TextureArrayData::getLevelSize(view.Height, level);
+		glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA8, width, height, view.Layers, 0,
+			GL_RGBA, GL_UNSIGNED_BYTE, view.Levels[level]);
+		bytes += (size_t)width * height * view.Layers * 4;
+	}
+	frameStats.BytesUploaded += bytes;
+	MemoryTracker::add(MEMORY_GPU_TEXTURES, bytes);
+
+	textures.push_back(texture);
+	textureBytes.push_back(bytes);
+	frameStats.ResourcesCreated++;
+	return (TextureHandle)textures.size();
+}
+
+void GLBackend::destroyTexture(TextureHandle handle)
+{
+	GLuint texture = findTexture(handle);
+	if (texture == 0)
+	{
+		return;
+	}
+
+	deferredDeleter.retire({ GL_OBJECT_TEXTURE, texture }, frameFences.getFrame());
+	textures[handle - 1] = 0;
+	MemoryTracker::remove(MEMORY_GPU_TEXTURES, textureBytes[handle - 1]);
+	frameStats.ResourcesDestroyed++;
+}
+
+void GLBackend::registerProgram(const std::string& name, const char* vertexSourcePath, const char* fragmentSourcePath,
+	const std::vector<std::string>& features)
+{
+	shaderManager.registerProgram(name, vertexSourcePath, fragmentSourcePath, features);
+
+	// Registering again drops the compiled variants, handles to them are resolved anew
+	for (Program& program : programs)
+	{
+		if (program.Name == name)
+		{
+			program.Linked = nullptr;
+		}
+	}
+}
+
+ProgramHandle GLBackend::createProgram(const std::string& name, const std::vector<std::string>& defines)
+{
+	ShaderFeatures features = 0;
+	for (const std::string& define : defines)
+	{
+		ShaderFeatures feature = shaderManager.getFeature(name, define);
+		if (feature == 0)
+		{
+			std::cout << "ERROR::GL_BACKEND::UNKNOWN_SHADER_FEATURE\n" << name << ' ' << define << '\n';
+		}
+		features |= feature;
+	}
+
+	// Every request for the same variant shares one handle
+	for (size_t i = 0; i < programs.size(); i++)
+	{
+		if (programs[i].Name == name && programs[i].Features == features)
+		{
+			return (ProgramHandle)(i + 1);
+		}
+	}
+
+	Program program;
+	program.Name = name;
+	program.Features = features;
+	shaderManager.load(name, features);
+
+	programs.push_back(program);
+	frameStats.ResourcesCreated++;
+	return (ProgramHandle)programs.size();
+}
+
+void GLBackend::beginFrame(const FrameSnapshot& frame)
+{
+	renderState.beginFrame();
+
+	gpuFrame = frameFences.beginFrame();
+	gpuTimers.beginFrame(frame.FrameIndex, passTimings);
+	gpuTimers.beginPass(framePass);
+	occlusionQueries.beginFrame(frame.CameraPosition);
+
+	uint64_t completedFrame = frameFences.getCompletedFrame();
+	stagingRing.collect(completedFrame);
+	stagingRing.resetStats();
+
+	// Names of deleted objects get reused, so cached bindings of them are stale
+	if (deferredDeleter.collect(completedFrame) > 0)
+	{
+		renderState.invalidate();
+	}
+
+	{
+		PROFILE_SCOPE("Upload meshes");
+		for (MeshHandle mesh : frame.MeshDeletions)
+		{
+			destroyMesh(mesh);
+		}
+		for (const MeshUpload& upload : frame.MeshUploads)
+		{
+			updateMesh(upload.Mesh, upload.Data);
+		}
+	}
+
+	if (frame.FramebufferWidth != viewportWidth || frame.FramebufferHeight != viewportHeight)
+	{
+		viewportWidth = frame.FramebufferWidth;
+		viewportHeight = frame.FramebufferHeight;
+		glViewport(0, 0, viewportWidth, viewportHeight);
+	}
+	renderState.setEnabled(GL_DEPTH_TEST, true);
+	wireframe = frame.Wireframe;
+	renderState.polygonMode(wireframe ? GL_LINE : GL_FILL);
+
+	glClearColor(1.0f, 1.0f, 1.0f, 0.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	// Upload the camera once for the frame, the packets carry the model matrix
+	cameraUniforms.update(renderState, frame.View, frame.Projection, frame.CameraPosition);
+}
+
+void GLBackend::drawPackets(const std::vector<DrawPacket>& packets)
+{
+	PROFILE_SCOPE("Draw packets");
+
+	ProgramHandle currentProgramHandle = 0;
+	MeshHandle currentMeshHandle = 0;
+	TextureHandle currentTextureHandle = 0;
+	Program* program = nullptr;
+	Mesh* mesh = nullptr;
+	int currentPass = -1;
+
+	for (const DrawPacket& packet : packets)
+	{
+		// Packets are sorted by pass first, so each pass is one contiguous run
+		int pass = RenderQueue::getPass(packet.Key);
+		if (pass != currentPass)
+		{
+			if (currentPass != -1)
+			{
+				finishPass(currentPass);
+			}
+			currentPass = pass;
+			gpuTimers.beginPass(passTimings.getPass(RenderQueue::getPassName(pass)));
+		}
+
+		if (packet.Program != currentProgramHandle)
+		{
+			currentProgramHandle = packet.Program;
+			program = resolveProgram(packet.Program);
+			frameStats.StateChanges++;
+		}
+		if (packet.Mesh != currentMeshHandle)
+		{
+			currentMeshHandle = packet.Mesh;
+			mesh = findMesh(packet.Mesh);
+			frameStats.StateChanges++;
+		}
+		if (packet.Texture != currentTextureHandle)
+		{
+			currentTextureHandle = packet.Texture;
+			renderState.bindTexture(0, GL_TEXTURE_2D_ARRAY, findTexture(packet.Texture));
+			frameStats.StateChanges++;
+		}
+		if (!program || !mesh)
+		{
+			continue;
+		}
+
+		// The shader caches uniform values, so repeated values cost no GL call
+		renderState.useProgram(program->Linked->Id);
+		program->Linked->setMat4(program->ModelMatrix, packet.Model);
+		program->Linked->setFloat(program->TextureLayer, packet.TextureLayer);
+		renderState.bindVertexArray(mesh->VertexArray);
+
+		// Opaque draws are tested against last frame's queries, wireframe hides nothing so it skips them
+		bool queried = pass == RenderQueue::PASS_OPAQUE && !wireframe;
+		if (queried && !occlusionQueries.beginDraw(packet.Mesh, transformBounds(mesh->Bounds, packet.Model)))
+		{
+			continue;
+		}
+
+		glDrawElements(GL_TRIANGLES, mesh->IndexCount, GL_UNSIGNED_INT, 0);
+		frameStats.DrawCalls++;
+		frameStats.Triangles += mesh->IndexCount / 3;
+
+		if (queried)
+		{
+			occlusionQueries.endDraw();
+		}
+	}
+
+	if (currentPass != -1)
+	{
+		finishPass(currentPass);
+	}
+}
+
+void GLBackend::drawInstances(MeshHandle meshHandle, ProgramHandle programHandle, TextureHandle textureHandle,
+	const std::vector<MeshInstance>& instances)
+{
+	PROFILE_SCOPE("Draw instances");
+
+	Mesh* mesh = findMesh(meshHandle);
+	Program* program = resolveProgram(programHandle);
+	if (!mesh || !program || instances.empty())
+	{
+		return;
+	}
+
+	if (!mesh->Instances)
+	{
+		mesh->Instances = std::make_unique<InstanceRenderer>(mesh->VertexArray, mesh->IndexCount);
+
+		// The instance renderer sets itself up with direct binds
+		renderState.invalidate();
+	}
+
+	gpuTimers.beginPass(instancesPass);
+	mesh->Instances->upload(renderState, instances, &stagingRing);
+	mesh->Instances->draw(renderState, *program->Linked, findTexture(textureHandle));
+	gpuTimers.endPass();
+
+	frameStats.DrawCalls++;
+	frameStats.StateChanges += 3;
+	frameStats.Instances += (int)instances.size();
+	frameStats.Triangles += (uint64_t)(mesh->IndexCount / 3) * instances.size();
+	frameStats.BytesUploaded += instances.size() * sizeof(MeshInstance);
+}
+
+void GLBackend::drawOverlay(ProgramHandle programHandle, TextureHandle textureHandle, const std::vector<OverlayVertex>& vertices)
+{
+	PROFILE_SCOPE("Draw overlay");
+
+	Program* program = resolveProgram(programHandle);
+	if (!program || vertices.empty())
+	{
+		return;
+	}
+
+	if (overlayVertexArray == 0)
+	{
+		glGenVertexArrays(1, &overlayVertexArray);
+		glGenBuffers(1, &overlayVertexBuffer);
+
+		renderState.bindVertexArray(overlayVertexArray);
+		renderState.bindBuffer(GL_ARRAY_BUFFER, overlayVertexBuffer);
+
+		GLsizei stride = sizeof(OverlayVertex);
+
+		// Position attribute
+		glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(OverlayVertex, X));
+		glEnableVertexAttribArray(0);
+
+		// Texture coordinate attribute
+		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(OverlayVertex, U));
+		glEnableVertexAttribArray(1);
+
+		// Color attribute, four normalized bytes
+		glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (void*)offsetof(OverlayVertex, Color));
+		glEnableVertexAttribArray(2);
+	}
+	else
+	{
+		renderState.bindVertexArray(overlayVertexArray);
+		renderState.bindBuffer(GL_ARRAY_BUFFER, overlayVertexBuffer);
+	}
+
+	gpuTimers.beginPass(overlayPass);
+
+	// Rebuilt every frame, so orphan the old storage rather than wait on the last draw
+	size_t bytes = vertices.size() * sizeof(OverlayVertex);
+	glBufferData(GL_ARRAY_BUFFER, bytes, vertices.data(), GL_STREAM_DRAW);
+	if (bytes != overlayBufferBytes)
+	{
+		if (overlayBufferBytes > 0)
+		{
+			MemoryTracker::remove(MEMORY_GPU_BUFFERS, overlayBufferBytes);
+		}
+		MemoryTracker::add(MEMORY_GPU_BUFFERS, bytes);
+		overlayBufferBytes = bytes;
+	}
+
+	renderState.setEnabled(GL_DEPTH_TEST, false);
+	renderState.setEnabled(GL_BLEND, true);
+	renderState.blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	renderState.polygonMode(GL_FILL);
+
+	renderState.useProgram(program->Linked->Id);
+	program->Linked->setVec2f("sScreenSize", (float)viewportWidth, (float)viewportHeight);
+	renderState.bindTexture(0, GL_TEXTURE_2D_ARRAY, findTexture(textureHandle));
+
+	glDrawArrays(GL_TRIANGLES, 0, (GLsizei)vertices.size());
+
+	renderState.setEnabled(GL_BLEND, false);
+	renderState.setEnabled(GL_DEPTH_TEST, true);
+
+	gpuTimers.endPass();
+}
+
+void GLBackend::endFrame()
+{
+	gpuTimers.endPass();
+	stagingRing.endFrame(gpuFrame);
+	frameFences.endFrame();
+	finishFrameStats();
+}
+
+void GLBackend::finish()
+{
+	PROFILE_SCOPE("Wait for GPU");
+	glFinish();
+}
+
+bool GLBackend::capture(std::vector<unsigned char>& pixels, int& width, int& height)
+{
+	if (!offscreenTarget)
+	{
+		return false;
+	}
+
+	offscreenTarget->readPixels(pixels);
+	width = offscreenTarget->getWidth();
+	height = offscreenTarget->getHeight();
+	return true;
+}
+
+bool GLBackend::useOffscreenTarget(int width, int height)
+{
+	offscreenTarget = std::make_unique<OffscreenTarget>(width, height);
+	if (!offscreenTarget->isComplete())
+	{
+		offscreenTarget.reset();
+		return false;
+	}
+
+	offscreenTarget->bind();
+	return true;
+}
+
+const ShaderManager& GLBackend::getShaderManager() const
+{
+	return shaderManager;
+}
+
+const RenderState& GLBackend::getRenderState() const
+{
+	return renderState;
+}
+
+const GpuTimers& GLBackend::getGpuTimers() const
+{
+	return gpuTimers;
+}
+
+const OcclusionQueries& GLBackend::getOcclusionQueries() const
+{
+	return occlusionQueries;
+}
+
+GLBackend::Mesh* GLBackend::findMesh(MeshHandle handle)
+{
+	auto it = meshes.find(handle);
+	return it != meshes.end() ? &it->second : nullptr;
+}
+
+GLuint GLBackend::findTexture(TextureHandle handle) const
+{
+	return (handle > 0 && handle <= textures.size()) ? textures[handle - 1] : 0;
+}
+
+void GLBackend::finishPass(int pass)
+{
+	// The opaque depth buffer is complete, so this is where its boxes are tested
+	if (pass == RenderQueue::PASS_OPAQUE && !wireframe)
+	{
+		occlusionQueries.issueQueries(renderState);
+	}
+	gpuTimers.endPass();
+}
+
+GLBackend::Program* GLBackend::resolveProgram(ProgramHandle handle)
+{
+	if (handle == 0 || handle > programs.size())
+	{
+		return nullptr;
+	}
+
+	Program& program = programs[handle - 1];
+	if (!program.Linked)
+	{
+		const Shader& shader = shaderManager.get(program.Name, program.Features);
+		CameraUniforms::bindProgram(shader);
+		program.ModelMatrix = shader.getUniform("sModelMatrix");
+		program.TextureLayer = shader.getUniform("sTextureLayer");
+		program.Linked = &shader;
+	}
+	return &program;
+}
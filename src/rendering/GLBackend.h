@@ -0,0 +1,124 @@
+// GLBackend.h
+
+#ifndef GL_BACKEND_H
+#define GL_BACKEND_H
+
+#include <glad/glad.h>
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "rendering/CameraUniforms.h"
+#include "rendering/DeferredDeleter.h"
+#include "rendering/FrameFences.h"
+#include "rendering/GpuTimers.h"
+#include "rendering/InstanceRenderer.h"
+#include "rendering/OcclusionQueries.h"
+#include "rendering/OffscreenTarget.h"
+#include "rendering/RenderBackend.h"
+#include "rendering/RenderState.h"
+#include "rendering/StagingRing.h"
+#include "utilities/ShaderManager.h"
+
+// OpenGL 3.3 implementation of RenderBackend. Must be created with the
+// context current; after that it may be used from whichever single thread
+// owns the context.
+class GLBackend : public RenderBackend
+{
+public:
+	explicit GLBackend(const std::string& shaderCacheDirectory);
+	~GLBackend() override;
+
+	const char* getName() const override;
+
+	void updateMesh(MeshHandle mesh, const MeshData& data) override;
+	void destroyMesh(MeshHandle mesh) override;
+
+	TextureHandle createTextureArray(const TextureArrayView& view) override;
+	void destroyTexture(TextureHandle texture) override;
+
+	void registerProgram(const std::string& name, const char* vertexSourcePath, const char* fragmentSourcePath,
+		const std::vector<std::string>& features) override;
+	ProgramHandle createProgram(const std::string& name, const std::vector<std::string>& defines) override;
+
+	void beginFrame(const FrameSnapshot& frame) override;
+	void drawPackets(const std::vector<DrawPacket>& packets) override;
+	void drawInstances(MeshHandle mesh, ProgramHandle program, TextureHandle texture, const std::vector<MeshInstance>& instances) override;
+	void drawOverlay(ProgramHandle program, TextureHandle texture, const std::vector<OverlayVertex>& vertices) override;
+	void endFrame() override;
+
+	void finish() override;
+	bool capture(std::vector<unsigned char>& pixels, int& width, int& height) override;
+
+	// Draws into an offscreen framebuffer from now on, for runs without a window
+	bool useOffscreenTarget(int width, int height);
+
+	const ShaderManager& getShaderManager() const;
+	const RenderState& getRenderState() const;
+	const GpuTimers& getGpuTimers() const;
+	const OcclusionQueries& getOcclusionQueries() const;
+
+private:
+	struct Mesh
+	{
+		GLuint VertexArray = 0;
+		GLuint VertexBuffer = 0;
+		GLuint IndexBuffer = 0;
+		GLsizei IndexCount = 0;
+		// Around the vertex positions, before the packet's model matrix
+		BoundingBox Bounds;
+		// Vertex and index bytes, mirrored to MemoryTracker
+		size_t BufferBytes = 0;
+		std::unique_ptr<InstanceRenderer> Instances;
+	};
+
+	struct Program
+	{
+		std::string Name;
+		ShaderFeatures Features = 0;
+		const Shader* Linked = nullptr;
+		UniformHandle ModelMatrix = -1;
+		UniformHandle TextureLayer = -1;
+	};
+
+	ShaderManager shaderManager;
+	RenderState renderState;
+	CameraUniforms cameraUniforms;
+	FrameFences frameFences;
+	DeferredDeleter deferredDeleter;
+	StagingRing stagingRing;
+	GpuTimers gpuTimers;
+	OcclusionQueries occlusionQueries;
+	std::unique_ptr<OffscreenTarget> offscreenTarget;
+
+	std::unordered_map<MeshHandle, Mesh> meshes;
+	std::vector<GLuint> textures;
+	std::vector<size_t> textureBytes;
+	std::vector<Program> programs;
+
+	// Created the first time an overlay is drawn
+	GLuint overlayVertexArray;
+	GLuint overlayVertexBuffer;
+	size_t overlayBufferBytes;
+
+	uint64_t gpuFrame;
+	int framePass;
+	int instancesPass;
+	int overlayPass;
+	int viewportWidth;
+	int viewportHeight;
+	bool wireframe;
+
+	Mesh* findMesh(MeshHandle mesh);
+	GLuint findTexture(TextureHandle texture) const;
+
+	// Ends a run of packets of one pass, issuing the occlusion queries after the opaque run
+	void finishPass(int pass);
+
+	// Finishes linking the first time a program is used
+	Program* resolveProgram(ProgramHandle program);
+};
+
+#endif
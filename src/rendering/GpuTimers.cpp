@@ -0,0 +1,170 @@
+// GpuTimers.cpp
+
+#include "GpuTimers.h"
+
+#include "utilities/Profiler.h"
+
+GpuTimers::GpuTimers()
+	: current(FrameSlots - 1), openCount(0)
+{
+	GLint counterBits = 0;
+	glGetQueryiv(GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &counterBits);
+	supported = counterBits > 0;
+	gpuTrack = Profiler::addTrack("GPU");
+
+	for (Frame& frame : frames)
+	{
+		glGenQueries((GLsizei)frame.Timestamps.size(), frame.Timestamps.data());
+	}
+}
+
+GpuTimers::~GpuTimers()
+{
+	for (Frame& frame : frames)
+	{
+		glDeleteQueries((GLsizei)frame.Timestamps.size(), frame.Timestamps.data());
+	}
+}
+
+bool GpuTimers::isSupported() const
+{
+	return supported;
+}
+
+void GpuTimers::beginFrame(uint64_t frame, PassTimings& timings)
+{
+	// Passes left open would leave an end timestamp that is never written
+	while (openCount > 0)
+	{
+		endPass();
+	}
+
+	Frame& previous = frames[current];
+	previous.Pending = previous.QueryCount > 0;
+
+	// Oldest first, the GPU finishes frames in order so the first unfinished one ends the scan
+	for (int i = 1; i <= FrameSlots; i++)
+	{
+		Frame& pending = frames[(current + i) % FrameSlots];
+		if (!pending.Pending)
+		{
+			continue;
+		}
+
+		if (supported)
+		{
+			GLuint available = 0;
+			glGetQueryObjectuiv(pending.LastTimestamp, GL_QUERY_RESULT_AVAILABLE, &available);
+			if (!available)
+			{
+				break;
+			}
+		}
+		resolve(pending, timings, supported);
+	}
+
+	current = (current + 1) % FrameSlots;
+	Frame& next = frames[current];
+	if (next.Pending)
+	{
+		resolve(next, timings, false);
+		stats.FramesDropped++;
+	}
+
+	next.Index = frame;
+	next.QueryCount = 0;
+
+	// Reading the GPU clock does not wait for queued work, it is only done while tracing anyway
+	next.Traced = supported && Profiler::isCapturing();
+	if (next.Traced)
+	{
+		GLint64 gpuNow = 0;
+		glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+		next.ClockOffset = (int64_t)Profiler::now() - gpuNow;
+	}
+}
+
+void GpuTimers::beginPass(int pass)
+{
+	Frame& frame = frames[current];
+
+	int index = -1;
+	if (frame.QueryCount < MaxPassesPerFrame)
+	{
+		index = frame.QueryCount++;
+		Query& query = frame.Queries[index];
+		query.Pass = pass;
+		query.CpuStart = Clock::now();
+		if (supported)
+		{
+			glQueryCounter(frame.Timestamps[index * 2], GL_TIMESTAMP);
+		}
+	}
+
+	// Passes past the limit still take a slot here so endPass stays balanced
+	if (openCount < MaxPassesPerFrame)
+	{
+		openQueries[openCount++] = index;
+	}
+}
+
+void GpuTimers::endPass()
+{
+	if (openCount == 0)
+	{
+		return;
+	}
+
+	int index = openQueries[--openCount];
+	if (index < 0)
+	{
+		return;
+	}
+
+	Frame& frame = frames[current];
+	Query& query = frame.Queries[index];
+	query.CpuMilliseconds = std::chrono::duration<float, std::milli>(Clock::now() - query.CpuStart).count();
+	if (supported)
+	{
+		frame.LastTimestamp = frame.Timestamps[index * 2 + 1];
+		glQueryCounter(frame.LastTimestamp, GL_TIMESTAMP);
+	}
+}
+
+const GpuTimers::Stats& GpuTimers::getStats() const
+{
+	return stats;
+}
+
+void GpuTimers::resolve(Frame& frame, PassTimings& timings, bool readGpu)
+{
+	for (int i = 0; i < frame.QueryCount; i++)
+	{
+		const Query& query = frame.Queries[i];
+
+		PassTimings::Sample sample;
+		sample.Frame = frame.Index;
+		sample.CpuMilliseconds = query.CpuMilliseconds;
+		if (readGpu)
+		{
+			GLuint64 begin = 0;
+			GLuint64 end = 0;
+			glGetQueryObjectui64v(frame.Timestamps[i * 2], GL_QUERY_RESULT, &begin);
+			glGetQueryObjectui64v(frame.Timestamps[i * 2 + 1], GL_QUERY_RESULT, &end);
+			sample.GpuMilliseconds = end > begin ? (float)((end - begin) / 1.0e6) : 0.0f;
+
+			if (frame.Traced)
+			{
+				Profiler::recordTrack(gpuTrack, timings.getName(query.Pass),
+					(uint64_t)((int64_t)begin + frame.ClockOffset), (uint64_t)((int64_t)end + frame.ClockOffset));
+			}
+		}
+		timings.record(query.Pass, sample);
+	}
+
+	frame.Pending = false;
+	if (readGpu)
+	{
+		stats.FramesResolved++;
+	}
+}
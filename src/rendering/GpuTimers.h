@@ -0,0 +1,92 @@
+// GpuTimers.h
+
+#ifndef GPU_TIMERS_H
+#define GPU_TIMERS_H
+
+#include <glad/glad.h>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+#include "rendering/FrameFences.h"
+#include "rendering/PassTimings.h"
+
+// Brackets render passes with a pair of GL_TIMESTAMP queries and times
+// their submission on the CPU. Timestamps rather than GL_TIME_ELAPSED, so
+// passes may nest (a whole-frame pass around the others). Each frame gets
+// its own pool of queries; a frame's results are polled without blocking
+// and land in PassTimings once the GPU has finished it, usually two or
+// three frames later. If the pool wraps before that the GPU times of the
+// oldest frame are given up and only its CPU times are kept. While a
+// profiler capture is running, resolved passes are also kept as zones on
+// the trace's "GPU" row, moved onto the CPU clock.
+class GpuTimers
+{
+public:
+	static const int FrameSlots = FrameFences::MaxFramesInFlight + 2;
+	static const int MaxPassesPerFrame = 16;
+
+	struct Stats
+	{
+		uint64_t FramesResolved = 0;
+		uint64_t FramesDropped = 0;
+	};
+
+	GpuTimers();
+	~GpuTimers();
+
+	GpuTimers(const GpuTimers&) = delete;
+	GpuTimers& operator=(const GpuTimers&) = delete;
+
+	// False if the driver reports no timestamp bits, only CPU times are recorded then
+	bool isSupported() const;
+
+	// Moves every finished frame's results into timings, then starts recording frame
+	void beginFrame(uint64_t frame, PassTimings& timings);
+
+	// Passes may nest but must end in reverse order of beginning
+	void beginPass(int pass);
+	void endPass();
+
+	const Stats& getStats() const;
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	struct Query
+	{
+		int Pass = 0;
+		Clock::time_point CpuStart;
+		float CpuMilliseconds = 0.0f;
+	};
+
+	struct Frame
+	{
+		uint64_t Index = 0;
+		bool Pending = false;
+		int QueryCount = 0;
+		std::array<Query, MaxPassesPerFrame> Queries;
+		// Begin and end timestamp of every query
+		std::array<GLuint, MaxPassesPerFrame * 2> Timestamps;
+		// Issued last, so once it is available the whole frame is
+		GLuint LastTimestamp = 0;
+		// Set when a capture was running as the frame began
+		bool Traced = false;
+		// Profiler::now() minus the GPU timestamp, sampled as the frame began
+		int64_t ClockOffset = 0;
+	};
+
+	std::array<Frame, FrameSlots> frames;
+	int current;
+	std::array<int, MaxPassesPerFrame> openQueries;
+	int openCount;
+	bool supported;
+	uint32_t gpuTrack;
+
+	Stats stats;
+
+	void resolve(Frame& frame, PassTimings& timings, bool readGpu);
+};
+
+#endif
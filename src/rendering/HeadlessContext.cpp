@@ -0,0 +1,153 @@
+// HeadlessContext.cpp
+
+#include "HeadlessContext.h"
+
+#include <iostream>
+
+#ifdef VOXEL_HEADLESS_EGL
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include <cstring>
+
+HeadlessContext::HeadlessContext()
+	: display(EGL_NO_DISPLAY), context(EGL_NO_CONTEXT)
+{
+}
+
+HeadlessContext::~HeadlessContext()
+{
+	destroy();
+}
+
+bool HeadlessContext::create()
+{
+	// The surfaceless platform needs no X11, Wayland or DRM device at all
+	EGLDisplay eglDisplay = EGL_NO_DISPLAY;
+	const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+	if (clientExtensions && std::strstr(clientExtensions, "EGL_MESA_platform_surfaceless"))
+	{
+		PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+			(PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+		if (getPlatformDisplay)
+		{
+			eglDisplay = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+		}
+	}
+	if (eglDisplay == EGL_NO_DISPLAY)
+	{
+		eglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	}
+
+	EGLint major = 0;
+	EGLint minor = 0;
+	if (eglDisplay == EGL_NO_DISPLAY || !eglInitialize(eglDisplay, &major, &minor))
+	{
+		std::cout << "ERROR::HEADLESS::EGL_INITIALIZE_FAILED\n";
+		return false;
+	}
+	display = eglDisplay;
+
+	if (!eglBindAPI(EGL_OPENGL_API))
+	{
+		std::cout << "ERROR::HEADLESS::OPENGL_API_UNAVAILABLE\n";
+		destroy();
+		return false;
+	}
+
+	const EGLint configAttributes[] = {
+		EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_RED_SIZE, 8,
+		EGL_GREEN_SIZE, 8,
+		EGL_BLUE_SIZE, 8,
+		EGL_ALPHA_SIZE, 8,
+		EGL_DEPTH_SIZE, 24,
+		EGL_NONE
+	};
+	EGLConfig config = nullptr;
+	EGLint configCount = 0;
+	if (!eglChooseConfig(eglDisplay, configAttributes, &config, 1, &configCount) || configCount == 0)
+	{
+		std::cout << "ERROR::HEADLESS::NO_MATCHING_CONFIG\n";
+		destroy();
+		return false;
+	}
+
+	// Same version and profile as the GLFW window
+	const EGLint contextAttributes[] = {
+		EGL_CONTEXT_MAJOR_VERSION, 3,
+		EGL_CONTEXT_MINOR_VERSION, 3,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+		EGL_NONE
+	};
+	EGLContext eglContext = eglCreateContext(eglDisplay, config, EGL_NO_CONTEXT, contextAttributes);
+	if (eglContext == EGL_NO_CONTEXT)
+	{
+		std::cout << "ERROR::HEADLESS::CONTEXT_CREATION_FAILED\n";
+		destroy();
+		return false;
+	}
+	context = eglContext;
+
+	// Rendering goes to an FBO, so no surface is ever bound
+	if (!eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, eglContext))
+	{
+		std::cout << "ERROR::HEADLESS::MAKE_CURRENT_FAILED\n";
+		destroy();
+		return false;
+	}
+
+	return true;
+}
+
+void HeadlessContext::destroy()
+{
+	if (display == EGL_NO_DISPLAY)
+	{
+		return;
+	}
+
+	eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+	if (context != EGL_NO_CONTEXT)
+	{
+		eglDestroyContext(display, context);
+		context = EGL_NO_CONTEXT;
+	}
+	eglTerminate(display);
+	display = EGL_NO_DISPLAY;
+}
+
+void* HeadlessContext::getProcAddress(const char* name)
+{
+	return (void*)eglGetProcAddress(name);
+}
+
+#else
+
+HeadlessContext::HeadlessContext()
+	: display(nullptr), context(nullptr)
+{
+}
+
+HeadlessContext::~HeadlessContext()
+{
+}
+
+bool HeadlessContext::create()
+{
+	std::cout << "ERROR::HEADLESS::NOT_BUILT_WITH_EGL\n";
+	return false;
+}
+
+void HeadlessContext::destroy()
+{
+}
+
+void* HeadlessContext::getProcAddress(const char*)
+{
+	return nullptr;
+}
+
+#endif
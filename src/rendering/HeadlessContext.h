@@ -0,0 +1,32 @@
+// HeadlessContext.h
+
+#ifndef HEADLESS_CONTEXT_H
+#define HEADLESS_CONTEXT_H
+
+// OpenGL 3.3 core context without a window or display, for benchmark runs
+// on build machines. Uses a surfaceless EGL display, which Mesa's llvmpipe
+// provides even without a GPU. Only available when built with
+// VOXEL_HEADLESS_EGL, create() fails otherwise.
+class HeadlessContext
+{
+public:
+	HeadlessContext();
+	~HeadlessContext();
+
+	HeadlessContext(const HeadlessContext&) = delete;
+	HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+	// Creates the context and makes it current on the calling thread
+	bool create();
+	void destroy();
+
+	// Matches GLADloadproc
+	static void* getProcAddress(const char* name);
+
+private:
+	// EGLDisplay and EGLContext, kept opaque so EGL headers stay out of here
+	void* display;
+	void* context;
+};
+
+#endif
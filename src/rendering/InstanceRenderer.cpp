@@ -0,0 +1,138 @@
+// InstanceRenderer.cpp
+
+#include "InstanceRenderer.h"
+
+#include <cstddef>
+
+#include "utilities/MemoryTracker.h"
+
+// The position attribute reads Position and Scale as one vec4
+static_assert(offsetof(MeshInstance, Scale) == offsetof(MeshInstance, Position) + sizeof(glm::vec3), "MeshInstance layout");
+
+InstanceRenderer::InstanceRenderer(GLuint vertexArray, GLsizei indexCount)
+	: vertexArray(vertexArray), indexCount(indexCount), instanceBuffer(0), capacity(1), instanceCount(0),
+	sourceBuffer(0), sourceOffset(0)
+{
+	glGenBuffers(1, &instanceBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+
+	// One default instance keeps non-instanced draws of the same VAO reading valid memory
+	MeshInstance defaultInstance;
+	glBufferData(GL_ARRAY_BUFFER, sizeof(MeshInstance), &defaultInstance, GL_STREAM_DRAW);
+	MemoryTracker::add(MEMORY_GPU_BUFFERS, sizeof(MeshInstance));
+
+	glBindVertexArray(vertexArray);
+	pointAttributes(0);
+	sourceBuffer = instanceBuffer;
+
+	GLuint attributes[] = { PositionScaleAttribute, RotationAttribute, TextureLayerAttribute };
+	for (GLuint attribute : attributes)
+	{
+		glEnableVertexAttribArray(attribute);
+		glVertexAttribDivisor(attribute, 1);
+	}
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+InstanceRenderer::~InstanceRenderer()
+{
+	if (instanceBuffer != 0)
+	{
+		glDeleteBuffers(1, &instanceBuffer);
+		MemoryTracker::remove(MEMORY_GPU_BUFFERS, capacity * sizeof(MeshInstance));
+	}
+}
+
+void InstanceRenderer::upload(RenderState& renderState, const std::vector<MeshInstance>& instances, StagingRing* staging)
+{
+	stats = Stats();
+	instanceCount = instances.size();
+	if (instances.empty())
+	{
+		return;
+	}
+
+	size_t bytes = instances.size() * sizeof(MeshInstance);
+	GLintptr stagingOffset = staging ? staging->write(renderState, instances.data(), bytes, 16) : -1;
+	if (stagingOffset >= 0)
+	{
+		if (sourceBuffer != staging->getBuffer() || sourceOffset != stagingOffset)
+		{
+			renderState.bindVertexArray(vertexArray);
+			renderState.bindBuffer(GL_ARRAY_BUFFER, staging->getBuffer());
+			pointAttributes(stagingOffset);
+			sourceBuffer = staging->getBuffer();
+			sourceOffset = stagingOffset;
+		}
+		stats.FromStaging = true;
+		return;
+	}
+
+	renderState.bindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+
+	// Grow geometrically so a slowly rising count does not reallocate every frame
+	if (instances.size() > capacity)
+	{
+		MemoryTracker::remove(MEMORY_GPU_BUFFERS, capacity * sizeof(MeshInstance));
+		while (capacity < instances.size())
+		{
+			capacity *= 2;
+		}
+		MemoryTracker::add(MEMORY_GPU_BUFFERS, capacity * sizeof(MeshInstance));
+		stats.BufferReallocations++;
+	}
+
+	glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(MeshInstance), nullptr, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, instances.data());
+
+	if (sourceBuffer != instanceBuffer || sourceOffset != 0)
+	{
+		renderState.bindVertexArray(vertexArray);
+		pointAttributes(0);
+		sourceBuffer = instanceBuffer;
+		sourceOffset = 0;
+	}
+}
+
+void InstanceRenderer::draw(RenderState& renderState, const Shader& shader, GLuint textureArray)
+{
+	if (instanceCount == 0)
+	{
+		return;
+	}
+
+	renderState.useProgram(shader.Id);
+	renderState.bindTexture(0, GL_TEXTURE_2D_ARRAY, textureArray);
+	renderState.bindVertexArray(vertexArray);
+
+	glDrawElementsInstanced(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0, (GLsizei)instanceCount);
+
+	stats.Instances = (int)instanceCount;
+	stats.DrawCalls++;
+}
+
+GLuint InstanceRenderer::releaseInstanceBuffer()
+{
+	GLuint buffer = instanceBuffer;
+	if (instanceBuffer != 0)
+	{
+		MemoryTracker::remove(MEMORY_GPU_BUFFERS, capacity * sizeof(MeshInstance));
+	}
+	instanceBuffer = 0;
+	return buffer;
+}
+
+void InstanceRenderer::pointAttributes(GLintptr offset)
+{
+	GLsizei stride = sizeof(MeshInstance);
+	glVertexAttribPointer(PositionScaleAttribute, 4, GL_FLOAT, GL_FALSE, stride, (void*)(offset + offsetof(MeshInstance, Position)));
+	glVertexAttribPointer(RotationAttribute, 4, GL_FLOAT, GL_FALSE, stride, (void*)(offset + offsetof(MeshInstance, Rotation)));
+	glVertexAttribPointer(TextureLayerAttribute, 1, GL_FLOAT, GL_FALSE, stride, (void*)(offset + offsetof(MeshInstance, TextureLayer)));
+}
+
+const InstanceRenderer::Stats& InstanceRenderer::getStats() const
+{
+	return stats;
+}
@@ -0,0 +1,68 @@
+// InstanceRenderer.h
+
+#ifndef INSTANCE_RENDERER_H
+#define INSTANCE_RENDERER_H
+
+#include <glad/glad.h>
+
+#include <vector>
+
+#include "rendering/RenderState.h"
+#include "rendering/RenderTypes.h"
+#include "rendering/StagingRing.h"
+#include "utilities/Shader.h"
+
+// Draws every instance of one mesh with a single glDrawElementsInstanced.
+// The instance attributes are added to the mesh's own VAO, so the mesh
+// data is shared with the regular draw path.
+class InstanceRenderer
+{
+public:
+	static const GLuint PositionScaleAttribute = 3;
+	static const GLuint RotationAttribute = 4;
+	static const GLuint TextureLayerAttribute = 5;
+
+	struct Stats
+	{
+		int Instances = 0;
+		int DrawCalls = 0;
+		int BufferReallocations = 0;
+		bool FromStaging = false;
+	};
+
+	InstanceRenderer(GLuint vertexArray, GLsizei indexCount);
+	~InstanceRenderer();
+
+	InstanceRenderer(const InstanceRenderer&) = delete;
+	InstanceRenderer& operator=(const InstanceRenderer&) = delete;
+
+	// Streams this frame's instances. With a staging ring the instances are
+	// drawn straight out of it, otherwise (or when the ring is full) the
+	// renderer's own buffer is orphaned so the driver never waits on draws
+	// still reading last frame's data
+	void upload(RenderState& renderState, const std::vector<MeshInstance>& instances, StagingRing* staging = nullptr);
+	void draw(RenderState& renderState, const Shader& shader, GLuint textureArray);
+
+	// Hands the instance buffer to the caller, e.g. to delete it once the GPU is done with it
+	GLuint releaseInstanceBuffer();
+
+	const Stats& getStats() const;
+
+private:
+	GLuint vertexArray;
+	GLsizei indexCount;
+	GLuint instanceBuffer;
+	size_t capacity;
+	size_t instanceCount;
+
+	// Where the instance attributes currently point
+	GLuint sourceBuffer;
+	GLintptr sourceOffset;
+
+	Stats stats;
+
+	// Expects the VAO and the source buffer to be bound
+	void pointAttributes(GLintptr offset);
+};
+
+#endif
@@ -0,0 +1,181 @@
+// NullBackend.cpp
+
+#include "NullBackend.h"
+
+#include "rendering/BlockTextures.h"
+#include "rendering/FrameExchange.h"
+
+NullBackend::NullBackend()
+{
+	framePass = passTimings.getPass("Frame");
+	instancesPass = passTimings.getPass("Instances");
+	overlayPass = passTimings.getPass("Debug overlay");
+}
+
+const char* NullBackend::getName() const
+{
+	return "Null";
+}
+
+void NullBackend::updateMesh(MeshHandle mesh, const MeshData& data)
+{
+	if (meshes.find(mesh) == meshes.end())
+	{
+		frameStats.ResourcesCreated++;
+	}
+	meshes[mesh] = data.Indices.size();
+	frameStats.BytesUploaded += data.Vertices.size() * sizeof(float) + data.Indices.size() * sizeof(unsigned int);
+}
+
+void NullBackend::destroyMesh(MeshHandle mesh)
+{
+	if (meshes.erase(mesh) > 0)
+	{
+		frameStats.ResourcesDestroyed++;
+	}
+}
+
+TextureHandle NullBackend::createTextureArray(const TextureArrayView& view)
+{
+	for (size_t level = 0; level < view.Levels.size(); level++)
+	{
+		int width = TextureArrayData::getLevelSize(view.Width, (int)level);
+		int height = TextureArrayData::getLevelSize(view.Height, (int)level);
+		frameStats.BytesUploaded += (uint64_t)width * height * view.Layers * 4;
+	}
+
+	frameStats.ResourcesCreated++;
+	return nextTexture++;
+}
+
+void NullBackend::destroyTexture(TextureHandle texture)
+{
+	if (texture != 0)
+	{
+		frameStats.ResourcesDestroyed++;
+	}
+}
+
+void NullBackend::registerProgram(const std::string&, const char*, const char*, const std::vector<std::string>&)
+{
+}
+
+ProgramHandle NullBackend::createProgram(const std::string&, const std::vector<std::string>&)
+{
+	frameStats.ResourcesCreated++;
+	return nextProgram++;
+}
+
+void NullBackend::beginFrame(const FrameSnapshot& frame)
+{
+	frameIndex = frame.FrameIndex;
+	frameStart = Clock::now();
+
+	for (MeshHandle mesh : frame.MeshDeletions)
+	{
+		destroyMesh(mesh);
+	}
+	for (const MeshUpload& upload : frame.MeshUploads)
+	{
+		updateMesh(upload.Mesh, upload.Data);
+	}
+}
+
+void NullBackend::drawPackets(const std::vector<DrawPacket>& packets)
+{
+	ProgramHandle currentProgram = 0;
+	MeshHandle currentMesh = 0;
+	TextureHandle currentTexture = 0;
+	size_t indexCount = 0;
+	int currentPass = -1;
+	Clock::time_point passStart;
+
+	for (const DrawPacket& packet : packets)
+	{
+		int pass = RenderQueue::getPass(packet.Key);
+		if (pass != currentPass)
+		{
+			if (currentPass != -1)
+			{
+				recordPass(passTimings.getPass(RenderQueue::getPassName(currentPass)), passStart);
+			}
+			currentPass = pass;
+			passStart = Clock::now();
+		}
+
+		if (packet.Program != currentProgram)
+		{
+			currentProgram = packet.Program;
+			frameStats.StateChanges++;
+		}
+		if (packet.Mesh != currentMesh)
+		{
+			currentMesh = packet.Mesh;
+			auto it = meshes.find(packet.Mesh);
+			indexCount = it != meshes.end() ? it->second : 0;
+			frameStats.StateChanges++;
+		}
+		if (packet.Texture != currentTexture)
+		{
+			currentTexture = packet.Texture;
+			frameStats.StateChanges++;
+		}
+
+		frameStats.DrawCalls++;
+		frameStats.Triangles += indexCount / 3;
+	}
+
+	if (currentPass != -1)
+	{
+		recordPass(passTimings.getPass(RenderQueue::getPassName(currentPass)), passStart);
+	}
+}
+
+void NullBackend::drawInstances(MeshHandle mesh, ProgramHandle, TextureHandle, const std::vector<MeshInstance>& instances)
+{
+	auto it = meshes.find(mesh);
+	if (it == meshes.end() || instances.empty())
+	{
+		return;
+	}
+	Clock::time_point passStart = Clock::now();
+
+	frameStats.DrawCalls++;
+	frameStats.StateChanges += 3;
+	frameStats.Instances += (int)instances.size();
+	frameStats.Triangles += (uint64_t)(it->second / 3) * instances.size();
+	frameStats.BytesUploaded += instances.size() * sizeof(MeshInstance);
+	recordPass(instancesPass, passStart);
+}
+
+void NullBackend::drawOverlay(ProgramHandle, TextureHandle, const std::vector<OverlayVertex>& vertices)
+{
+	if (vertices.empty())
+	{
+		return;
+	}
+	recordPass(overlayPass, Clock::now());
+}
+
+void NullBackend::endFrame()
+{
+	recordPass(framePass, frameStart);
+	finishFrameStats();
+}
+
+void NullBackend::finish()
+{
+}
+
+bool NullBackend::capture(std::vector<unsigned char>&, int&, int&)
+{
+	return false;
+}
+
+void NullBackend::recordPass(int pass, Clock::time_point start)
+{
+	PassTimings::Sample sample;
+	sample.Frame = frameIndex;
+	sample.CpuMilliseconds = std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+	passTimings.record(pass, sample);
+}
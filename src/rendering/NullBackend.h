@@ -0,0 +1,58 @@
+// NullBackend.h
+
+#ifndef NULL_BACKEND_H
+#define NULL_BACKEND_H
+
+#include <chrono>
+#include <unordered_map>
+
+#include "rendering/RenderBackend.h"
+
+// Backend that draws nothing. It keeps just enough bookkeeping to report
+// the same draw call, state change and upload counts the GL backend would,
+// so the engine loop can be stress tested without a context.
+class NullBackend : public RenderBackend
+{
+public:
+	const char* getName() const override;
+
+	void updateMesh(MeshHandle mesh, const MeshData& data) override;
+	void destroyMesh(MeshHandle mesh) override;
+
+	TextureHandle createTextureArray(const TextureArrayView& view) override;
+	void destroyTexture(TextureHandle texture) override;
+
+	void registerProgram(const std::string& name, const char* vertexSourcePath, const char* fragmentSourcePath,
+		const std::vector<std::string>& features) override;
+	ProgramHandle createProgram(const std::string& name, const std::vector<std::string>& defines) override;
+
+	void beginFrame(const FrameSnapshot& frame) override;
+	void drawPackets(const std::vector<DrawPacket>& packets) override;
+	void drawInstances(MeshHandle mesh, ProgramHandle program, TextureHandle texture, const std::vector<MeshInstance>& instances) override;
+	void drawOverlay(ProgramHandle program, TextureHandle texture, const std::vector<OverlayVertex>& vertices) override;
+	void endFrame() override;
+
+	void finish() override;
+	bool capture(std::vector<unsigned char>& pixels, int& width, int& height) override;
+
+	NullBackend();
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	// Index count of every live mesh
+	std::unordered_map<MeshHandle, size_t> meshes;
+	TextureHandle nextTexture = 1;
+	ProgramHandle nextProgram = 1;
+
+	// Passes only get CPU times, recorded as soon as they end
+	uint64_t frameIndex = 0;
+	Clock::time_point frameStart;
+	int framePass;
+	int instancesPass;
+	int overlayPass;
+
+	void recordPass(int pass, Clock::time_point start);
+};
+
+#endif
@@ -0,0 +1,263 @@
+// OcclusionBuffer.cpp
+
+#include "OcclusionBuffer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "utilities/JobSystem.h"
+#include "utilities/Profiler.h"
+
+namespace
+{
+	const float NEAR_W = 1e-4f;
+
+	// Box faces as corner indices (bit 0 = x, bit 1 = y, bit 2 = z),
+	// counter-clockwise when seen from outside the box
+	const int BOX_FACES[6][4] = {
+		{ 0, 4, 6, 2 },
+		{ 1, 3, 7, 5 },
+		{ 0, 1, 5, 4 },
+		{ 2, 6, 7, 3 },
+		{ 0, 2, 3, 1 },
+		{ 4, 5, 7, 6 }
+	};
+
+	float edge(const glm::vec3& a, const glm::vec3& b, float x, float y)
+	{
+		return (b.x - a.x) * (y - a.y) - (b.y - a.y) * (x - a.x);
+	}
+}
+
+OcclusionBuffer::OcclusionBuffer(int width, int height)
+	: width(width), height(height), viewProjection(1.0f)
+{
+	int levelWidth = width;
+	int levelHeight = height;
+	while (true)
+	{
+		mips.push_back({ levelWidth, levelHeight, std::vector<float>(levelWidth * levelHeight, 1.0f) });
+		if (levelWidth == 1 && levelHeight == 1)
+		{
+			break;
+		}
+		levelWidth = std::max(1, (levelWidth + 1) / 2);
+		levelHeight = std::max(1, (levelHeight + 1) / 2);
+	}
+}
+
+void OcclusionBuffer::rasterize(const glm::mat4& viewProjection, const ArenaVector<BoundingBox>& occluders, FrameArena& arena, JobSystem& jobs,
+	int bandCount)
+{
+	this->viewProjection = viewProjection;
+	setupTriangles(occluders, arena);
+
+	std::fill(mips[0].Depth.begin(), mips[0].Depth.end(), 1.0f);
+
+	// Each job owns a band of rows, so no two jobs ever write the same texel
+	jobs.parallelFor(height, [&](int firstRow, int endRow)
+	{
+		rasterizeRows(firstRow, endRow);
+	}, std::max(1, bandCount));
+
+	buildMips();
+}
+
+void OcclusionBuffer::setupTriangles(const ArenaVector<BoundingBox>& occluders, FrameArena& arena)
+{
+	triangles = ArenaVector<Triangle>(ArenaAllocator<Triangle>(arena));
+
+	for (const BoundingBox& box : occluders)
+	{
+		glm::vec3 screen[8];
+		bool crossesNearPlane = false;
+
+		for (int i = 0; i < 8; i++)
+		{
+			glm::vec4 clip = viewProjection * glm::vec4(box.getCorner(i), 1.0f);
+			if (clip.w < NEAR_W)
+			{
+				crossesNearPlane = true;
+				break;
+			}
+
+			glm::vec3 ndc = glm::vec3(clip) / clip.w;
+			screen[i] = glm::vec3(
+				(ndc.x * 0.5f + 0.5f) * width,
+				(ndc.y * 0.5f + 0.5f) * height,
+				glm::clamp(ndc.z * 0.5f + 0.5f, 0.0f, 1.0f));
+		}
+
+		// Clipping occluders is not worth it, dropping one only loses occlusion
+		if (crossesNearPlane)
+		{
+			continue;
+		}
+
+		for (const auto& face : BOX_FACES)
+		{
+			const glm::vec3& a = screen[face[0]];
+			const glm::vec3& b = screen[face[1]];
+			const glm::vec3& c = screen[face[2]];
+			const glm::vec3& d = screen[face[3]];
+
+			// Back faces always lie behind front faces of the same box
+			if (edge(a, b, c.x, c.y) > 0.0f)
+			{
+				triangles.push_back({ a, b, c });
+			}
+			if (edge(a, c, d.x, d.y) > 0.0f)
+			{
+				triangles.push_back({ a, c, d });
+			}
+		}
+	}
+}
+
+void OcclusionBuffer::rasterizeRows(int firstRow, int endRow)
+{
+	PROFILE_SCOPE("Rasterize occluders");
+
+	std::vector<float>& depth = mips[0].Depth;
+
+	for (const Triangle& triangle : triangles)
+	{
+		float area = edge(triangle.v0, triangle.v1, triangle.v2.x, triangle.v2.y);
+
+		float minX = std::min({ triangle.v0.x, triangle.v1.x, triangle.v2.x });
+		float maxX = std::max({ triangle.v0.x, triangle.v1.x, triangle.v2.x });
+		float minY = std::min({ triangle.v0.y, triangle.v1.y, triangle.v2.y });
+		float maxY = std::max({ triangle.v0.y, triangle.v1.y, triangle.v2.y });
+
+		int x0 = std::max(0, (int)std::floor(minX));
+		int x1 = std::min(width - 1, (int)std::ceil(maxX));
+		int y0 = std::max(firstRow, (int)std::floor(minY));
+		int y1 = std::min(endRow - 1, (int)std::ceil(maxY));
+
+		// NDC depth is affine in screen space, so barycentric interpolation is exact
+		float inverseArea = 1.0f / area;
+		for (int y = y0; y <= y1; y++)
+		{
+			float sampleY = y + 0.5f;
+			float* row = &depth[y * width];
+
+			for (int x = x0; x <= x1; x++)
+			{
+				float sampleX = x + 0.5f;
+				float w0 = edge(triangle.v1, triangle.v2, sampleX, sampleY);
+				float w1 = edge(triangle.v2, triangle.v0, sampleX, sampleY);
+				float w2 = edge(triangle.v0, triangle.v1, sampleX, sampleY);
+				if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f)
+				{
+					continue;
+				}
+
+				float z = (w0 * triangle.v0.z + w1 * triangle.v1.z + w2 * triangle.v2.z) * inverseArea;
+				row[x] = std::min(row[x], z);
+			}
+		}
+	}
+}
+
+void OcclusionBuffer::buildMips()
+{
+	for (size_t level = 1; level < mips.size(); level++)
+	{
+		const MipLevel& source = mips[level - 1];
+		MipLevel& target = mips[level];
+
+		for (int y = 0; y < target.Height; y++)
+		{
+			int sy0 = std::min(y * 2, source.Height - 1);
+			int sy1 = std::min(y * 2 + 1, source.Height - 1);
+
+			for (int x = 0; x < target.Width; x++)
+			{
+				int sx0 = std::min(x * 2, source.Width - 1);
+				int sx1 = std::min(x * 2 + 1, source.Width - 1);
+
+				target.Depth[y * target.Width + x] = std::max(
+					std::max(source.Depth[sy0 * source.Width + sx0], source.Depth[sy0 * source.Width + sx1]),
+					std::max(source.Depth[sy1 * source.Width + sx0], source.Depth[sy1 * source.Width + sx1]));
+			}
+		}
+	}
+}
+
+bool OcclusionBuffer::isOccluded(const BoundingBox& box) const
+{
+	glm::vec3 screenMin(1e30f);
+	glm::vec3 screenMax(-1e30f);
+
+	for (int i = 0; i < 8; i++)
+	{
+		glm::vec4 clip = viewProjection * glm::vec4(box.getCorner(i), 1.0f);
+
+		// Boxes touching the near plane are always considered visible
+		if (clip.w < NEAR_W)
+		{
+			return false;
+		}
+
+		glm::vec3 ndc = glm::vec3(clip) / clip.w;
+		glm::vec3 screen(
+			(ndc.x * 0.5f + 0.5f) * width,
+			(ndc.y * 0.5f + 0.5f) * height,
+			ndc.z * 0.5f + 0.5f);
+		screenMin = glm::min(screenMin, screen);
+		screenMax = glm::max(screenMax, screen);
+	}
+
+	// Off screen boxes are left to frustum culling
+	if (screenMax.x < 0.0f || screenMax.y < 0.0f || screenMin.x >= width || screenMin.y >= height)
+	{
+		return false;
+	}
+
+	int x0 = std::max(0, (int)std::floor(screenMin.x));
+	int x1 = std::min(width - 1, (int)std::floor(screenMax.x));
+	int y0 = std::max(0, (int)std::floor(screenMin.y));
+	int y1 = std::min(height - 1, (int)std::floor(screenMax.y));
+
+	// Pick the first level where the box spans at most 2x2 texels
+	size_t level = 0;
+	while (level + 1 < mips.size() && ((x1 >> level) - (x0 >> level) > 1 || (y1 >> level) - (y0 >> level) > 1))
+	{
+		level++;
+	}
+
+	const MipLevel& mip = mips[level];
+	for (int y = y0 >> level; y <= (y1 >> level); y++)
+	{
+		for (int x = x0 >> level; x <= (x1 >> level); x++)
+		{
+			if (screenMin.z <= mip.Depth[y * mip.Width + x])
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+int OcclusionBuffer::getWidth() const
+{
+	return width;
+}
+
+int OcclusionBuffer::getHeight() const
+{
+	return height;
+}
+
+int OcclusionBuffer::getMipCount() const
+{
+	return (int)mips.size();
+}
+
+float OcclusionBuffer::getDepth(int level, int x, int y) const
+{
+	const MipLevel& mip = mips[level];
+	return mip.Depth[y * mip.Width + x];
+}
@@ -0,0 +1,65 @@
+// OcclusionBuffer.h
+
+#ifndef OCCLUSION_BUFFER_H
+#define OCCLUSION_BUFFER_H
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "utilities/ArenaAllocator.h"
+#include "utilities/BoundingBox.h"
+
+class JobSystem;
+
+// A small CPU depth buffer that occluder boxes are rasterized into and
+// bounding boxes are tested against. Depth is stored in [0, 1] with 1 at
+// the far plane. After rasterization a max-depth mip chain is built so a
+// box test only has to look at a handful of texels.
+class OcclusionBuffer
+{
+public:
+	OcclusionBuffer(int width = 256, int height = 128);
+
+	// Rasterizes the front faces of every occluder, splitting the rows of
+	// the buffer into bandCount bands that run as jobs, then rebuilds the
+	// mip chain. The frame's triangles are allocated from arena.
+	void rasterize(const glm::mat4& viewProjection, const ArenaVector<BoundingBox>& occluders, FrameArena& arena, JobSystem& jobs,
+		int bandCount);
+
+	// True if the box is entirely behind the rasterized occluders
+	bool isOccluded(const BoundingBox& box) const;
+
+	int getWidth() const;
+	int getHeight() const;
+	int getMipCount() const;
+	float getDepth(int level, int x, int y) const;
+
+private:
+	struct Triangle
+	{
+		glm::vec3 v0;
+		glm::vec3 v1;
+		glm::vec3 v2;
+	};
+
+	struct MipLevel
+	{
+		int Width;
+		int Height;
+		std::vector<float> Depth;
+	};
+
+	int width;
+	int height;
+	glm::mat4 viewProjection;
+
+	std::vector<MipLevel> mips;
+	ArenaVector<Triangle> triangles;
+
+	void setupTriangles(const ArenaVector<BoundingBox>& occluders, FrameArena& arena);
+	void rasterizeRows(int firstRow, int endRow);
+	void buildMips();
+};
+
+#endif
@@ -0,0 +1,83 @@
+// OcclusionCuller.cpp
+
+#include "OcclusionCuller.h"
+
+#include <algorithm>
+
+#include "utilities/JobSystem.h"
+#include "utilities/Profiler.h"
+
+OcclusionCuller::OcclusionCuller(int bufferWidth, int bufferHeight)
+	: buffer(bufferWidth, bufferHeight)
+{
+}
+
+const std::vector<const Chunk*>& OcclusionCuller::cull(const std::vector<const Chunk*>& candidates, const glm::vec3& cameraPosition, const glm::mat4& viewProjection,
+	FrameArena& arena, JobSystem& jobs)
+{
+	PROFILE_SCOPE("Occlusion cull");
+
+	stats = Stats();
+	visibleChunks.clear();
+
+	// Near chunks cover the most screen, so they make the best occluders
+	ArenaVector<const Chunk*> occluderChunks(candidates.begin(), candidates.end(), ArenaAllocator<const Chunk*>(arena));
+	auto distanceTo = [&](const Chunk* chunk)
+	{
+		glm::vec3 center = (glm::vec3(chunk->Position) + 0.5f) * (float)Chunk::Size;
+		glm::vec3 offset = center - cameraPosition;
+		return glm::dot(offset, offset);
+	};
+
+	if (occluderChunks.size() > MaxOccluderChunks)
+	{
+		std::nth_element(occluderChunks.begin(), occluderChunks.begin() + MaxOccluderChunks, occluderChunks.end(),
+			[&](const Chunk* a, const Chunk* b) { return distanceTo(a) < distanceTo(b); });
+		occluderChunks.resize(MaxOccluderChunks);
+	}
+
+	ArenaAllocator<BoundingBox> allocator(arena);
+	ArenaVector<BoundingBox> occluders(allocator);
+	for (const Chunk* chunk : occluderChunks)
+	{
+		const std::vector<BoundingBox>& boxes = chunk->getOccluders();
+		occluders.insert(occluders.end(), boxes.begin(), boxes.end());
+		stats.OccluderChunks += !boxes.empty();
+	}
+	stats.OccluderBoxes = occluders.size();
+
+	buffer.rasterize(viewProjection, occluders, arena, jobs, std::min(RasterBands, jobs.getWorkerCount()));
+
+	// Never more than the candidates, so matching their storage means this only grows when theirs does
+	visibleChunks.reserve(candidates.capacity());
+
+	for (const Chunk* chunk : candidates)
+	{
+		stats.ChunksTested++;
+		if (buffer.isOccluded(chunk->getBounds()))
+		{
+			stats.ChunksOccluded++;
+		}
+		else
+		{
+			visibleChunks.push_back(chunk);
+		}
+	}
+
+	return visibleChunks;
+}
+
+const std::vector<const Chunk*>& OcclusionCuller::getVisibleChunks() const
+{
+	return visibleChunks;
+}
+
+const OcclusionBuffer& OcclusionCuller::getBuffer() const
+{
+	return buffer;
+}
+
+const OcclusionCuller::Stats& OcclusionCuller::getStats() const
+{
+	return stats;
+}
@@ -0,0 +1,57 @@
+// OcclusionCuller.h
+
+#ifndef OCCLUSION_CULLER_H
+#define OCCLUSION_CULLER_H
+
+#include <cstddef>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "rendering/OcclusionBuffer.h"
+#include "utilities/ArenaAllocator.h"
+#include "world/Chunk.h"
+
+// Software occlusion culling for chunks. The occluder boxes of the chunks
+// closest to the camera are rasterized into an OcclusionBuffer, then every
+// candidate chunk's bounds are tested against it.
+class OcclusionCuller
+{
+public:
+	struct Stats
+	{
+		size_t OccluderChunks = 0;
+		size_t OccluderBoxes = 0;
+		size_t ChunksTested = 0;
+		size_t ChunksOccluded = 0;
+
+		float getCullRate() const
+		{
+			return ChunksTested > 0 ? (float)ChunksOccluded / (float)ChunksTested : 0.0f;
+		}
+	};
+
+	// Only the nearest MaxOccluderChunks chunks contribute occluders
+	size_t MaxOccluderChunks = 64;
+	// Row bands the buffer is rasterized in, each one a job
+	int RasterBands = 4;
+
+	OcclusionCuller(int bufferWidth = 256, int bufferHeight = 128);
+
+	// Chunks must have had their occluders rebuilt beforehand. Picking the
+	// occluder chunks and rasterizing them uses scratch from arena, the
+	// rasterizing runs on jobs.
+	const std::vector<const Chunk*>& cull(const std::vector<const Chunk*>& candidates, const glm::vec3& cameraPosition, const glm::mat4& viewProjection,
+		FrameArena& arena, JobSystem& jobs);
+
+	const std::vector<const Chunk*>& getVisibleChunks() const;
+	const OcclusionBuffer& getBuffer() const;
+	const Stats& getStats() const;
+
+private:
+	OcclusionBuffer buffer;
+	std::vector<const Chunk*> visibleChunks;
+	Stats stats;
+};
+
+#endif
@@ -0,0 +1,223 @@
+// OcclusionQueries.cpp
+
+#include "OcclusionQueries.h"
+
+#include "rendering/CameraUniforms.h"
+
+namespace
+{
+	// Anything closer than this to an object could have its box clipped by the near plane
+	const float CAMERA_MARGIN = 0.5f;
+
+	// Boxes are grown a little so faces lying on them do not fail the depth test against themselves
+	const float BOX_MARGIN = 0.05f;
+
+	const float UNIT_CUBE_VERTICES[] = {
+		0.0f, 0.0f, 0.0f,
+		1.0f, 0.0f, 0.0f,
+		0.0f, 1.0f, 0.0f,
+		1.0f, 1.0f, 0.0f,
+		0.0f, 0.0f, 1.0f,
+		1.0f, 0.0f, 1.0f,
+		0.0f, 1.0f, 1.0f,
+		1.0f, 1.0f, 1.0f
+	};
+
+	const unsigned int UNIT_CUBE_INDICES[] = {
+		0, 4, 6,   0, 6, 2,
+		1, 3, 7,   1, 7, 5,
+		0, 1, 5,   0, 5, 4,
+		2, 6, 7,   2, 7, 3,
+		0, 2, 3,   0, 3, 1,
+		4, 5, 7,   4, 7, 6
+	};
+}
+
+OcclusionQueries::OcclusionQueries()
+	: boxShader("occlusion_box_vertex.glsl", "occlusion_box_fragment.glsl"),
+	cameraPosition(0.0f), frame(0), conditional(false)
+{
+	CameraUniforms::bindProgram(boxShader);
+	boxMinUniform = boxShader.getUniform("sBoxMin");
+	boxSizeUniform = boxShader.getUniform("sBoxSize");
+
+	glGenVertexArrays(1, &boxVAO);
+	glBindVertexArray(boxVAO);
+
+	glGenBuffers(1, &boxVBO);
+	glBindBuffer(GL_ARRAY_BUFFER, boxVBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(UNIT_CUBE_VERTICES), UNIT_CUBE_VERTICES, GL_STATIC_DRAW);
+
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 3, (void*)0);
+	glEnableVertexAttribArray(0);
+
+	glGenBuffers(1, &boxEBO);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, boxEBO);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(UNIT_CUBE_INDICES), UNIT_CUBE_INDICES, GL_STATIC_DRAW);
+
+	glBindVertexArray(0);
+}
+
+OcclusionQueries::~OcclusionQueries()
+{
+	for (auto& entry : queries)
+	{
+		freeQueries.push_back(entry.second.Query);
+	}
+	if (!freeQueries.empty())
+	{
+		glDeleteQueries((GLsizei)freeQueries.size(), freeQueries.data());
+	}
+
+	glDeleteBuffers(1, &boxEBO);
+	glDeleteBuffers(1, &boxVBO);
+	glDeleteVertexArrays(1, &boxVAO);
+	glDeleteProgram(boxShader.Id);
+}
+
+void OcclusionQueries::beginFrame(const glm::vec3& cameraPosition)
+{
+	this->cameraPosition = cameraPosition;
+	frame++;
+	pendingQueries.clear();
+	stats = Stats();
+}
+
+OcclusionQueries::ObjectQuery& OcclusionQueries::getQuery(uint32_t id)
+{
+	auto it = queries.find(id);
+	if (it != queries.end())
+	{
+		return it->second;
+	}
+
+	ObjectQuery& query = queries[id];
+	if (!freeQueries.empty())
+	{
+		query.Query = freeQueries.back();
+		freeQueries.pop_back();
+	}
+	else
+	{
+		glGenQueries(1, &query.Query);
+	}
+
+	// New objects are drawn and queried straight away
+	query.FramesSinceQuery = RequeryInterval;
+	return query;
+}
+
+bool OcclusionQueries::beginDraw(uint32_t id, const BoundingBox& bounds)
+{
+	ObjectQuery& query = getQuery(id);
+	if (query.LastFrame == frame)
+	{
+		stats.ObjectsDrawn++;
+		return true;
+	}
+	query.LastFrame = frame;
+	query.FramesSinceQuery++;
+
+	// A box around the camera would be clipped away and report nothing
+	if (glm::all(glm::greaterThanEqual(cameraPosition, bounds.Min - CAMERA_MARGIN)) &&
+		glm::all(glm::lessThanEqual(cameraPosition, bounds.Max + CAMERA_MARGIN)))
+	{
+		query.Visible = true;
+		stats.ObjectsDrawn++;
+		return true;
+	}
+
+	if (query.Issued)
+	{
+		GLuint available = 0;
+		glGetQueryObjectuiv(query.Query, GL_QUERY_RESULT_AVAILABLE, &available);
+
+		if (!available)
+		{
+			// Let the GPU decide, the query is still in flight so it is not reissued
+			stats.ObjectsConditional++;
+			glBeginConditionalRender(query.Query, GL_QUERY_NO_WAIT);
+			conditional = true;
+			return true;
+		}
+
+		GLuint samplesPassed = 0;
+		glGetQueryObjectuiv(query.Query, GL_QUERY_RESULT, &samplesPassed);
+		query.Issued = false;
+		query.Visible = samplesPassed != 0;
+	}
+
+	if (!query.Visible)
+	{
+		// Hidden objects are re-queried every frame so they pop back in quickly
+		stats.ObjectsSkipped++;
+		pendingQueries.push_back({ id, bounds });
+		return false;
+	}
+
+	stats.ObjectsDrawn++;
+	if (query.FramesSinceQuery >= RequeryInterval)
+	{
+		pendingQueries.push_back({ id, bounds });
+	}
+	return true;
+}
+
+void OcclusionQueries::endDraw()
+{
+	if (conditional)
+	{
+		glEndConditionalRender();
+		conditional = false;
+	}
+}
+
+void OcclusionQueries::issueQueries(RenderState& renderState)
+{
+	if (pendingQueries.empty())
+	{
+		return;
+	}
+
+	renderState.colorMask(false, false, false, false);
+	renderState.depthMask(false);
+
+	renderState.useProgram(boxShader.Id);
+	renderState.bindVertexArray(boxVAO);
+
+	for (const PendingQuery& pending : pendingQueries)
+	{
+		ObjectQuery& query = getQuery(pending.Id);
+		glm::vec3 boxMin = pending.Bounds.Min - BOX_MARGIN;
+		glm::vec3 size = pending.Bounds.Max + BOX_MARGIN - boxMin;
+
+		boxShader.setVec3f(boxMinUniform, boxMin.x, boxMin.y, boxMin.z);
+		boxShader.setVec3f(boxSizeUniform, size.x, size.y, size.z);
+
+		glBeginQuery(GL_ANY_SAMPLES_PASSED, query.Query);
+		glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
+		glEndQuery(GL_ANY_SAMPLES_PASSED);
+
+		query.Issued = true;
+		query.FramesSinceQuery = 0;
+		stats.QueriesIssued++;
+	}
+
+	renderState.depthMask(true);
+	renderState.colorMask(true, true, true, true);
+}
+
+void OcclusionQueries::forget(uint32_t id)
+{
+	auto it = queries.find(id);
+	if (it != queries.end())
+	{
+		freeQueries.push_back(it->second.Query);
+		queries.erase(it);
+	}
+}
+
+const OcclusionQueries::Stats& OcclusionQueries::getStats() const
+{
+	return stats;
+}
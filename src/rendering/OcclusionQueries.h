@@ -0,0 +1,99 @@
+// OcclusionQueries.h
+
+#ifndef OCCLUSION_QUERIES_H
+#define OCCLUSION_QUERIES_H
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "rendering/RenderState.h"
+#include "utilities/BoundingBox.h"
+#include "utilities/Shader.h"
+
+// Hardware occlusion queries for opaque meshes, e.g. chunks. Each frame
+// the meshes are drawn first, using last frame's query results, and then
+// the world space bounding boxes of the meshes that need a fresh answer
+// are drawn against the finished depth buffer with colour and depth
+// writes off.
+//
+// Results are never waited on: a result that is already available lets
+// the CPU skip the draw entirely, otherwise the draw is wrapped in
+// glBeginConditionalRender(GL_QUERY_NO_WAIT) and the GPU decides. Meshes
+// known to be visible are only re-queried every RequeryInterval frames.
+class OcclusionQueries
+{
+public:
+	struct Stats
+	{
+		int QueriesIssued = 0;
+		int ObjectsDrawn = 0;
+		int ObjectsConditional = 0;
+		int ObjectsSkipped = 0;
+	};
+
+	int RequeryInterval = 8;
+
+	OcclusionQueries();
+	~OcclusionQueries();
+
+	OcclusionQueries(const OcclusionQueries&) = delete;
+	OcclusionQueries& operator=(const OcclusionQueries&) = delete;
+
+	void beginFrame(const glm::vec3& cameraPosition);
+
+	// Returns false if last frame's query says the object is hidden. Otherwise
+	// draw it and call endDraw. An object drawn twice in one frame is only
+	// queried the first time, later draws are never skipped.
+	bool beginDraw(uint32_t id, const BoundingBox& bounds);
+	void endDraw();
+
+	// Issues box queries for the objects drawn this frame that are due for one.
+	// Call after all opaque geometry has been drawn.
+	void issueQueries(RenderState& renderState);
+
+	// Releases the query of a destroyed object
+	void forget(uint32_t id);
+
+	const Stats& getStats() const;
+
+private:
+	struct ObjectQuery
+	{
+		GLuint Query = 0;
+		bool Issued = false;
+		bool Visible = true;
+		int FramesSinceQuery = 0;
+		uint64_t LastFrame = 0;
+	};
+
+	struct PendingQuery
+	{
+		uint32_t Id;
+		BoundingBox Bounds;
+	};
+
+	Shader boxShader;
+	GLuint boxVAO;
+	GLuint boxVBO;
+	GLuint boxEBO;
+	UniformHandle boxMinUniform;
+	UniformHandle boxSizeUniform;
+
+	glm::vec3 cameraPosition;
+	uint64_t frame;
+	bool conditional;
+
+	std::unordered_map<uint32_t, ObjectQuery> queries;
+	std::vector<GLuint> freeQueries;
+	std::vector<PendingQuery> pendingQueries;
+	Stats stats;
+
+	ObjectQuery& getQuery(uint32_t id);
+};
+
+#endif
@@ -0,0 +1,85 @@
+// OffscreenTarget.cpp
+
+#include "OffscreenTarget.h"
+
+#include <cstring>
+#include <iostream>
+
+#include "utilities/MemoryTracker.h"
+
+OffscreenTarget::OffscreenTarget(int width, int height)
+	: framebuffer(0), colorBuffer(0), depthBuffer(0), width(width), height(height), complete(false)
+{
+	glGenRenderbuffers(1, &colorBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+	glGenRenderbuffers(1, &depthBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	// Drivers pad 24 bit depth to 32, so both buffers are four bytes a pixel
+	MemoryTracker::add(MEMORY_GPU_TEXTURES, (size_t)width * height * 8);
+
+	glGenFramebuffers(1, &framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+
+	complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+	if (!complete)
+	{
+		std::cout << "ERROR::OFFSCREEN_TARGET::FRAMEBUFFER_INCOMPLETE\n";
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+OffscreenTarget::~OffscreenTarget()
+{
+	glDeleteFramebuffers(1, &framebuffer);
+	glDeleteRenderbuffers(1, &depthBuffer);
+	glDeleteRenderbuffers(1, &colorBuffer);
+	MemoryTracker::remove(MEMORY_GPU_TEXTURES, (size_t)width * height * 8);
+}
+
+bool OffscreenTarget::isComplete() const
+{
+	return complete;
+}
+
+void OffscreenTarget::bind() const
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+}
+
+void OffscreenTarget::readPixels(std::vector<unsigned char>& pixels) const
+{
+	size_t rowBytes = (size_t)width * 4;
+	pixels.resize(rowBytes * height);
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+	// GL reads bottom-up, images are stored top-down
+	std::vector<unsigned char> row(rowBytes);
+	for (int y = 0; y < height / 2; y++)
+	{
+		unsigned char* top = &pixels[y * rowBytes];
+		unsigned char* bottom = &pixels[(height - 1 - y) * rowBytes];
+		std::memcpy(row.data(), top, rowBytes);
+		std::memcpy(top, bottom, rowBytes);
+		std::memcpy(bottom, row.data(), rowBytes);
+	}
+}
+
+int OffscreenTarget::getWidth() const
+{
+	return width;
+}
+
+int OffscreenTarget::getHeight() const
+{
+	return height;
+}
@@ -0,0 +1,39 @@
+// OffscreenTarget.h
+
+#ifndef OFFSCREEN_TARGET_H
+#define OFFSCREEN_TARGET_H
+
+#include <glad/glad.h>
+
+#include <vector>
+
+// Framebuffer object with an RGBA8 color and a 24-bit depth attachment,
+// used instead of the default framebuffer when there is no window
+class OffscreenTarget
+{
+public:
+	OffscreenTarget(int width, int height);
+	~OffscreenTarget();
+
+	OffscreenTarget(const OffscreenTarget&) = delete;
+	OffscreenTarget& operator=(const OffscreenTarget&) = delete;
+
+	bool isComplete() const;
+	void bind() const;
+
+	// Reads the color attachment as tightly packed RGBA rows, top row first
+	void readPixels(std::vector<unsigned char>& pixels) const;
+
+	int getWidth() const;
+	int getHeight() const;
+
+private:
+	GLuint framebuffer;
+	GLuint colorBuffer;
+	GLuint depthBuffer;
+	int width;
+	int height;
+	bool complete;
+};
+
+#endif
@@ -0,0 +1,148 @@
+// PassTimings.cpp
+
+#include "PassTimings.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <tuple>
+
+int PassTimings::getPass(const std::string& name)
+{
+	for (size_t i = 0; i < passes.size(); i++)
+	{
+		if (passes[i].Name == name)
+		{
+			return (int)i;
+		}
+	}
+
+	passes.emplace_back();
+	passes.back().Name = name;
+	return (int)passes.size() - 1;
+}
+
+int PassTimings::getPassCount() const
+{
+	return (int)passes.size();
+}
+
+const std::string& PassTimings::getName(int pass) const
+{
+	return passes[pass].Name;
+}
+
+void PassTimings::record(int pass, const Sample& sample)
+{
+	Pass& entry = passes[pass];
+	entry.Samples[entry.Next] = sample;
+	entry.Next = (entry.Next + 1) % HistoryLength;
+	entry.Count = std::min(entry.Count + 1, (int)HistoryLength);
+}
+
+int PassTimings::getSampleCount(int pass) const
+{
+	return passes[pass].Count;
+}
+
+const PassTimings::Sample& PassTimings::getSample(int pass, int index) const
+{
+	const Pass& entry = passes[pass];
+	int oldest = (entry.Next - entry.Count + HistoryLength) % HistoryLength;
+	return entry.Samples[(oldest + index) % HistoryLength];
+}
+
+const PassTimings::Sample& PassTimings::getLatest(int pass) const
+{
+	const Pass& entry = passes[pass];
+	return entry.Samples[(entry.Next + HistoryLength - 1) % HistoryLength];
+}
+
+float PassTimings::getAverageCpu(int pass) const
+{
+	int count = getSampleCount(pass);
+	if (count == 0)
+	{
+		return 0.0f;
+	}
+
+	float total = 0.0f;
+	for (int i = 0; i < count; i++)
+	{
+		total += getSample(pass, i).CpuMilliseconds;
+	}
+	return total / count;
+}
+
+float PassTimings::getAverageGpu(int pass) const
+{
+	float total = 0.0f;
+	int measured = 0;
+	for (int i = 0; i < getSampleCount(pass); i++)
+	{
+		const Sample& sample = getSample(pass, i);
+		if (sample.GpuMilliseconds >= 0.0f)
+		{
+			total += sample.GpuMilliseconds;
+			measured++;
+		}
+	}
+	return measured > 0 ? total / measured : -1.0f;
+}
+
+bool PassTimings::writeCsv(const std::string& path) const
+{
+	std::ofstream output(path, std::ios::trunc);
+	if (!output)
+	{
+		std::cout << "ERROR::PASS_TIMINGS::FILE_NOT_OPENED\n" << path << '\n';
+		return false;
+	}
+
+	// (frame, pass, index) so rows come out in frame order
+	std::vector<std::tuple<uint64_t, int, int>> rows;
+	for (int pass = 0; pass < getPassCount(); pass++)
+	{
+		for (int i = 0; i < getSampleCount(pass); i++)
+		{
+			rows.emplace_back(getSample(pass, i).Frame, pass, i);
+		}
+	}
+	std::sort(rows.begin(), rows.end());
+
+	output << "frame,pass,cpu_ms,gpu_ms\n";
+	for (const auto& row : rows)
+	{
+		const Sample& sample = getSample(std::get<1>(row), std::get<2>(row));
+		output << sample.Frame << ',' << getName(std::get<1>(row)) << ',' << sample.CpuMilliseconds << ',';
+		if (sample.GpuMilliseconds >= 0.0f)
+		{
+			output << sample.GpuMilliseconds;
+		}
+		output << '\n';
+	}
+	return (bool)output;
+}
+
+void PassTimings::printSummary(std::ostream& output) const
+{
+	for (int pass = 0; pass < getPassCount(); pass++)
+	{
+		if (getSampleCount(pass) == 0)
+		{
+			continue;
+		}
+
+		output << "Pass " << getName(pass) << ": cpu " << getAverageCpu(pass) << " ms, gpu ";
+		float gpu = getAverageGpu(pass);
+		if (gpu >= 0.0f)
+		{
+			output << gpu << " ms";
+		}
+		else
+		{
+			output << "n/a";
+		}
+		output << " (last " << getSampleCount(pass) << " frames)\n";
+	}
+}
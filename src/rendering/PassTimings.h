@@ -0,0 +1,62 @@
+// PassTimings.h
+
+#ifndef PASS_TIMINGS_H
+#define PASS_TIMINGS_H
+
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Rolling history of how long each render pass took on the CPU and the
+// GPU. GPU times are only known a few frames after the pass was submitted,
+// so a sample is recorded once both are in and carries the frame it
+// belongs to. Shows whether a pass, or the whole frame, is CPU or GPU bound.
+class PassTimings
+{
+public:
+	static const int HistoryLength = 240;
+
+	struct Sample
+	{
+		uint64_t Frame = 0;
+		float CpuMilliseconds = 0.0f;
+		// Negative when the GPU time is unknown, e.g. on the null backend
+		float GpuMilliseconds = -1.0f;
+	};
+
+	// Returns the id of the pass called name, registering it the first time
+	int getPass(const std::string& name);
+	int getPassCount() const;
+	const std::string& getName(int pass) const;
+
+	void record(int pass, const Sample& sample);
+
+	// At most HistoryLength samples, oldest first
+	int getSampleCount(int pass) const;
+	const Sample& getSample(int pass, int index) const;
+	const Sample& getLatest(int pass) const;
+
+	// Averages over the history, the GPU average skips samples without a GPU time
+	float getAverageCpu(int pass) const;
+	float getAverageGpu(int pass) const;
+
+	// One "frame,pass,cpu_ms,gpu_ms" row per sample, ordered by frame
+	bool writeCsv(const std::string& path) const;
+
+	void printSummary(std::ostream& output) const;
+
+private:
+	struct Pass
+	{
+		std::string Name;
+		std::array<Sample, HistoryLength> Samples;
+		int Count = 0;
+		int Next = 0;
+	};
+
+	std::vector<Pass> passes;
+};
+
+#endif
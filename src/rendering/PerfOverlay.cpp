@@ -0,0 +1,412 @@
+// PerfOverlay.cpp
+
+#include "PerfOverlay.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#include "rendering/FrameExchange.h"
+#include "utilities/HeapCounter.h"
+#include "utilities/MemoryTracker.h"
+#include "utilities/Profiler.h"
+
+namespace
+{
+	const int AtlasSize = 64;
+
+	// Glyphs sit in 4x6 cells, 16 to a row, starting at ' '
+	const int GlyphWidth = 3;
+	const int GlyphHeight = 5;
+	const int CellWidth = 4;
+	const int CellHeight = 6;
+	const int CellsPerRow = 16;
+	const char FirstGlyph = ' ';
+	const char LastGlyph = '~';
+
+	// Solid texels in the bottom right corner, for everything that is not text
+	const int WhiteBlock = 60;
+
+	const float Margin = 8.0f;
+	const float Padding = 6.0f;
+	const float LineHeight = (GlyphHeight + 2) * PerfOverlay::TextScale;
+	const float Advance = CellWidth * PerfOverlay::TextScale;
+
+	// Graph range, with a line at the 60 Hz frame budget
+	const float GraphMilliseconds = 33.3f;
+	const float BudgetMilliseconds = 16.7f;
+
+	// Rows of the glyph top to bottom, '#' is a lit pixel
+	struct Glyph
+	{
+		char Character;
+		const char* Rows;
+	};
+
+	const Glyph Glyphs[] = {
+		{ '0', "###" "#.#" "#.#" "#.#" "###" },
+		{ '1', ".#." "##." ".#." ".#." "###" },
+		{ '2', "###" "..#" "###" "#.." "###" },
+		{ '3', "###" "..#" "###" "..#" "###" },
+		{ '4', "#.#" "#.#" "###" "..#" "..#" },
+		{ '5', "###" "#.." "###" "..#" "###" },
+		{ '6', "###" "#.." "###" "#.#" "###" },
+		{ '7', "###" "..#" "..#" "..#" "..#" },
+		{ '8', "###" "#.#" "###" "#.#" "###" },
+		{ '9', "###" "#.#" "###" "..#" "###" },
+		{ 'A', "###" "#.#" "###" "#.#" "#.#" },
+		{ 'B', "##." "#.#" "##." "#.#" "##." },
+		{ 'C', "###" "#.." "#.." "#.." "###" },
+		{ 'D', "##." "#.#" "#.#" "#.#" "##." },
+		{ 'E', "###" "#.." "##." "#.." "###" },
+		{ 'F', "###" "#.." "##." "#.." "#.." },
+		{ 'G', "###" "#.." "#.#" "#.#" "###" },
+		{ 'H', "#.#" "#.#" "###" "#.#" "#.#" },
+		{ 'I', "###" ".#." ".#." ".#." "###" },
+		{ 'J', "..#" "..#" "..#" "#.#" "###" },
+		{ 'K', "#.#" "#.#" "##." "#.#" "#.#" },
+		{ 'L', "#.." "#.." "#.." "#.." "###" },
+		{ 'M', "#.#" "###" "###" "#.#" "#.#" },
+		{ 'N', "##." "#.#" "#.#" "#.#" "#.#" },
+		{ 'O', ".#." "#.#" "#.#" "#.#" ".#." },
+		{ 'P', "###" "#.#" "###" "#.." "#.." },
+		{ 'Q', "###" "#.#" "#.#" "###" "..#" },
+		{ 'R', "##." "#.#" "##." "#.#" "#.#" },
+		{ 'S', "###" "#.." "###" "..#" "###" },
+		{ 'T', "###" ".#." ".#." ".#." ".#." },
+		{ 'U', "#.#" "#.#" "#.#" "#.#" "###" },
+		{ 'V', "#.#" "#.#" "#.#" "#.#" ".#." },
+		{ 'W', "#.#" "#.#" "###" "###" "#.#" },
+		{ 'X', "#.#" "#.#" ".#." "#.#" "#.#" },
+		{ 'Y', "#.#" "#.#" ".#." ".#." ".#." },
+		{ 'Z', "###" "..#" ".#." "#.." "###" },
+		{ '.', "..." "..." "..." "..." ".#." },
+		{ ',', "..." "..." "..." ".#." "#.." },
+		{ ':', "..." ".#." "..." ".#." "..." },
+		{ '%', "#.#" "..#" ".#." "#.." "#.#" },
+		{ '/', "..#" "..#" ".#." "#.." "#.." },
+		{ '-', "..." "..." "###" "..." "..." },
+		{ '+', "..." ".#." "###" ".#." "..." },
+		{ '=', "..." "###" "..." "###" "..." },
+		{ '(', ".#." "#.." "#.." "#.." ".#." },
+		{ ')', ".#." "..#" "..#" "..#" ".#." },
+		{ '<', "..#" ".#." "#.." ".#." "..#" },
+		{ '>', "#.." ".#." "..#" ".#." "#.." },
+		{ '!', ".#." ".#." ".#." "..." ".#." },
+		{ '?', "###" "..#" ".#." "..." ".#." },
+		{ '_', "..." "..." "..." "..." "###" },
+	};
+
+	uint32_t rgba(int red, int green, int blue, int alpha)
+	{
+		return (uint32_t)red | ((uint32_t)green << 8) | ((uint32_t)blue << 16) | ((uint32_t)alpha << 24);
+	}
+
+	const uint32_t PanelColor = rgba(0, 0, 0, 170);
+	const uint32_t GraphBackColor = rgba(255, 255, 255, 24);
+	const uint32_t BudgetColor = rgba(255, 255, 255, 96);
+	const uint32_t TextColor = rgba(255, 255, 255, 255);
+	const uint32_t LabelColor = rgba(160, 200, 255, 255);
+	const uint32_t FrameColor = rgba(96, 220, 96, 255);
+	const uint32_t GpuColor = rgba(240, 170, 60, 255);
+	const uint32_t SlowColor = rgba(240, 64, 64, 255);
+
+	float texel(int pixel)
+	{
+		return (float)pixel / AtlasSize;
+	}
+}
+
+PerfOverlay::PerfOverlay()
+	: nextFrame(0), frameCount(0), hasLastFrame(false), lastAllocationCount(0), frameAllocations(0), panelRight(0.0f)
+{
+	frameMilliseconds.fill(0.0f);
+
+	atlas.Width = AtlasSize;
+	atlas.Height = AtlasSize;
+	atlas.Layers = 1;
+	atlas.MipCount = 1;
+	atlas.Pixels.assign((size_t)AtlasSize * AtlasSize * 4, 0);
+	atlas.LevelOffsets.push_back(0);
+
+	auto setPixel = [&](int x, int y)
+	{
+		unsigned char* pixel = &atlas.Pixels[((size_t)y * AtlasSize + x) * 4];
+		pixel[0] = pixel[1] = pixel[2] = pixel[3] = 255;
+	};
+
+	for (const Glyph& glyph : Glyphs)
+	{
+		int index = glyph.Character - FirstGlyph;
+		int cellX = (index % CellsPerRow) * CellWidth;
+		int cellY = (index / CellsPerRow) * CellHeight;
+		for (int y = 0; y < GlyphHeight; y++)
+		{
+			for (int x = 0; x < GlyphWidth; x++)
+			{
+				if (glyph.Rows[y * GlyphWidth + x] == '#')
+				{
+					setPixel(cellX + x, cellY + y);
+				}
+			}
+		}
+	}
+
+	for (int y = WhiteBlock; y < AtlasSize; y++)
+	{
+		for (int x = WhiteBlock; x < AtlasSize; x++)
+		{
+			setPixel(x, y);
+		}
+	}
+}
+
+const TextureArrayData& PerfOverlay::getAtlas() const
+{
+	return atlas;
+}
+
+void PerfOverlay::recordFrame()
+{
+	Clock::time_point now = Clock::now();
+	if (hasLastFrame)
+	{
+		frameMilliseconds[nextFrame] = std::chrono::duration<float, std::milli>(now - lastFrame).count();
+		nextFrame = (nextFrame + 1) % FrameHistory;
+		frameCount = std::min(frameCount + 1, (int)FrameHistory);
+	}
+	lastFrame = now;
+	hasLastFrame = true;
+
+	uint64_t allocationCount = getHeapAllocationCount();
+	frameAllocations = allocationCount - lastAllocationCount;
+	lastAllocationCount = allocationCount;
+}
+
+void PerfOverlay::build(const FrameSnapshot& frame, const RenderBackend::Stats& stats, const PassTimings& timings)
+{
+	PROFILE_SCOPE("Build overlay");
+
+	vertices.clear();
+
+	// Placeholder for the background, sized once everything else is laid out
+	addRect(0.0f, 0.0f, 0.0f, 0.0f, PanelColor);
+	float left = Margin + Padding;
+	float y = Margin + Padding;
+	panelRight = left + GraphWidth;
+
+	// Render thread CPU and GPU time of the whole frame, from the backend's pass timings
+	int framePass = -1;
+	for (int pass = 0; pass < timings.getPassCount(); pass++)
+	{
+		if (timings.getName(pass) == "Frame")
+		{
+			framePass = pass;
+		}
+	}
+	float renderMilliseconds = 0.0f;
+	float gpuMilliseconds = -1.0f;
+	if (framePass != -1 && timings.getSampleCount(framePass) > 0)
+	{
+		const PassTimings::Sample& latest = timings.getLatest(framePass);
+		renderMilliseconds = latest.CpuMilliseconds;
+		gpuMilliseconds = latest.GpuMilliseconds;
+	}
+
+	float frameTime = frameCount > 0 ? getFrame(0) : 0.0f;
+	float low1 = getLowMilliseconds(0.01f);
+	float low01 = getLowMilliseconds(0.001f);
+	auto toFps = [](float milliseconds)
+	{
+		return milliseconds > 0.0f ? 1000.0f / milliseconds : 0.0f;
+	};
+
+	char line[96];
+	std::snprintf(line, sizeof(line), "FPS %.1f (%.2f MS)", toFps(frameTime), frameTime);
+	addText(left, y, line, TextColor);
+	y += LineHeight;
+
+	std::snprintf(line, sizeof(line), "1%% LOW %.1f  0.1%% LOW %.1f", toFps(low1), toFps(low01));
+	addText(left, y, line, TextColor);
+	y += LineHeight;
+
+	std::snprintf(line, sizeof(line), "MAIN %.2f  RENDER %.2f MS", frame.MainMilliseconds, renderMilliseconds);
+	addText(left, y, line, TextColor);
+	y += LineHeight;
+
+	if (gpuMilliseconds >= 0.0f)
+	{
+		std::snprintf(line, sizeof(line), "GPU %.2f MS", gpuMilliseconds);
+	}
+	else
+	{
+		std::snprintf(line, sizeof(line), "GPU N/A");
+	}
+	addText(left, y, line, TextColor);
+	y += LineHeight;
+
+	std::snprintf(line, sizeof(line), "DRAWS %d  TRIS %llu", stats.DrawCalls, (unsigned long long)stats.Triangles);
+	addText(left, y, line, TextColor);
+	y += LineHeight;
+
+	std::snprintf(line, sizeof(line), "UPLOAD %.1f KB", stats.BytesUploaded / 1024.0);
+	addText(left, y, line, TextColor);
+	y += LineHeight;
+
+	const PerfCounters& counters = frame.Counters;
+	std::snprintf(line, sizeof(line), "CHUNKS %d LOADED %d MESHED %d VISIBLE", counters.ChunksLoaded, counters.ChunksMeshed,
+		counters.ChunksVisible);
+	addText(left, y, line, TextColor);
+	y += LineHeight;
+
+	std::snprintf(line, sizeof(line), "JOBS QUEUED %d", counters.JobsQueued);
+	addText(left, y, line, TextColor);
+	y += LineHeight;
+
+	std::snprintf(line, sizeof(line), "HEAP ALLOCS/FRAME %llu", (unsigned long long)frameAllocations);
+	addText(left, y, line, TextColor);
+	y += LineHeight + Padding;
+
+	addText(left, y, "MEMORY MB LIVE / PEAK", LabelColor);
+	y += LineHeight;
+	for (int tag = 0; tag < MEMORY_TAG_COUNT; tag++)
+	{
+		MemoryTracker::TagStats memory = MemoryTracker::getStats((MemoryTag)tag);
+		std::snprintf(line, sizeof(line), "%-13s %.1f / %.1f", MemoryTracker::getTagName((MemoryTag)tag),
+			memory.LiveBytes / (1024.0 * 1024.0), memory.PeakBytes / (1024.0 * 1024.0));
+		addText(left, y, line, TextColor);
+		y += LineHeight;
+	}
+	y += Padding;
+
+	// Newest sample on the right, missing ones are left blank
+	std::array<float, GraphWidth> samples;
+	samples.fill(-1.0f);
+
+	int frameSamples = std::min(frameCount, (int)GraphWidth);
+	for (int i = 0; i < frameSamples; i++)
+	{
+		samples[GraphWidth - 1 - i] = getFrame(i);
+	}
+	addText(left, y, "FRAME MS", LabelColor);
+	y += LineHeight;
+	addGraph(left, y, samples.data(), GraphWidth, FrameColor);
+	y += GraphHeight + Padding;
+
+	samples.fill(-1.0f);
+	int gpuCount = framePass != -1 ? timings.getSampleCount(framePass) : 0;
+	int gpuSamples = std::min(gpuCount, (int)GraphWidth);
+	for (int i = 0; i < gpuSamples; i++)
+	{
+		samples[GraphWidth - gpuSamples + i] = timings.getSample(framePass, gpuCount - gpuSamples + i).GpuMilliseconds;
+	}
+	addText(left, y, "GPU MS", LabelColor);
+	y += LineHeight;
+	addGraph(left, y, samples.data(), GraphWidth, GpuColor);
+	y += GraphHeight + Padding;
+
+	// Now the panel size is known
+	float panelLeft = Margin;
+	float panelTop = Margin;
+	float right = panelRight + Padding;
+	const float positions[6][2] = {
+		{ panelLeft, panelTop }, { right, panelTop }, { right, y },
+		{ panelLeft, panelTop }, { right, y }, { panelLeft, y },
+	};
+	for (int i = 0; i < 6; i++)
+	{
+		vertices[i].X = positions[i][0];
+		vertices[i].Y = positions[i][1];
+	}
+}
+
+const std::vector<OverlayVertex>& PerfOverlay::getVertices() const
+{
+	return vertices;
+}
+
+float PerfOverlay::getLowMilliseconds(float fraction) const
+{
+	if (frameCount == 0)
+	{
+		return 0.0f;
+	}
+
+	// Nearest rank from the slow end, so the 1% low of 100 frames is the slowest one
+	sortScratch.assign(frameMilliseconds.begin(), frameMilliseconds.begin() + frameCount);
+	size_t rank = (size_t)std::ceil(fraction * frameCount);
+	size_t index = sortScratch.size() - std::max<size_t>(rank, 1);
+	std::nth_element(sortScratch.begin(), sortScratch.begin() + index, sortScratch.end());
+	return sortScratch[index];
+}
+
+float PerfOverlay::getFrame(int age) const
+{
+	return frameMilliseconds[(nextFrame - 1 - age + FrameHistory) % FrameHistory];
+}
+
+void PerfOverlay::addQuad(float x0, float y0, float x1, float y1, float u0, float v0, float u1, float v1, uint32_t color)
+{
+	OverlayVertex corners[4];
+	corners[0] = { x0, y0, u0, v0, color };
+	corners[1] = { x1, y0, u1, v0, color };
+	corners[2] = { x1, y1, u1, v1, color };
+	corners[3] = { x0, y1, u0, v1, color };
+
+	vertices.push_back(corners[0]);
+	vertices.push_back(corners[1]);
+	vertices.push_back(corners[2]);
+	vertices.push_back(corners[0]);
+	vertices.push_back(corners[2]);
+	vertices.push_back(corners[3]);
+}
+
+void PerfOverlay::addRect(float x0, float y0, float x1, float y1, uint32_t color)
+{
+	float white = texel(WhiteBlock + 2);
+	addQuad(x0, y0, x1, y1, white, white, white, white, color);
+}
+
+void PerfOverlay::addText(float x, float y, const char* text, uint32_t color)
+{
+	for (; *text; text++, x += Advance)
+	{
+		char character = *text;
+		if (character >= 'a' && character <= 'z')
+		{
+			character = (char)(character - 'a' + 'A');
+		}
+		if (character <= FirstGlyph || character > LastGlyph)
+		{
+			continue;
+		}
+
+		int index = character - FirstGlyph;
+		int cellX = (index % CellsPerRow) * CellWidth;
+		int cellY = (index / CellsPerRow) * CellHeight;
+		addQuad(x, y, x + GlyphWidth * TextScale, y + GlyphHeight * TextScale,
+			texel(cellX), texel(cellY), texel(cellX + GlyphWidth), texel(cellY + GlyphHeight), color);
+	}
+	panelRight = std::max(panelRight, x - (Advance - GlyphWidth * TextScale));
+}
+
+void PerfOverlay::addGraph(float x, float y, const float* samples, int count, uint32_t color)
+{
+	addRect(x, y, x + count, y + GraphHeight, GraphBackColor);
+
+	float bottom = y + GraphHeight;
+	for (int i = 0; i < count; i++)
+	{
+		if (samples[i] < 0.0f)
+		{
+			continue;
+		}
+
+		// Frames past the top of the graph are clipped and drawn red
+		float height = std::min(samples[i] / GraphMilliseconds, 1.0f) * GraphHeight;
+		addRect(x + i, bottom - std::max(height, 1.0f), x + i + 1, bottom, samples[i] > GraphMilliseconds ? SlowColor : color);
+	}
+
+	float budget = bottom - BudgetMilliseconds / GraphMilliseconds * GraphHeight;
+	addRect(x, budget, x + count, budget + 1.0f, BudgetColor);
+}
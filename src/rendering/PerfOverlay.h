@@ -0,0 +1,78 @@
+// PerfOverlay.h
+
+#ifndef PERF_OVERLAY_H
+#define PERF_OVERLAY_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "rendering/BlockTextures.h"
+#include "rendering/PassTimings.h"
+#include "rendering/RenderBackend.h"
+#include "rendering/RenderTypes.h"
+
+struct FrameSnapshot;
+
+// Debug overlay with frame time and GPU time graphs, 1% and 0.1% lows, the
+// engine counters and tracked memory per tag. Text comes from a built-in
+// 3x5 pixel font, so the whole overlay is one vertex list drawn with a
+// single call from the one-layer atlas returned by getAtlas().
+class PerfOverlay
+{
+public:
+	// Frames kept for the lows
+	static const int FrameHistory = 1000;
+	// One pixel wide bar per frame
+	static const int GraphWidth = PassTimings::HistoryLength;
+	static const int GraphHeight = 48;
+	// Screen pixels per font pixel
+	static const int TextScale = 2;
+
+	PerfOverlay();
+
+	// Font glyphs plus a white block for untextured quads
+	const TextureArrayData& getAtlas() const;
+
+	// Call once for every rendered frame, shown or not, so the history is
+	// complete when the overlay is turned on
+	void recordFrame();
+
+	// Rebuilds the vertices from the last recorded frames. stats are the
+	// backend counts of the previous frame, the current one is not done yet.
+	void build(const FrameSnapshot& frame, const RenderBackend::Stats& stats, const PassTimings& timings);
+	const std::vector<OverlayVertex>& getVertices() const;
+
+	// Frame time in milliseconds that the slowest fraction of recorded frames exceed, e.g. 0.01 for the 1% low
+	float getLowMilliseconds(float fraction) const;
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	TextureArrayData atlas;
+	std::vector<OverlayVertex> vertices;
+
+	// Time between consecutive recordFrame calls, a ring of FrameHistory
+	std::array<float, FrameHistory> frameMilliseconds;
+	int nextFrame;
+	int frameCount;
+	Clock::time_point lastFrame;
+	bool hasLastFrame;
+	// Heap allocations by the whole process between the last two recordFrame calls
+	uint64_t lastAllocationCount;
+	uint64_t frameAllocations;
+
+	mutable std::vector<float> sortScratch;
+	float panelRight;
+
+	float getFrame(int age) const;
+
+	void addQuad(float x0, float y0, float x1, float y1, float u0, float v0, float u1, float v1, uint32_t color);
+	void addRect(float x0, float y0, float x1, float y1, uint32_t color);
+	void addText(float x, float y, const char* text, uint32_t color);
+	void addGraph(float x, float y, const float* samples, int count, uint32_t color);
+};
+
+#endif
@@ -0,0 +1,53 @@
+// RenderBackend.cpp
+
+#include "RenderBackend.h"
+
+RenderBackend::Stats& RenderBackend::Stats::operator+=(const Stats& other)
+{
+	DrawCalls += other.DrawCalls;
+	Instances += other.Instances;
+	Triangles += other.Triangles;
+	StateChanges += other.StateChanges;
+	BytesUploaded += other.BytesUploaded;
+	ResourcesCreated += other.ResourcesCreated;
+	ResourcesDestroyed += other.ResourcesDestroyed;
+	return *this;
+}
+
+RenderBackend::~RenderBackend()
+{
+}
+
+MeshHandle RenderBackend::reserveMesh()
+{
+	return nextMesh++;
+}
+
+MeshHandle RenderBackend::createMesh(const MeshData& data)
+{
+	MeshHandle mesh = reserveMesh();
+	updateMesh(mesh, data);
+	return mesh;
+}
+
+const RenderBackend::Stats& RenderBackend::getFrameStats() const
+{
+	return lastFrameStats;
+}
+
+const RenderBackend::Stats& RenderBackend::getTotalStats() const
+{
+	return totalStats;
+}
+
+const PassTimings& RenderBackend::getPassTimings() const
+{
+	return passTimings;
+}
+
+void RenderBackend::finishFrameStats()
+{
+	totalStats += frameStats;
+	lastFrameStats = frameStats;
+	frameStats = Stats();
+}
@@ -0,0 +1,102 @@
+// RenderBackend.h
+
+#ifndef RENDER_BACKEND_H
+#define RENDER_BACKEND_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "rendering/PassTimings.h"
+#include "rendering/RenderQueue.h"
+#include "rendering/RenderTypes.h"
+
+struct FrameSnapshot;
+struct TextureArrayView;
+
+// Everything the engine asks of the GPU. GLBackend does the real work,
+// NullBackend only counts, so the rest of the engine can run and be
+// profiled without a GL context. Apart from reserveMesh, every call must
+// come from the thread that renders.
+class RenderBackend
+{
+public:
+	struct Stats
+	{
+		int DrawCalls = 0;
+		int Instances = 0;
+		uint64_t Triangles = 0;
+		// Program, mesh or texture switches between consecutive draws
+		int StateChanges = 0;
+		uint64_t BytesUploaded = 0;
+		int ResourcesCreated = 0;
+		int ResourcesDestroyed = 0;
+
+		Stats& operator+=(const Stats& other);
+	};
+
+	virtual ~RenderBackend();
+
+	virtual const char* getName() const = 0;
+
+	// Safe from any thread, so the simulation can name a mesh before its
+	// data arrives through FrameSnapshot::MeshUploads
+	MeshHandle reserveMesh();
+	MeshHandle createMesh(const MeshData& data);
+	virtual void updateMesh(MeshHandle mesh, const MeshData& data) = 0;
+	virtual void destroyMesh(MeshHandle mesh) = 0;
+
+	virtual TextureHandle createTextureArray(const TextureArrayView& view) = 0;
+	virtual void destroyTexture(TextureHandle texture) = 0;
+
+	// Registers a program once with every #define feature its variants may enable
+	virtual void registerProgram(const std::string& name, const char* vertexSourcePath, const char* fragmentSourcePath,
+		const std::vector<std::string>& features) = 0;
+
+	// Starts building the variant of a registered program with exactly these
+	// features enabled, it is finished the first time it is drawn with
+	virtual ProgramHandle createProgram(const std::string& name, const std::vector<std::string>& defines) = 0;
+
+	// Applies the snapshot's uploads and deletions, the viewport and the camera, and clears
+	virtual void beginFrame(const FrameSnapshot& frame) = 0;
+
+	// Packets must already be sorted by key
+	virtual void drawPackets(const std::vector<DrawPacket>& packets) = 0;
+	virtual void drawInstances(MeshHandle mesh, ProgramHandle program, TextureHandle texture, const std::vector<MeshInstance>& instances) = 0;
+
+	// Draws screen space triangles on top of everything with alpha blending,
+	// in one call. Debug only, so it is left out of the frame stats.
+	virtual void drawOverlay(ProgramHandle program, TextureHandle texture, const std::vector<OverlayVertex>& vertices) = 0;
+
+	virtual void endFrame() = 0;
+
+	// Blocks until submitted work has finished, so benchmark timings cover the whole frame
+	virtual void finish() = 0;
+
+	// Reads back the last frame as RGBA rows, top row first. Returns false if the backend has no pixels.
+	virtual bool capture(std::vector<unsigned char>& pixels, int& width, int& height) = 0;
+
+	// Counts for the last finished frame and since startup. Work done
+	// between frames is counted towards the next one.
+	const Stats& getFrameStats() const;
+	const Stats& getTotalStats() const;
+
+	// Per-pass CPU time and, where the backend can measure it, GPU time.
+	// Render thread only.
+	const PassTimings& getPassTimings() const;
+
+protected:
+	Stats frameStats;
+	PassTimings passTimings;
+
+	// Called at the end of endFrame
+	void finishFrameStats();
+
+private:
+	Stats lastFrameStats;
+	Stats totalStats;
+	std::atomic<MeshHandle> nextMesh{ 1 };
+};
+
+#endif
@@ -0,0 +1,195 @@
+// RenderQueue.cpp
+
+#include "RenderQueue.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include "utilities/JobSystem.h"
+#include "utilities/Profiler.h"
+
+void RenderQueue::Recorder::submit(const DrawPacket& packet)
+{
+	packets.push_back(packet);
+}
+
+FrameArena& RenderQueue::Recorder::getArena()
+{
+	return *packets.get_allocator().getArena();
+}
+
+uint64_t RenderQueue::makeKey(int pass, uint32_t program, uint32_t texture, float depth, bool backToFront)
+{
+	// Non-negative floats compare the same as their bit patterns
+	uint32_t depthBits = 0;
+	float clampedDepth = std::max(depth, 0.0f);
+	std::memcpy(&depthBits, &clampedDepth, sizeof(depthBits));
+	if (backToFront)
+	{
+		depthBits = ~depthBits;
+	}
+
+	return ((uint64_t)(pass & 0xF) << 60)
+		| ((uint64_t)(program & 0xFFF) << 48)
+		| ((uint64_t)(texture & 0xFFFF) << 32)
+		| (uint64_t)depthBits;
+}
+
+int RenderQueue::getPass(uint64_t key)
+{
+	return (int)(key >> 60);
+}
+
+const char* RenderQueue::getPassName(int pass)
+{
+	switch (pass)
+	{
+	case PASS_OPAQUE:
+		return "Opaque";
+	case PASS_CUTOUT:
+		return "Cutout";
+	case PASS_TRANSPARENT:
+		return "Transparent";
+	case PASS_OVERLAY:
+		return "Overlay";
+	default:
+		return "Unknown";
+	}
+}
+
+RenderQueue::RenderQueue(int maxThreads)
+	: recorders(std::max(1, maxThreads))
+{
+}
+
+void RenderQueue::beginFrame(FrameArenas& arenas)
+{
+	for (size_t thread = 0; thread < recorders.size(); thread++)
+	{
+		recorders[thread].packets = ArenaVector<DrawPacket>(ArenaAllocator<DrawPacket>(arenas.get((int)thread)));
+	}
+	sortArena = &arenas.get(0);
+	sorted.clear();
+	stats = Stats();
+}
+
+RenderQueue::Recorder& RenderQueue::getRecorder(int thread)
+{
+	return recorders[thread];
+}
+
+int RenderQueue::getMaxThreads() const
+{
+	return (int)recorders.size();
+}
+
+void RenderQueue::recordItems(int itemCount, JobSystem& jobs, RecordFunction function, const void* context)
+{
+	jobs.parallelFor(itemCount, [&](int begin, int end, int batch)
+	{
+		PROFILE_SCOPE("Record packets");
+		Recorder& recorder = recorders[batch];
+		for (int item = begin; item < end; item++)
+		{
+			function(context, recorder, item);
+		}
+	}, getMaxThreads());
+}
+
+void RenderQueue::sort()
+{
+	PROFILE_SCOPE("Sort packets");
+
+	auto sortStart = std::chrono::steady_clock::now();
+
+	size_t packetCount = 0;
+	for (const Recorder& recorder : recorders)
+	{
+		packetCount += recorder.packets.size();
+	}
+
+	// Recorders are merged in index order, so equal keys keep submission order
+	ArenaAllocator<DrawPacket> allocator(*sortArena);
+	ArenaVector<DrawPacket> merged(allocator);
+	merged.reserve(packetCount);
+	for (const Recorder& recorder : recorders)
+	{
+		merged.insert(merged.end(), recorder.packets.begin(), recorder.packets.end());
+	}
+
+	ArenaVector<SortEntry> entries(packetCount, SortEntry(), allocator);
+	ArenaVector<SortEntry> scratch(allocator);
+	for (size_t i = 0; i < packetCount; i++)
+	{
+		entries[i] = { merged[i].Key, (uint32_t)i };
+	}
+	radixSort(entries, scratch);
+
+	// Reorder the packets themselves so replay walks memory linearly. Appending
+	// grows the storage geometrically, resizing after clear() would fit it
+	// exactly and reallocate on every new high.
+	sorted.clear();
+	for (size_t i = 0; i < packetCount; i++)
+	{
+		sorted.push_back(merged[entries[i].Index]);
+	}
+
+	stats.PacketsSubmitted = (int)sorted.size();
+	std::chrono::duration<double, std::milli> sortTime = std::chrono::steady_clock::now() - sortStart;
+	stats.SortMilliseconds = sortTime.count();
+}
+
+void RenderQueue::radixSort(ArenaVector<SortEntry>& entries, ArenaVector<SortEntry>& scratch)
+{
+	const int RadixBits = 8;
+	const int Buckets = 1 << RadixBits;
+	const int Passes = 64 / RadixBits;
+
+	// One read of the keys builds the histogram for every pass
+	uint32_t histograms[Passes * Buckets] = {};
+	for (const SortEntry& entry : entries)
+	{
+		for (int pass = 0; pass < Passes; pass++)
+		{
+			histograms[pass * Buckets + ((entry.Key >> (pass * RadixBits)) & (Buckets - 1))]++;
+		}
+	}
+
+	scratch.resize(entries.size());
+	for (int pass = 0; pass < Passes; pass++)
+	{
+		uint32_t* histogram = &histograms[pass * Buckets];
+
+		// A byte shared by every key cannot change the order
+		uint32_t firstByte = entries.empty() ? 0 : (uint32_t)((entries[0].Key >> (pass * RadixBits)) & (Buckets - 1));
+		if (histogram[firstByte] == entries.size())
+		{
+			continue;
+		}
+
+		uint32_t offset = 0;
+		for (int bucket = 0; bucket < Buckets; bucket++)
+		{
+			uint32_t count = histogram[bucket];
+			histogram[bucket] = offset;
+			offset += count;
+		}
+
+		for (const SortEntry& entry : entries)
+		{
+			scratch[histogram[(entry.Key >> (pass * RadixBits)) & (Buckets - 1)]++] = entry;
+		}
+		entries.swap(scratch);
+	}
+}
+
+const std::vector<DrawPacket>& RenderQueue::getSorted() const
+{
+	return sorted;
+}
+
+const RenderQueue::Stats& RenderQueue::getStats() const
+{
+	return stats;
+}
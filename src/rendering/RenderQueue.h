@@ -0,0 +1,121 @@
+// RenderQueue.h
+
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+#include "rendering/RenderTypes.h"
+#include "utilities/ArenaAllocator.h"
+
+class JobSystem;
+
+// One draw call, fully described so it can be replayed in any order.
+// Key decides the order, see RenderQueue::makeKey.
+struct DrawPacket
+{
+	uint64_t Key = 0;
+	ProgramHandle Program = 0;
+	MeshHandle Mesh = 0;
+	TextureHandle Texture = 0;
+	float TextureLayer = 0.0f;
+	glm::mat4 Model = glm::mat4(1.0f);
+};
+
+// Collects draw packets from any number of jobs and radix sorts them by
+// key, ready for RenderBackend::drawPackets. Each recording job owns its
+// own packet list so submitting never takes a lock. Packet lists and sort
+// buffers live in the frame arenas, only the sorted output is kept.
+class RenderQueue
+{
+public:
+	enum Pass
+	{
+		PASS_OPAQUE = 0,
+		PASS_CUTOUT = 1,
+		PASS_TRANSPARENT = 2,
+		PASS_OVERLAY = 3
+	};
+
+	struct Stats
+	{
+		int PacketsSubmitted = 0;
+		double SortMilliseconds = 0.0;
+	};
+
+	class Recorder
+	{
+	public:
+		void submit(const DrawPacket& packet);
+
+		// This thread's frame arena, for scratch the recording task needs
+		FrameArena& getArena();
+
+	private:
+		friend class RenderQueue;
+		ArenaVector<DrawPacket> packets;
+	};
+
+	// Packs the sort key, most significant first:
+	// pass (4 bits), program (12 bits), texture (16 bits), depth (32 bits).
+	// Depth sorts front to back unless backToFront is set.
+	static uint64_t makeKey(int pass, uint32_t program, uint32_t texture, float depth, bool backToFront = false);
+	static int getPass(uint64_t key);
+	static const char* getPassName(int pass);
+
+	explicit RenderQueue(int maxThreads);
+
+	// Drops last frame's packets. Recorder i takes its memory from arena i,
+	// so arenas needs at least getMaxThreads() threads and must not be reset
+	// before sort() has run.
+	void beginFrame(FrameArenas& arenas);
+
+	// Recorders may be used from different threads at the same time, one thread per index
+	Recorder& getRecorder(int thread);
+	int getMaxThreads() const;
+
+	// Splits [0, itemCount) into up to getMaxThreads() contiguous ranges and
+	// records each range as a job, calling task(Recorder&, int item). Range i
+	// always goes to recorder i, so the merged order does not depend on
+	// which worker ran what.
+	template <typename Task>
+	void record(int itemCount, JobSystem& jobs, const Task& task)
+	{
+		// Called through a plain function pointer, wrapping most captures in a std::function allocates
+		recordItems(itemCount, jobs, [](const void* context, Recorder& recorder, int item)
+		{
+			(*static_cast<const Task*>(context))(recorder, item);
+		}, &task);
+	}
+
+	// Merges every recorder and sorts by key, call once recording has finished
+	void sort();
+
+	const std::vector<DrawPacket>& getSorted() const;
+	const Stats& getStats() const;
+
+	// Stable LSD radix sort on the keys, skipping bytes every key shares
+	struct SortEntry
+	{
+		uint64_t Key;
+		uint32_t Index;
+	};
+	static void radixSort(ArenaVector<SortEntry>& entries, ArenaVector<SortEntry>& scratch);
+
+private:
+	typedef void (*RecordFunction)(const void* context, Recorder& recorder, int item);
+
+	std::vector<Recorder> recorders;
+	FrameArena* sortArena = nullptr;
+	// Keeps its storage between frames, the backend reads it after the arenas move on
+	std::vector<DrawPacket> sorted;
+
+	Stats stats;
+
+	void recordItems(int itemCount, JobSystem& jobs, RecordFunction function, const void* context);
+};
+
+#endif
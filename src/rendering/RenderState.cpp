@@ -0,0 +1,124 @@
+// RenderState.cpp
+
+#include "RenderState.h"
+
+void RenderState::beginFrame()
+{
+	tracker.resetStats();
+}
+
+void RenderState::invalidate()
+{
+	tracker.invalidate();
+}
+
+const RenderStateTracker::Stats& RenderState::getStats() const
+{
+	return tracker.getStats();
+}
+
+void RenderState::useProgram(GLuint program)
+{
+	if (tracker.useProgram(program))
+	{
+		glUseProgram(program);
+	}
+}
+
+void RenderState::bindVertexArray(GLuint vertexArray)
+{
+	if (tracker.bindVertexArray(vertexArray))
+	{
+		glBindVertexArray(vertexArray);
+	}
+}
+
+void RenderState::bindTexture(int unit, GLenum target, GLuint texture)
+{
+	if (tracker.bindTexture(unit, target, texture))
+	{
+		if (tracker.activeTexture(unit))
+		{
+			glActiveTexture(GL_TEXTURE0 + unit);
+		}
+		glBindTexture(target, texture);
+	}
+}
+
+void RenderState::bindBuffer(GLenum target, GLuint buffer)
+{
+	// The element array binding belongs to the bound VAO, so it is never cached
+	if (target == GL_ELEMENT_ARRAY_BUFFER)
+	{
+		glBindBuffer(target, buffer);
+		return;
+	}
+
+	if (tracker.bindBuffer(target, buffer))
+	{
+		glBindBuffer(target, buffer);
+	}
+}
+
+void RenderState::setEnabled(GLenum capability, bool enabled)
+{
+	if (tracker.setCapability(capability, enabled))
+	{
+		if (enabled)
+		{
+			glEnable(capability);
+		}
+		else
+		{
+			glDisable(capability);
+		}
+	}
+}
+
+void RenderState::blendFunc(GLenum source, GLenum destination)
+{
+	if (tracker.blendFunc(source, destination))
+	{
+		glBlendFunc(source, destination);
+	}
+}
+
+void RenderState::depthFunc(GLenum function)
+{
+	if (tracker.depthFunc(function))
+	{
+		glDepthFunc(function);
+	}
+}
+
+void RenderState::depthMask(bool enabled)
+{
+	if (tracker.depthMask(enabled))
+	{
+		glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+	}
+}
+
+void RenderState::colorMask(bool red, bool green, bool blue, bool alpha)
+{
+	if (tracker.colorMask(red, green, blue, alpha))
+	{
+		glColorMask(red ? GL_TRUE : GL_FALSE, green ? GL_TRUE : GL_FALSE, blue ? GL_TRUE : GL_FALSE, alpha ? GL_TRUE : GL_FALSE);
+	}
+}
+
+void RenderState::cullFace(GLenum mode)
+{
+	if (tracker.cullFace(mode))
+	{
+		glCullFace(mode);
+	}
+}
+
+void RenderState::polygonMode(GLenum mode)
+{
+	if (tracker.polygonMode(mode))
+	{
+		glPolygonMode(GL_FRONT_AND_BACK, mode);
+	}
+}
@@ -0,0 +1,37 @@
+// RenderState.h
+
+#ifndef RENDER_STATE_H
+#define RENDER_STATE_H
+
+#include <glad/glad.h>
+
+#include "rendering/RenderStateTracker.h"
+
+// Issues GL state changes only when RenderStateTracker says the state
+// actually differs. All binds in the render loop should go through here,
+// anything that bypasses it must call invalidate() afterwards.
+class RenderState
+{
+public:
+	void beginFrame();
+	void invalidate();
+
+	const RenderStateTracker::Stats& getStats() const;
+
+	void useProgram(GLuint program);
+	void bindVertexArray(GLuint vertexArray);
+	void bindTexture(int unit, GLenum target, GLuint texture);
+	void bindBuffer(GLenum target, GLuint buffer);
+	void setEnabled(GLenum capability, bool enabled);
+	void blendFunc(GLenum source, GLenum destination);
+	void depthFunc(GLenum function);
+	void depthMask(bool enabled);
+	void colorMask(bool red, bool green, bool blue, bool alpha);
+	void cullFace(GLenum mode);
+	void polygonMode(GLenum mode);
+
+private:
+	RenderStateTracker tracker;
+};
+
+#endif
@@ -0,0 +1,128 @@
+// RenderStateTracker.cpp
+
+#include "RenderStateTracker.h"
+
+RenderStateTracker::RenderStateTracker()
+{
+	invalidate();
+}
+
+void RenderStateTracker::invalidate()
+{
+	const Binding unknownBinding = { Unknown, Unknown };
+
+	program = Unknown;
+	vertexArray = Unknown;
+	activeUnit = Unknown;
+	for (auto& unit : textures)
+	{
+		unit.fill(unknownBinding);
+	}
+	buffers.fill(unknownBinding);
+	capabilities.fill(unknownBinding);
+	blendSource = Unknown;
+	blendDestination = Unknown;
+	depthFunction = Unknown;
+	depthWrites = Unknown;
+	colorWrites = Unknown;
+	cullMode = Unknown;
+	polygonFill = Unknown;
+}
+
+void RenderStateTracker::resetStats()
+{
+	stats = Stats();
+}
+
+const RenderStateTracker::Stats& RenderStateTracker::getStats() const
+{
+	return stats;
+}
+
+bool RenderStateTracker::update(uint32_t& current, uint32_t value)
+{
+	if (current == value)
+	{
+		stats.CallsAvoided++;
+		return false;
+	}
+
+	current = value;
+	stats.CallsIssued++;
+	return true;
+}
+
+bool RenderStateTracker::useProgram(uint32_t program)
+{
+	return update(this->program, program);
+}
+
+bool RenderStateTracker::bindVertexArray(uint32_t vertexArray)
+{
+	return update(this->vertexArray, vertexArray);
+}
+
+bool RenderStateTracker::activeTexture(int unit)
+{
+	return update(activeUnit, (uint32_t)unit);
+}
+
+bool RenderStateTracker::bindTexture(int unit, uint32_t target, uint32_t texture)
+{
+	// Units past the tracked range are passed straight through
+	if (unit < 0 || unit >= MaxTextureUnits)
+	{
+		stats.CallsIssued++;
+		return true;
+	}
+	return update(findBinding(textures[unit], target).Name, texture);
+}
+
+bool RenderStateTracker::bindBuffer(uint32_t target, uint32_t buffer)
+{
+	return update(findBinding(buffers, target).Name, buffer);
+}
+
+bool RenderStateTracker::setCapability(uint32_t capability, bool enabled)
+{
+	return update(findBinding(capabilities, capability).Name, enabled ? 1 : 0);
+}
+
+bool RenderStateTracker::blendFunc(uint32_t source, uint32_t destination)
+{
+	if (blendSource == source && blendDestination == destination)
+	{
+		stats.CallsAvoided++;
+		return false;
+	}
+
+	blendSource = source;
+	blendDestination = destination;
+	stats.CallsIssued++;
+	return true;
+}
+
+bool RenderStateTracker::depthFunc(uint32_t function)
+{
+	return update(depthFunction, function);
+}
+
+bool RenderStateTracker::depthMask(bool enabled)
+{
+	return update(depthWrites, enabled ? 1 : 0);
+}
+
+bool RenderStateTracker::colorMask(bool red, bool green, bool blue, bool alpha)
+{
+	return update(colorWrites, (red ? 1 : 0) | (green ? 2 : 0) | (blue ? 4 : 0) | (alpha ? 8 : 0));
+}
+
+bool RenderStateTracker::cullFace(uint32_t mode)
+{
+	return update(cullMode, mode);
+}
+
+bool RenderStateTracker::polygonMode(uint32_t mode)
+{
+	return update(polygonFill, mode);
+}
@@ -0,0 +1,97 @@
+// RenderStateTracker.h
+
+#ifndef RENDER_STATE_TRACKER_H
+#define RENDER_STATE_TRACKER_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Shadow copy of the GL state the renderer touches. Every setter returns
+// whether the driver call is actually needed and counts the calls it
+// avoided. It never calls GL itself (RenderState does that), so the
+// tracking logic works without a context. Enums and object names are
+// plain integers and are never interpreted, only compared.
+class RenderStateTracker
+{
+public:
+	static const int MaxTextureUnits = 16;
+	static const int MaxTextureTargets = 4;
+	static const int MaxBufferTargets = 8;
+	static const int MaxCapabilities = 8;
+
+	struct Stats
+	{
+		int CallsIssued = 0;
+		int CallsAvoided = 0;
+	};
+
+	RenderStateTracker();
+
+	// Forget everything, for when code outside the tracker touched GL
+	void invalidate();
+
+	void resetStats();
+	const Stats& getStats() const;
+
+	bool useProgram(uint32_t program);
+	bool bindVertexArray(uint32_t vertexArray);
+	bool activeTexture(int unit);
+	bool bindTexture(int unit, uint32_t target, uint32_t texture);
+	bool bindBuffer(uint32_t target, uint32_t buffer);
+	bool setCapability(uint32_t capability, bool enabled);
+	bool blendFunc(uint32_t source, uint32_t destination);
+	bool depthFunc(uint32_t function);
+	bool depthMask(bool enabled);
+	bool colorMask(bool red, bool green, bool blue, bool alpha);
+	bool cullFace(uint32_t mode);
+	bool polygonMode(uint32_t mode);
+
+private:
+	static const uint32_t Unknown = 0xFFFFFFFFu;
+
+	struct Binding
+	{
+		uint32_t Target;
+		uint32_t Name;
+	};
+
+	uint32_t program;
+	uint32_t vertexArray;
+	uint32_t activeUnit;
+	std::array<std::array<Binding, MaxTextureTargets>, MaxTextureUnits> textures;
+	std::array<Binding, MaxBufferTargets> buffers;
+	std::array<Binding, MaxCapabilities> capabilities;
+	uint32_t blendSource;
+	uint32_t blendDestination;
+	uint32_t depthFunction;
+	uint32_t depthWrites;
+	uint32_t colorWrites;
+	uint32_t cullMode;
+	uint32_t polygonFill;
+
+	Stats stats;
+
+	bool update(uint32_t& current, uint32_t value);
+
+	// Finds the slot for target, claiming a free one or evicting the last
+	template <std::size_t Count>
+	static Binding& findBinding(std::array<Binding, Count>& bindings, uint32_t target)
+	{
+		for (Binding& binding : bindings)
+		{
+			if (binding.Target == target || binding.Target == Unknown)
+			{
+				binding.Target = target;
+				return binding;
+			}
+		}
+
+		Binding& evicted = bindings[Count - 1];
+		evicted.Target = target;
+		evicted.Name = Unknown;
+		return evicted;
+	}
+};
+
+#endif
@@ -0,0 +1,63 @@
+// RenderThread.cpp
+
+#include "RenderThread.h"
+
+#include "utilities/Profiler.h"
+
+RenderThread::~RenderThread()
+{
+	stop();
+}
+
+void RenderThread::start(GLFWwindow* window, const RenderFunction& renderFrame)
+{
+	this->window = window;
+	this->renderFrame = renderFrame;
+
+	glfwMakeContextCurrent(nullptr);
+	thread = std::thread(&RenderThread::run, this);
+}
+
+void RenderThread::stop()
+{
+	if (!thread.joinable())
+	{
+		return;
+	}
+
+	exchange.shutdown();
+	thread.join();
+	glfwMakeContextCurrent(window);
+}
+
+FrameExchange& RenderThread::getExchange()
+{
+	return exchange;
+}
+
+void RenderThread::run()
+{
+	glfwMakeContextCurrent(window);
+	Profiler::setThreadName("Render");
+
+	int swapInterval = -1;
+	while (const FrameSnapshot* snapshot = exchange.acquire())
+	{
+		// The swap interval belongs to the current context, so it can only change here
+		if (snapshot->SwapInterval != swapInterval)
+		{
+			swapInterval = snapshot->SwapInterval;
+			glfwSwapInterval(swapInterval);
+		}
+
+		renderFrame(*snapshot);
+
+		// Commands are already queued, the simulation can reuse the slot while we present
+		exchange.release();
+
+		PROFILE_SCOPE("Swap buffers");
+		glfwSwapBuffers(window);
+	}
+
+	glfwMakeContextCurrent(nullptr);
+}
@@ -0,0 +1,37 @@
+// RenderThread.h
+
+#ifndef RENDER_THREAD_H
+#define RENDER_THREAD_H
+
+#include <GLFW/glfw3.h>
+
+#include <functional>
+#include <thread>
+
+#include "rendering/FrameExchange.h"
+
+// Owns the GL context while running. The window's context must not be
+// current on any other thread between start() and stop(); stop() hands it
+// back to the calling thread so GL objects can be cleaned up there.
+class RenderThread
+{
+public:
+	typedef std::function<void(const FrameSnapshot&)> RenderFunction;
+
+	~RenderThread();
+
+	void start(GLFWwindow* window, const RenderFunction& renderFrame);
+	void stop();
+
+	FrameExchange& getExchange();
+
+private:
+	GLFWwindow* window = nullptr;
+	RenderFunction renderFrame;
+	FrameExchange exchange;
+	std::thread thread;
+
+	void run();
+};
+
+#endif
@@ -0,0 +1,62 @@
+// RenderTypes.h
+
+#ifndef RENDER_TYPES_H
+#define RENDER_TYPES_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <cstdint>
+#include <vector>
+
+#include "utilities/TrackingAllocator.h"
+
+// Backend resources are referred to by opaque handles, 0 is never valid
+typedef uint32_t MeshHandle;
+typedef uint32_t TextureHandle;
+typedef uint32_t ProgramHandle;
+
+// Mesh vertices are interleaved position (3), color (3) and texture coordinate (2)
+const int MeshVertexFloats = 8;
+
+struct MeshData
+{
+	TrackedVector<float, MEMORY_MESHES> Vertices;
+	TrackedVector<unsigned int, MEMORY_MESHES> Indices;
+};
+
+// New contents for a mesh, applied by the backend before the frame is drawn
+struct MeshUpload
+{
+	MeshHandle Mesh = 0;
+	MeshData Data;
+};
+
+// Per-instance data for instanced draws. Matches the INSTANCED attributes
+// in default_vertex.glsl.
+struct MeshInstance
+{
+	glm::vec3 Position = glm::vec3(0.0f);
+	float Scale = 1.0f;
+	// Quaternion stored as x, y, z, w
+	glm::vec4 Rotation = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+	float TextureLayer = 0.0f;
+
+	void setRotation(const glm::quat& rotation)
+	{
+		Rotation = glm::vec4(rotation.x, rotation.y, rotation.z, rotation.w);
+	}
+};
+
+// Screen space vertex for 2D overlays. Position is in framebuffer pixels
+// from the top left, Color is RGBA with red in the lowest byte.
+struct OverlayVertex
+{
+	float X = 0.0f;
+	float Y = 0.0f;
+	float U = 0.0f;
+	float V = 0.0f;
+	uint32_t Color = 0xFFFFFFFFu;
+};
+
+#endif
@@ -0,0 +1,93 @@
+// StagingRing.cpp
+
+#include "StagingRing.h"
+
+#include <cstring>
+
+#include "utilities/MemoryTracker.h"
+
+StagingRing::StagingRing(size_t size)
+	: buffer(0), size(size), head(0), tail(0)
+{
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+	glBufferData(GL_COPY_READ_BUFFER, size, nullptr, GL_STREAM_DRAW);
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+	MemoryTracker::add(MEMORY_GPU_BUFFERS, size);
+}
+
+StagingRing::~StagingRing()
+{
+	glDeleteBuffers(1, &buffer);
+	MemoryTracker::remove(MEMORY_GPU_BUFFERS, size);
+}
+
+GLintptr StagingRing::write(RenderState& renderState, const void* data, size_t size, size_t alignment)
+{
+	size_t offset = (size_t)(head % this->size);
+	size_t padding = (alignment - offset % alignment) % alignment;
+
+	// Allocations never straddle the end, the rest of the buffer is skipped instead
+	if (offset + padding + size > this->size)
+	{
+		padding = this->size - offset;
+	}
+
+	uint64_t start = head + padding;
+	if (size > this->size || start + size - tail > this->size)
+	{
+		stats.Failures++;
+		return -1;
+	}
+
+	GLintptr writeOffset = (GLintptr)(start % this->size);
+	renderState.bindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+	void* mapped = glMapBufferRange(GL_COPY_WRITE_BUFFER, writeOffset, size,
+		GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+	if (!mapped)
+	{
+		stats.Failures++;
+		return -1;
+	}
+	std::memcpy(mapped, data, size);
+	glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+
+	head = start + size;
+	stats.Allocations++;
+	stats.BytesWritten += size;
+	return writeOffset;
+}
+
+void StagingRing::endFrame(uint64_t frame)
+{
+	marks.push_back({ frame, head });
+}
+
+void StagingRing::collect(uint64_t completedFrame)
+{
+	while (!marks.empty() && marks.front().Frame <= completedFrame)
+	{
+		tail = marks.front().End;
+		marks.pop_front();
+	}
+}
+
+GLuint StagingRing::getBuffer() const
+{
+	return buffer;
+}
+
+size_t StagingRing::getSize() const
+{
+	return size;
+}
+
+void StagingRing::resetStats()
+{
+	stats = Stats();
+}
+
+const StagingRing::Stats& StagingRing::getStats() const
+{
+	return stats;
+}
@@ -0,0 +1,69 @@
+// StagingRing.h
+
+#ifndef STAGING_RING_H
+#define STAGING_RING_H
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+#include "rendering/RenderState.h"
+
+// One large buffer that per-frame upload data is written into front to
+// back. A region is only written again once the frame that used it has
+// completed, so the writes map the buffer unsynchronized and never wait
+// on the GPU. The data can be drawn from directly or copied elsewhere.
+class StagingRing
+{
+public:
+	struct Stats
+	{
+		int Allocations = 0;
+		// Writes that did not fit, the caller has to fall back to its own upload
+		int Failures = 0;
+		size_t BytesWritten = 0;
+	};
+
+	explicit StagingRing(size_t size);
+	~StagingRing();
+
+	StagingRing(const StagingRing&) = delete;
+	StagingRing& operator=(const StagingRing&) = delete;
+
+	// Copies data into the ring and returns its offset in getBuffer(), or -1 if there is no room
+	GLintptr write(RenderState& renderState, const void* data, size_t size, size_t alignment);
+
+	// Everything written since the last call belongs to frame
+	void endFrame(uint64_t frame);
+
+	// Frees the space written during frames up to completedFrame
+	void collect(uint64_t completedFrame);
+
+	GLuint getBuffer() const;
+	size_t getSize() const;
+
+	// Resets the per-frame counters
+	void resetStats();
+	const Stats& getStats() const;
+
+private:
+	struct FrameMark
+	{
+		uint64_t Frame;
+		uint64_t End;
+	};
+
+	GLuint buffer;
+	size_t size;
+
+	// Running byte counts, the ring offset is position % size
+	uint64_t head;
+	uint64_t tail;
+	std::deque<FrameMark> marks;
+
+	Stats stats;
+};
+
+#endif
@@ -0,0 +1,176 @@
+// TextureCache.cpp
+
+#include "TextureCache.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+#include "utilities/Profiler.h"
+
+namespace
+{
+	const char MAGIC[4] = { 'V', 'X', 'T', 'C' };
+	const size_t DATA_ALIGNMENT = 64;
+	const uint32_t MAX_MIP_COUNT = 32;
+
+	struct CacheHeader
+	{
+		char Magic[4];
+		uint32_t Version;
+		uint64_t Key;
+		uint32_t Width;
+		uint32_t Height;
+		uint32_t Layers;
+		uint32_t MipCount;
+	};
+
+	uint64_t hashBytes(uint64_t hash, const void* bytes, size_t size)
+	{
+		const unsigned char* data = (const unsigned char*)bytes;
+		for (size_t i = 0; i < size; i++)
+		{
+			hash = (hash ^ data[i]) * 1099511628211ull;
+		}
+		return hash;
+	}
+
+	size_t getDataOffset(uint32_t mipCount)
+	{
+		size_t tableEnd = sizeof(CacheHeader) + mipCount * sizeof(uint64_t);
+		return (tableEnd + DATA_ALIGNMENT - 1) / DATA_ALIGNMENT * DATA_ALIGNMENT;
+	}
+}
+
+uint64_t TextureCache::computeKey(const std::vector<std::string>& paths)
+{
+	uint64_t hash = 14695981039346656037ull;
+	uint32_t version = Version;
+	hash = hashBytes(hash, &version, sizeof(version));
+
+	std::vector<char> contents;
+	for (const std::string& path : paths)
+	{
+		hash = hashBytes(hash, path.c_str(), path.size() + 1);
+
+		std::ifstream sourceFile(std::string(PROJECT_ROOT) + "/assets/textures/" + path, std::ios::binary);
+		contents.assign(std::istreambuf_iterator<char>(sourceFile), std::istreambuf_iterator<char>());
+
+		uint64_t size = contents.size();
+		hash = hashBytes(hash, &size, sizeof(size));
+		hash = hashBytes(hash, contents.data(), contents.size());
+	}
+
+	return hash;
+}
+
+bool TextureCache::open(const std::string& path, uint64_t key)
+{
+	PROFILE_SCOPE("Map texture cache");
+
+	close();
+
+	if (!file.open(path) || file.getSize() < sizeof(CacheHeader))
+	{
+		return false;
+	}
+
+	CacheHeader header;
+	std::memcpy(&header, file.getData(), sizeof(header));
+
+	if (std::memcmp(header.Magic, MAGIC, sizeof(MAGIC)) != 0 || header.Version != Version || header.Key != key ||
+		header.MipCount == 0 || header.MipCount > MAX_MIP_COUNT || file.getSize() < getDataOffset(header.MipCount))
+	{
+		close();
+		return false;
+	}
+
+	view.Width = (int)header.Width;
+	view.Height = (int)header.Height;
+	view.Layers = (int)header.Layers;
+
+	// Reject truncated files rather than upload past the end of the mapping
+	for (uint32_t level = 0; level < header.MipCount; level++)
+	{
+		uint64_t offset;
+		std::memcpy(&offset, file.getData() + sizeof(CacheHeader) + level * sizeof(uint64_t), sizeof(offset));
+
+		uint64_t levelBytes = (uint64_t)TextureArrayData::getLevelSize(view.Width, level) *
+			TextureArrayData::getLevelSize(view.Height, level) * view.Layers * 4;
+		if (offset + levelBytes > file.getSize())
+		{
+			close();
+			return false;
+		}
+
+		view.Levels.push_back(file.getData() + offset);
+	}
+
+	return true;
+}
+
+void TextureCache::close()
+{
+	file.close();
+	view = TextureArrayView();
+}
+
+const TextureArrayView& TextureCache::getView() const
+{
+	return view;
+}
+
+bool TextureCache::write(const std::string& path, uint64_t key, const TextureArrayData& data)
+{
+	PROFILE_SCOPE("Write texture cache");
+
+	std::error_code error;
+	std::filesystem::path cachePath(path);
+	if (cachePath.has_parent_path())
+	{
+		std::filesystem::create_directories(cachePath.parent_path(), error);
+	}
+
+	// Write to a temporary file first so a crash never leaves a torn cache behind
+	std::string temporaryPath = path + ".tmp";
+	std::ofstream cacheFile(temporaryPath, std::ios::binary | std::ios::trunc);
+	if (!cacheFile)
+	{
+		return false;
+	}
+
+	CacheHeader header;
+	std::memcpy(header.Magic, MAGIC, sizeof(MAGIC));
+	header.Version = Version;
+	header.Key = key;
+	header.Width = (uint32_t)data.Width;
+	header.Height = (uint32_t)data.Height;
+	header.Layers = (uint32_t)data.Layers;
+	header.MipCount = (uint32_t)data.MipCount;
+	cacheFile.write((const char*)&header, sizeof(header));
+
+	size_t dataOffset = getDataOffset(header.MipCount);
+	for (int level = 0; level < data.MipCount; level++)
+	{
+		uint64_t offset = dataOffset + data.LevelOffsets[level];
+		cacheFile.write((const char*)&offset, sizeof(offset));
+	}
+
+	size_t padding = dataOffset - sizeof(CacheHeader) - header.MipCount * sizeof(uint64_t);
+	const char zeros[DATA_ALIGNMENT] = {};
+	cacheFile.write(zeros, padding);
+
+	// Levels are already laid out back to back in the decoded data
+	cacheFile.write((const char*)data.Pixels.data(), data.Pixels.size());
+	cacheFile.close();
+
+	if (!cacheFile)
+	{
+		std::filesystem::remove(temporaryPath, error);
+		return false;
+	}
+
+	std::filesystem::rename(temporaryPath, path, error);
+	return !error;
+}
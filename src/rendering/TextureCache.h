@@ -0,0 +1,39 @@
+// TextureCache.h
+
+#ifndef TEXTURE_CACHE_H
+#define TEXTURE_CACHE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "rendering/BlockTextures.h"
+#include "utilities/MappedFile.h"
+
+// Binary cache of a decoded and mipmapped texture array. The file is a
+// small header, the offset of every mip level and then the raw RGBA8
+// levels, so a warm start maps the file and uploads straight from the
+// mapping without decoding or copying anything.
+class TextureCache
+{
+public:
+	static const uint32_t Version = 1;
+
+	// Hash of the cache format and the path and contents of every source
+	// file, paths are relative to assets/textures
+	static uint64_t computeKey(const std::vector<std::string>& paths);
+
+	// Maps the cache and validates it against key
+	bool open(const std::string& path, uint64_t key);
+	void close();
+
+	const TextureArrayView& getView() const;
+
+	static bool write(const std::string& path, uint64_t key, const TextureArrayData& data);
+
+private:
+	MappedFile file;
+	TextureArrayView view;
+};
+
+#endif
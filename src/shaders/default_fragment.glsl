@@ -1,13 +1,28 @@
 #version 330 core
 
+#ifdef VERTEX_COLOR
 in vec3 color;
+#endif
 in vec2 texCoord;
+#ifdef INSTANCED
+flat in float textureLayer;
+#endif
 
-uniform sampler2D tex;
+uniform sampler2DArray tex;
+#ifndef INSTANCED
+uniform float sTextureLayer;
+#endif
 
 out vec4 FragColor;
 
 void main()
 {
-	FragColor = texture(tex, texCoord);
+#ifdef INSTANCED
+	FragColor = texture(tex, vec3(texCoord, textureLayer));
+#else
+	FragColor = texture(tex, vec3(texCoord, sTextureLayer));
+#endif
+#ifdef VERTEX_COLOR
+	FragColor.rgb *= color;
+#endif
 }
\ No newline at end of file
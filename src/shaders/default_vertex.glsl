@@ -1,22 +1,53 @@
 #version 330 core
 
 layout (location = 0) in vec3 aPos;
+#ifdef VERTEX_COLOR
 layout (location = 1) in vec3 aColor;
+#endif
 layout (location = 2) in vec2 aTexCoord;
+#ifdef INSTANCED
+layout (location = 3) in vec4 aInstancePositionScale;
+layout (location = 4) in vec4 aInstanceRotation;
+layout (location = 5) in float aInstanceTextureLayer;
+#endif
 
 uniform mat4 transform;
 
+#include "camera.glsl"
+
+#ifndef INSTANCED
 uniform mat4 sModelMatrix;
-uniform mat4 sViewMatrix;
-uniform mat4 sProjectionMatrix;
+#endif
 
+#ifdef VERTEX_COLOR
 out vec3 color;
+#endif
 out vec2 texCoord;
+#ifdef INSTANCED
+flat out float textureLayer;
+#endif
+
+#ifdef INSTANCED
+// Rotates v by the unit quaternion q (x, y, z, w)
+vec3 rotate(vec4 q, vec3 v)
+{
+	return v + 2.0 * cross(q.xyz, cross(q.xyz, v) + q.w * v);
+}
+#endif
 
 void main()
 {
-	// Multiply matrices in reverse (p, v, m)
-	gl_Position = sProjectionMatrix * sViewMatrix * sModelMatrix * vec4(aPos, 1.0);
+#ifdef INSTANCED
+	vec3 worldPosition = rotate(aInstanceRotation, aPos * aInstancePositionScale.w) + aInstancePositionScale.xyz;
+	gl_Position = sViewProjectionMatrix * vec4(worldPosition, 1.0);
+	textureLayer = aInstanceTextureLayer;
+#else
+	// View-projection is premultiplied on the CPU, so this is two
+	// matrix-vector products instead of two matrix-matrix products
+	gl_Position = sViewProjectionMatrix * (sModelMatrix * vec4(aPos, 1.0));
+#endif
+#ifdef VERTEX_COLOR
 	color = aColor;
+#endif
 	texCoord = aTexCoord;
 }
\ No newline at end of file
@@ -0,0 +1,8 @@
+// Shared by every program, filled once per frame by CameraUniforms
+layout (std140) uniform Camera
+{
+	mat4 sViewMatrix;
+	mat4 sProjectionMatrix;
+	mat4 sViewProjectionMatrix;
+	vec4 sCameraPosition;
+};
@@ -0,0 +1,9 @@
+#version 330 core
+
+out vec4 FragColor;
+
+void main()
+{
+	// Colour writes are masked off, only the samples passed count matters
+	FragColor = vec4(1.0);
+}
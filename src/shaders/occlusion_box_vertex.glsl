@@ -0,0 +1,14 @@
+#version 330 core
+
+layout (location = 0) in vec3 aPos;
+
+#include "camera.glsl"
+
+uniform vec3 sBoxMin;
+uniform vec3 sBoxSize;
+
+void main()
+{
+	// aPos is a unit cube corner, stretch it over the box being queried
+	gl_Position = sViewProjectionMatrix * vec4(sBoxMin + aPos * sBoxSize, 1.0);
+}
@@ -0,0 +1,14 @@
+#version 330 core
+
+in vec2 texCoord;
+in vec4 color;
+
+// One layer atlas of font glyphs and a white block
+uniform sampler2DArray tex;
+
+out vec4 FragColor;
+
+void main()
+{
+	FragColor = color * texture(tex, vec3(texCoord, 0.0));
+}
@@ -0,0 +1,19 @@
+#version 330 core
+
+layout (location = 0) in vec2 aPos;
+layout (location = 1) in vec2 aTexCoord;
+layout (location = 2) in vec4 aColor;
+
+// Framebuffer size in pixels, positions are pixels from the top left
+uniform vec2 sScreenSize;
+
+out vec2 texCoord;
+out vec4 color;
+
+void main()
+{
+	vec2 ndc = aPos / sScreenSize * 2.0 - 1.0;
+	gl_Position = vec4(ndc.x, -ndc.y, 0.0, 1.0);
+	texCoord = aTexCoord;
+	color = aColor;
+}
@@ -0,0 +1,326 @@
+// bench.cpp
+//
+// Micro benchmarks for the engine core. Every benchmark runs --repeat
+// times after one untimed warm up run and prints the same summary as the
+// frame benchmarks. --filter <text> only runs benchmarks whose name
+// contains text. The jobs_* benchmarks run the same work on 1, 2, 4 ...
+// workers up to --max-workers (one per hardware thread by default) and
+// finish with a table of speedups over one worker.
+
+#include <glm/glm.hpp>
+#include <iostream>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "utilities/FrameArena.h"
+#include "utilities/FrameTimings.h"
+#include "utilities/JobSystem.h"
+#include "utilities/MemoryTracker.h"
+#include "utilities/Profiler.h"
+#include "rendering/BlockTextures.h"
+#include "rendering/NullBackend.h"
+#include "rendering/RenderQueue.h"
+#include "world/Chunk.h"
+#include "world/WorldGenerator.h"
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    // Runs once per repetition and returns the milliseconds it measured,
+    // so setup that should not count can happen before the clock starts
+    struct Benchmark
+    {
+        std::string Name;
+        std::function<double()> Run;
+    };
+
+    double millisecondsSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    const int BENCH_CHUNKS = 64;
+
+    std::vector<std::unique_ptr<Chunk>> makeChunks(int count = BENCH_CHUNKS)
+    {
+        std::vector<std::unique_ptr<Chunk>> chunks;
+        for (int i = 0; i < count; i++)
+        {
+            chunks.push_back(std::make_unique<Chunk>(glm::ivec3(i % 8, 1, i / 8)));
+        }
+        return chunks;
+    }
+
+    // Records 100k packets spread over every recorder, then radix sorts them
+    double recordAndSort(RenderQueue& renderQueue, FrameArenas& frameArenas, JobSystem& jobs)
+    {
+        const int packetCount = 100000;
+
+        auto start = Clock::now();
+        frameArenas.reset();
+        renderQueue.beginFrame(frameArenas);
+        renderQueue.record(packetCount, jobs, [](RenderQueue::Recorder& recorder, int index)
+        {
+            uint32_t hash = (uint32_t)index * 2654435761u;
+            DrawPacket packet;
+            packet.Program = 1 + (hash >> 28);
+            packet.Mesh = 1 + (MeshHandle)index;
+            packet.Texture = 1 + ((hash >> 20) & 7);
+            packet.Key = RenderQueue::makeKey(RenderQueue::PASS_OPAQUE, packet.Program, packet.Texture, (float)(hash & 0xFFFF));
+            recorder.submit(packet);
+        });
+        renderQueue.sort();
+        return millisecondsSince(start);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int repeat = 20;
+    std::string filter;
+    int threadCount = (int)std::max(1u, std::thread::hardware_concurrency());
+    int maxWorkers = threadCount;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        if (argument == "--repeat" && i + 1 < argc)
+        {
+            repeat = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (argument == "--filter" && i + 1 < argc)
+        {
+            filter = argv[++i];
+        }
+        else if (argument == "--max-workers" && i + 1 < argc)
+        {
+            maxWorkers = std::max(1, std::atoi(argv[++i]));
+        }
+    }
+
+    JobSystem jobs(threadCount);
+    std::string textureCachePath = (std::filesystem::temp_directory_path() / "voxel_bench_block_textures.bin").string();
+    WorldGenerator generator;
+    RenderQueue renderQueue(threadCount);
+    FrameArenas frameArenas(threadCount);
+
+    auto loadTextures = [&]()
+    {
+        NullBackend backend;
+        BlockTextures blockTextures;
+        blockTextures.registerTexture("test_texture.png");
+
+        auto start = Clock::now();
+        blockTextures.load(backend, textureCachePath, jobs);
+        return millisecondsSince(start);
+    };
+
+    std::vector<Benchmark> benchmarks = {
+        // Decodes the PNGs, builds the mips and writes the cache
+        { "texture_cache_cold", [&]()
+        {
+            std::error_code error;
+            std::filesystem::remove(textureCachePath, error);
+            return loadTextures();
+        } },
+
+        // Maps the cache written by the previous run
+        { "texture_cache_warm", [&]()
+        {
+            return loadTextures();
+        } },
+
+        { "chunk_generate", [&]()
+        {
+            std::vector<std::unique_ptr<Chunk>> chunks = makeChunks();
+
+            auto start = Clock::now();
+            for (std::unique_ptr<Chunk>& chunk : chunks)
+            {
+                generator.generate(*chunk);
+            }
+            return millisecondsSince(start);
+        } },
+
+        // Visibility and occluder rebuild only, the tree has no mesher to time
+        { "chunk_visibility_and_occluders", [&]()
+        {
+            std::vector<std::unique_ptr<Chunk>> chunks = makeChunks();
+            for (std::unique_ptr<Chunk>& chunk : chunks)
+            {
+                generator.generate(*chunk);
+            }
+
+            auto start = Clock::now();
+            for (std::unique_ptr<Chunk>& chunk : chunks)
+            {
+                chunk->rebuildVisibility();
+                chunk->rebuildOccluders();
+            }
+            return millisecondsSince(start);
+        } },
+
+        // 100k packets recorded across every worker, then radix sorted
+        { "render_queue_100k", [&]()
+        {
+            return recordAndSort(renderQueue, frameArenas, jobs);
+        } },
+
+        // 10k empty zones, so the average in milliseconds reads as 100 x nanoseconds per zone
+        { "profile_scope_10k", [&]()
+        {
+            auto start = Clock::now();
+            for (int i = 0; i < 10000; i++)
+            {
+                PROFILE_SCOPE("Empty zone");
+            }
+            double milliseconds = millisecondsSince(start);
+
+            Profiler::flush();
+            Profiler::clear();
+            return milliseconds;
+        } },
+
+        // 10k tracked allocate and free pairs, read like profile_scope_10k
+        { "memory_tracker_10k", [&]()
+        {
+            auto start = Clock::now();
+            for (int i = 0; i < 10000; i++)
+            {
+                MemoryTracker::add(MEMORY_MESHES, 64);
+                MemoryTracker::remove(MEMORY_MESHES, 64);
+            }
+            return millisecondsSince(start);
+        } },
+
+        // 10k 64 byte frame arena allocations and one reset, read like profile_scope_10k
+        { "frame_arena_10k", [&]()
+        {
+            FrameArena& arena = frameArenas.get(0);
+            auto start = Clock::now();
+            for (int i = 0; i < 10000; i++)
+            {
+                arena.allocate(64, 16);
+            }
+            arena.reset();
+            return millisecondsSince(start);
+        } }
+    };
+
+    // =============================
+    // Scaling
+    //
+    // Each run starts its own job system before the clock does, so the
+    // calling thread is worker 0 of the system being measured
+    std::vector<int> workerCounts;
+    for (int workers = 1; workers < maxWorkers; workers *= 2)
+    {
+        workerCounts.push_back(workers);
+    }
+    workerCounts.push_back(maxWorkers);
+
+    const std::vector<std::string> scalingWorkloads = { "jobs_generate_256", "jobs_render_queue_100k", "jobs_empty_10k" };
+    for (int workers : workerCounts)
+    {
+        std::string suffix = "_w" + std::to_string(workers);
+
+        // Generation, visibility and occluders for 256 chunks, one job per chunk
+        benchmarks.push_back({ scalingWorkloads[0] + suffix, [&, workers]()
+        {
+            JobSystem scalingJobs(workers);
+            std::vector<std::unique_ptr<Chunk>> chunks = makeChunks(256);
+
+            auto start = Clock::now();
+            scalingJobs.parallelFor((int)chunks.size(), [&](int begin, int end)
+            {
+                for (int i = begin; i < end; i++)
+                {
+                    generator.generate(*chunks[i]);
+                    chunks[i]->rebuildVisibility();
+                    chunks[i]->rebuildOccluders();
+                }
+            }, (int)chunks.size());
+            return millisecondsSince(start);
+        } });
+
+        benchmarks.push_back({ scalingWorkloads[1] + suffix, [&, workers]()
+        {
+            JobSystem scalingJobs(workers);
+            RenderQueue scalingQueue(workers);
+            FrameArenas scalingArenas(workers);
+            return recordAndSort(scalingQueue, scalingArenas, scalingJobs);
+        } });
+
+        // 10k jobs that do nothing, so the average in milliseconds reads as 100 x nanoseconds per job
+        benchmarks.push_back({ scalingWorkloads[2] + suffix, [&, workers]()
+        {
+            JobSystem scalingJobs(workers);
+            JobCounter counter;
+
+            auto start = Clock::now();
+            for (int i = 0; i < 10000; i++)
+            {
+                scalingJobs.run([]() {}, &counter);
+            }
+            scalingJobs.wait(counter);
+            return millisecondsSince(start);
+        } });
+    }
+
+    std::map<std::string, double> averages;
+
+    for (const Benchmark& benchmark : benchmarks)
+    {
+        if (!filter.empty() && benchmark.Name.find(filter) == std::string::npos)
+        {
+            continue;
+        }
+
+        benchmark.Run();
+
+        FrameTimings timings;
+        timings.reserve(repeat);
+        for (int i = 0; i < repeat; i++)
+        {
+            timings.record(benchmark.Run());
+        }
+        timings.printSummary(std::cout, benchmark.Name);
+        averages[benchmark.Name] = timings.getAverage();
+    }
+
+    for (const std::string& workload : scalingWorkloads)
+    {
+        auto single = averages.find(workload + "_w1");
+        if (single == averages.end())
+        {
+            continue;
+        }
+
+        std::cout << workload << " speedup:";
+        const char* separator = " ";
+        for (int workers : workerCounts)
+        {
+            auto measured = averages.find(workload + "_w" + std::to_string(workers));
+            if (measured != averages.end() && measured->second > 0.0)
+            {
+                std::cout << separator << single->second / measured->second << "x with " << workers
+                    << (workers == 1 ? " worker" : " workers");
+                separator = ", ";
+            }
+        }
+        std::cout << '\n';
+    }
+
+    std::error_code error;
+    std::filesystem::remove(textureCachePath, error);
+    return 0;
+}
@@ -0,0 +1,407 @@
+// flythrough.cpp
+//
+// Regression benchmark: flies a camera along a fixed path through a seeded
+// world at a constant speed, streaming chunks in and out around it, and
+// reports frame time percentiles, hitches, chunk streaming latency and the
+// memory high-water mark. Every frame advances the camera by the same
+// distance, so two runs with the same arguments do the same work. Drawing
+// goes through the null backend, so no window or GL context is needed.
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <iostream>
+#include <fstream>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "utilities/FrameArena.h"
+#include "utilities/FrameTimings.h"
+#include "utilities/HeapCounter.h"
+#include "utilities/JobSystem.h"
+#include "utilities/MemoryTracker.h"
+#include "utilities/ProcessMemory.h"
+#include "utilities/Profiler.h"
+#include "rendering/CaveCuller.h"
+#include "rendering/FrameExchange.h"
+#include "rendering/NullBackend.h"
+#include "rendering/OcclusionCuller.h"
+#include "rendering/RenderQueue.h"
+#include "world/CameraPath.h"
+#include "world/ChunkStreamer.h"
+#include "world/World.h"
+#include "world/WorldGenerator.h"
+
+namespace
+{
+    double millisecondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Meanders away from the origin over fresh terrain, staying a few blocks above the surface
+    CameraPath makeDefaultPath(const WorldGenerator& generator, int layers)
+    {
+        CameraPath path;
+        for (int i = 0; i <= 8; i++)
+        {
+            float x = i * 64.0f;
+            float z = std::sin(i * 1.3f) * 48.0f;
+            float y = std::min((float)(layers * Chunk::Size - 2), (float)generator.getHeight((int)x, (int)z) + 12.0f);
+            path.addPoint(glm::vec3(x, y, z));
+        }
+        return path;
+    }
+
+    void writeSummaryJson(std::ostream& output, const FrameTimings& timings)
+    {
+        output << "{\"avg\":" << timings.getAverage() << ",\"min\":" << timings.getMin()
+            << ",\"p50\":" << timings.getPercentile(50.0) << ",\"p95\":" << timings.getPercentile(95.0)
+            << ",\"p99\":" << timings.getPercentile(99.0) << ",\"max\":" << timings.getMax() << '}';
+    }
+}
+
+int main(int argc, char** argv)
+{
+    // --seed <n> and --layers <chunks> pick the world, --path <file> flies a
+    // recorded path instead of the default one (--save-path <file> writes
+    // the path used), at --speed <blocks per second>. --radius <chunks> is
+    // the streaming radius and --budget <chunks> the chunks built per frame.
+    // --csv <file> writes one row per frame, --json <file> the summary, and
+    // --trace <json> the most recent profiler zones. Frames over --hitch <ms> count as
+    // hitches; with --max-p99 <ms> the run fails if p99 is slower.
+    uint32_t seed = 1;
+    int layers = 6;
+    int loadRadius = 8;
+    int buildBudget = 64;
+    float speed = 32.0f;
+    double tickRate = 60.0;
+    double hitchMilliseconds = 33.3;
+    double maxP99 = 0.0;
+    int threadCount = (int)std::max(1u, std::thread::hardware_concurrency());
+    std::string pathFile;
+    std::string savePathFile;
+    std::string csvPath;
+    std::string jsonPath;
+    std::string tracePath;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        if (argument == "--seed" && i + 1 < argc)
+        {
+            seed = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (argument == "--layers" && i + 1 < argc)
+        {
+            layers = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (argument == "--radius" && i + 1 < argc)
+        {
+            loadRadius = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (argument == "--budget" && i + 1 < argc)
+        {
+            buildBudget = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (argument == "--speed" && i + 1 < argc)
+        {
+            speed = std::max(0.1f, (float)std::atof(argv[++i]));
+        }
+        else if (argument == "--hitch" && i + 1 < argc)
+        {
+            hitchMilliseconds = std::atof(argv[++i]);
+        }
+        else if (argument == "--max-p99" && i + 1 < argc)
+        {
+            maxP99 = std::atof(argv[++i]);
+        }
+        else if (argument == "--threads" && i + 1 < argc)
+        {
+            threadCount = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (argument == "--path" && i + 1 < argc)
+        {
+            pathFile = argv[++i];
+        }
+        else if (argument == "--save-path" && i + 1 < argc)
+        {
+            savePathFile = argv[++i];
+        }
+        else if (argument == "--csv" && i + 1 < argc)
+        {
+            csvPath = argv[++i];
+        }
+        else if (argument == "--json" && i + 1 < argc)
+        {
+            jsonPath = argv[++i];
+        }
+        else if (argument == "--trace" && i + 1 < argc)
+        {
+            tracePath = argv[++i];
+        }
+    }
+
+    Profiler::setThreadName("Main");
+    if (!tracePath.empty())
+    {
+        Profiler::beginCapture();
+    }
+    JobSystem jobs(threadCount);
+
+    World world;
+    WorldGenerator generator(seed);
+
+    CameraPath path;
+    if (pathFile.empty())
+    {
+        path = makeDefaultPath(generator, layers);
+    }
+    else if (!path.load(pathFile))
+    {
+        return -1;
+    }
+    if (path.getPoints().size() < 2)
+    {
+        std::cout << "ERROR::FLYTHROUGH::PATH_TOO_SHORT\n";
+        return -1;
+    }
+    if (!savePathFile.empty())
+    {
+        path.save(savePathFile);
+    }
+
+    ChunkStreamer streamer(world);
+    streamer.LoadRadius = loadRadius;
+    streamer.UnloadRadius = loadRadius + 2;
+    streamer.Layers = layers;
+    streamer.BuildBudget = buildBudget;
+
+    NullBackend backend;
+    backend.registerProgram("default", "default_vertex.glsl", "default_fragment.glsl", { "INSTANCED", "VERTEX_COLOR" });
+    ProgramHandle chunkProgram = backend.createProgram("default", {});
+    std::unordered_map<glm::ivec3, MeshHandle, ChunkPositionHash> chunkMeshes;
+
+    CaveCuller caveCuller;
+    OcclusionCuller occlusionCuller;
+    RenderQueue renderQueue(threadCount);
+    FrameArenas frameArenas(threadCount);
+    FrameSnapshot frame;
+    glm::mat4 projectionMatrix = glm::perspective(glm::radians(70.0f), 16.0f / 9.0f, 0.1f, 500.0f);
+
+    // Generates whatever the streamer hands out and rebuilds its visibility and
+    // occluders, then culls and draws the view. There is no mesher, chunk
+    // meshes are only reserved handles.
+    auto runFrame = [&](const glm::vec3& cameraPosition, const glm::vec3& viewDirection, uint64_t frameIndex)
+    {
+        frameArenas.reset();
+        std::vector<Chunk*>& builds = streamer.update(cameraPosition);
+        jobs.parallelFor((int)builds.size(), [&](int begin, int end)
+        {
+            for (int i = begin; i < end; i++)
+            {
+                generator.generate(*builds[i]);
+                builds[i]->rebuildVisibility();
+                builds[i]->rebuildOccluders();
+            }
+        });
+
+        frame.reset();
+        frame.FrameIndex = frameIndex;
+        for (Chunk* chunk : builds)
+        {
+            chunkMeshes[chunk->Position] = backend.reserveMesh();
+        }
+        for (const glm::ivec3& position : streamer.getUnloaded())
+        {
+            auto it = chunkMeshes.find(position);
+            if (it != chunkMeshes.end())
+            {
+                frame.MeshDeletions.push_back(it->second);
+                chunkMeshes.erase(it);
+            }
+        }
+        streamer.finishBuilds();
+
+        glm::mat4 viewMatrix = glm::lookAt(cameraPosition, cameraPosition + viewDirection, glm::vec3(0.0f, 1.0f, 0.0f));
+        frame.View = viewMatrix;
+        frame.Projection = projectionMatrix;
+        frame.CameraPosition = cameraPosition;
+
+        const std::vector<const Chunk*>& caveVisible = caveCuller.cull(world, cameraPosition, viewDirection, frameArenas.get(0));
+        const std::vector<const Chunk*>& visible = occlusionCuller.cull(caveVisible, cameraPosition, projectionMatrix * viewMatrix,
+            frameArenas.get(0), jobs);
+
+        renderQueue.beginFrame(frameArenas);
+        renderQueue.record((int)visible.size(), jobs, [&](RenderQueue::Recorder& recorder, int index)
+        {
+            const Chunk* chunk = visible[index];
+            glm::vec3 center = (glm::vec3(chunk->Position) + 0.5f) * (float)Chunk::Size;
+
+            DrawPacket packet;
+            packet.Program = chunkProgram;
+            packet.Mesh = chunkMeshes.at(chunk->Position);
+            packet.Model = glm::translate(glm::mat4(1.0f), glm::vec3(chunk->Position * Chunk::Size));
+            packet.Key = RenderQueue::makeKey(RenderQueue::PASS_OPAQUE, packet.Program, packet.Texture,
+                glm::length(center - cameraPosition));
+            recorder.submit(packet);
+        });
+        renderQueue.sort();
+
+        backend.beginFrame(frame);
+        backend.drawPackets(renderQueue.getSorted());
+        backend.endFrame();
+
+        return visible.size();
+    };
+
+    // =============================
+    // Warm up
+    //
+    // Streams in everything around the start before timing begins, so the
+    // run measures streaming while moving rather than the initial load
+    int warmupFrames = 0;
+    do
+    {
+        runFrame(path.getPosition(0.0f), path.getDirection(0.0f), 0);
+        warmupFrames++;
+        Profiler::flush();
+    } while (streamer.getPendingCount() > 0);
+    size_t warmupLatencies = streamer.getLatencies().size();
+    size_t warmupBuilt = streamer.getStats().ChunksBuilt;
+
+    // =============================
+    // Flythrough
+    //
+    float step = (float)(speed / tickRate);
+    int frameCount = (int)std::ceil(path.getLength() / step) + 1;
+
+    FrameTimings frameTimings;
+    frameTimings.reserve(frameCount);
+
+    struct FrameRow
+    {
+        size_t ChunksBuilt;
+        size_t ChunksLoaded;
+        size_t ChunksVisible;
+        size_t ChunksPending;
+        size_t ResidentBytes;
+        uint64_t HeapAllocations;
+    };
+    std::vector<FrameRow> rows;
+    rows.reserve(frameCount);
+
+    for (int frameIndex = 0; frameIndex < frameCount; frameIndex++)
+    {
+        PROFILE_SCOPE("Frame");
+        auto frameStart = std::chrono::steady_clock::now();
+
+        float distance = std::min(frameIndex * step, path.getLength());
+        size_t builtBefore = streamer.getStats().ChunksBuilt;
+        uint64_t allocationsBefore = getHeapAllocationCount();
+        size_t visibleCount = runFrame(path.getPosition(distance), path.getDirection(distance), (uint64_t)(warmupFrames + frameIndex));
+
+        // Part of every engine frame, so it is timed and counted like the rest
+        Profiler::flush();
+
+        frameTimings.record(millisecondsSince(frameStart));
+        uint64_t heapAllocations = getHeapAllocationCount() - allocationsBefore;
+        rows.push_back({ streamer.getStats().ChunksBuilt - builtBefore, world.getChunkCount(), visibleCount,
+            streamer.getPendingCount(), getResidentBytes(), heapAllocations });
+    }
+
+    const std::vector<double>& allLatencies = streamer.getLatencies();
+    FrameTimings latencyTimings;
+    for (size_t i = warmupLatencies; i < allLatencies.size(); i++)
+    {
+        latencyTimings.record(allLatencies[i]);
+    }
+
+    size_t hitches = frameTimings.getCountAbove(hitchMilliseconds);
+
+    // Frames that streamed nothing in or out should not have allocated at all
+    uint64_t quietAllocations = 0;
+    size_t quietFrames = 0;
+    for (const FrameRow& row : rows)
+    {
+        if (row.ChunksBuilt == 0)
+        {
+            quietAllocations += row.HeapAllocations;
+            quietFrames++;
+        }
+    }
+    size_t peakResidentBytes = getPeakResidentBytes();
+    const ChunkStreamer::Stats& streamStats = streamer.getStats();
+
+    std::cout << "Seed " << seed << ", path " << path.getLength() << " blocks at " << speed << " blocks/s, "
+        << threadCount << " threads, " << warmupFrames << " warm up frames (" << warmupBuilt << " chunks)\n";
+    frameTimings.printSummary(std::cout, "Flythrough");
+    std::cout << "Hitches over " << hitchMilliseconds << " ms: " << hitches << '\n';
+    std::cout << "Streamed " << streamStats.ChunksBuilt - warmupBuilt << " chunks, unloaded " << streamStats.ChunksUnloaded
+        << ", peak " << streamStats.PeakChunksLoaded << " loaded\n";
+    std::cout << "Streaming latency: p50 " << latencyTimings.getPercentile(50.0) << " ms, p95 " << latencyTimings.getPercentile(95.0)
+        << " ms, p99 " << latencyTimings.getPercentile(99.0) << " ms, max " << latencyTimings.getMax() << " ms\n";
+    std::cout << "Peak resident memory: " << peakResidentBytes / (1024.0 * 1024.0) << " MB, chunks "
+        << MemoryTracker::getStats(MEMORY_CHUNKS).PeakBytes / (1024.0 * 1024.0) << " MB at peak\n";
+    std::cout << "Heap allocations per frame without streaming: "
+        << (quietFrames > 0 ? (double)quietAllocations / quietFrames : 0.0) << " over " << quietFrames << " frames\n";
+
+    if (!csvPath.empty())
+    {
+        std::ofstream output(csvPath, std::ios::trunc);
+        if (!output)
+        {
+            std::cout << "ERROR::FLYTHROUGH::FILE_NOT_OPENED\n" << csvPath << '\n';
+            return -1;
+        }
+        output << "frame,milliseconds,chunks_built,chunks_loaded,chunks_visible,chunks_pending,resident_bytes,heap_allocations\n";
+        for (size_t i = 0; i < rows.size(); i++)
+        {
+            const FrameRow& row = rows[i];
+            output << i << ',' << frameTimings.getSamples()[i] << ',' << row.ChunksBuilt << ',' << row.ChunksLoaded << ','
+                << row.ChunksVisible << ',' << row.ChunksPending << ',' << row.ResidentBytes << ','
+                << row.HeapAllocations << '\n';
+        }
+    }
+
+    if (!jsonPath.empty())
+    {
+        std::ofstream output(jsonPath, std::ios::trunc);
+        if (!output)
+        {
+            std::cout << "ERROR::FLYTHROUGH::FILE_NOT_OPENED\n" << jsonPath << '\n';
+            return -1;
+        }
+        output << "{\"seed\":" << seed << ",\"threads\":" << threadCount << ",\"path_length\":" << path.getLength()
+            << ",\"speed\":" << speed << ",\"frames\":" << frameCount << ",\n\"frame_ms\":";
+        writeSummaryJson(output, frameTimings);
+        output << ",\n\"hitch_threshold_ms\":" << hitchMilliseconds << ",\"hitches\":" << hitches
+            << ",\n\"streaming\":{\"chunks_built\":" << streamStats.ChunksBuilt - warmupBuilt
+            << ",\"chunks_unloaded\":" << streamStats.ChunksUnloaded << ",\"peak_chunks_loaded\":" << streamStats.PeakChunksLoaded
+            << ",\"latency_ms\":";
+        writeSummaryJson(output, latencyTimings);
+        output << "},\n\"memory\":{\"peak_resident_bytes\":" << peakResidentBytes << ",\"peak_tracked_bytes\":{";
+        for (int tag = 0; tag < MEMORY_TAG_COUNT; tag++)
+        {
+            output << (tag > 0 ? "," : "") << '"' << MemoryTracker::getTagName((MemoryTag)tag) << "\":"
+                << MemoryTracker::getStats((MemoryTag)tag).PeakBytes;
+        }
+        output << "},\"quiet_frames\":" << quietFrames << ",\"quiet_frame_heap_allocations\":" << quietAllocations << "}}\n";
+    }
+
+    if (!tracePath.empty())
+    {
+        Profiler::writeChromeTrace(tracePath);
+    }
+
+    if (maxP99 > 0.0 && frameTimings.getPercentile(99.0) > maxP99)
+    {
+        std::cout << "FAILED: p99 " << frameTimings.getPercentile(99.0) << " ms is over " << maxP99 << " ms\n";
+        return 1;
+    }
+    return 0;
+}
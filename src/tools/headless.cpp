@@ -0,0 +1,269 @@
+// headless.cpp
+//
+// Runs world generation, the chunk visibility and occluder rebuild and the
+// simulation loop without a window or GL context and reports the
+// throughput of each stage. There is no mesher yet, chunks are drawn with
+// placeholder mesh handles. Drawing goes through the null backend, so the
+// numbers are pure CPU cost.
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "utilities/FixedTimestep.h"
+#include "utilities/FrameArena.h"
+#include "utilities/FrameTimings.h"
+#include "utilities/HeapCounter.h"
+#include "utilities/JobSystem.h"
+#include "utilities/Profiler.h"
+#include "rendering/CaveCuller.h"
+#include "rendering/FrameExchange.h"
+#include "rendering/NullBackend.h"
+#include "rendering/OcclusionCuller.h"
+#include "rendering/RenderQueue.h"
+#include "world/World.h"
+#include "world/WorldGenerator.h"
+
+namespace
+{
+    double millisecondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    // --radius <chunks> and --layers <chunks> size the generated world,
+    // --ticks <count> simulation ticks are run, --timings <csv> writes
+    // their durations and --trace <json> the most recent profiler zones
+    int radius = 8;
+    int layers = 6;
+    int tickCount = 600;
+    int threadCount = (int)std::max(1u, std::thread::hardware_concurrency());
+    uint32_t seed = 1;
+    std::string timingsPath;
+    std::string tracePath;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        if (argument == "--radius" && i + 1 < argc)
+        {
+            radius = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (argument == "--layers" && i + 1 < argc)
+        {
+            layers = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (argument == "--ticks" && i + 1 < argc)
+        {
+            tickCount = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (argument == "--threads" && i + 1 < argc)
+        {
+            threadCount = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (argument == "--seed" && i + 1 < argc)
+        {
+            seed = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (argument == "--timings" && i + 1 < argc)
+        {
+            timingsPath = argv[++i];
+        }
+        else if (argument == "--trace" && i + 1 < argc)
+        {
+            tracePath = argv[++i];
+        }
+    }
+
+    Profiler::setThreadName("Main");
+    if (!tracePath.empty())
+    {
+        Profiler::beginCapture();
+    }
+    JobSystem jobs(threadCount);
+
+    World world;
+    WorldGenerator generator(seed);
+
+    std::vector<Chunk*> chunks;
+    for (int y = 0; y < layers; y++)
+    {
+        for (int z = -radius; z <= radius; z++)
+        {
+            for (int x = -radius; x <= radius; x++)
+            {
+                chunks.push_back(&world.createChunk(glm::ivec3(x, y, z)));
+            }
+        }
+    }
+    int chunkCount = (int)chunks.size();
+
+    // =============================
+    // Generation
+    //
+    auto generationStart = std::chrono::steady_clock::now();
+    jobs.parallelFor(chunkCount, [&](int begin, int end)
+    {
+        for (int i = begin; i < end; i++)
+        {
+            generator.generate(*chunks[i]);
+        }
+    });
+    double generationTime = millisecondsSince(generationStart);
+    Profiler::flush();
+
+    // =============================
+    // Visibility and occluders
+    //
+    // What the culling passes consume. Not meshing, the tree has no mesher.
+    auto rebuildStart = std::chrono::steady_clock::now();
+    jobs.parallelFor(chunkCount, [&](int begin, int end)
+    {
+        for (int i = begin; i < end; i++)
+        {
+            chunks[i]->rebuildVisibility();
+            chunks[i]->rebuildOccluders();
+        }
+    });
+    double rebuildTime = millisecondsSince(rebuildStart);
+    Profiler::flush();
+
+    std::cout << "Threads: " << threadCount << '\n';
+    std::cout << "Generated " << chunkCount << " chunks in " << generationTime << " ms ("
+        << chunkCount / (generationTime / 1000.0) << " chunks/s)\n";
+    std::cout << "Rebuilt visibility/occluders for " << chunkCount << " chunks in " << rebuildTime << " ms ("
+        << chunkCount / (rebuildTime / 1000.0) << " chunks/s)\n";
+
+    // =============================
+    // Simulation
+    //
+    // The camera circles the world just above the terrain. Every tick culls
+    // the chunks, records a draw packet for each visible one and hands the
+    // sorted queue to the null backend.
+    NullBackend backend;
+    backend.registerProgram("default", "default_vertex.glsl", "default_fragment.glsl", { "INSTANCED", "VERTEX_COLOR" });
+    ProgramHandle chunkProgram = backend.createProgram("default", {});
+    std::unordered_map<const Chunk*, MeshHandle> chunkMeshes;
+    for (const Chunk* chunk : chunks)
+    {
+        chunkMeshes[chunk] = backend.reserveMesh();
+    }
+
+    CaveCuller caveCuller;
+    OcclusionCuller occlusionCuller;
+    RenderQueue renderQueue(threadCount);
+    FrameArenas frameArenas(threadCount);
+    FixedTimestep timestep;
+    FrameSnapshot frame;
+    FrameTimings tickTimings;
+    tickTimings.reserve(tickCount);
+
+    glm::mat4 projectionMatrix = glm::perspective(glm::radians(70.0f), 16.0f / 9.0f, 0.1f, 500.0f);
+    float orbitRadius = radius * Chunk::Size * 0.5f;
+    size_t totalLoaded = 0;
+    size_t totalCaveVisible = 0;
+    size_t totalVisible = 0;
+    // The world never changes, so after the arenas and retained buffers have
+    // grown to fit, a tick should not touch the heap at all
+    const int warmupTicks = 8;
+    uint64_t steadyAllocations = 0;
+    uint64_t maxTickAllocations = 0;
+    // Blocks a frame arena took to fit a frame bigger than any before, the only expected allocations
+    uint64_t arenaGrowth = 0;
+
+    for (int tick = 0; tick < tickCount; tick++)
+    {
+        PROFILE_SCOPE("Simulation tick");
+        auto tickStart = std::chrono::steady_clock::now();
+        uint64_t allocationsBefore = getHeapAllocationCount();
+        uint64_t arenaBlocksBefore = frameArenas.getStats().BlockAllocations;
+        frameArenas.reset();
+
+        float angle = (float)(tick * timestep.getTickDelta()) * 0.25f;
+        glm::vec3 cameraPosition(std::cos(angle) * orbitRadius, 0.0f, std::sin(angle) * orbitRadius);
+        cameraPosition.y = std::min((float)(layers * Chunk::Size - 1),
+            (float)generator.getHeight((int)cameraPosition.x, (int)cameraPosition.z) + 6.0f);
+        glm::vec3 viewDirection = glm::normalize(glm::vec3(-std::sin(angle), -0.2f, std::cos(angle)));
+        glm::mat4 viewMatrix = glm::lookAt(cameraPosition, cameraPosition + viewDirection, glm::vec3(0.0f, 1.0f, 0.0f));
+
+        frame.reset();
+        frame.FrameIndex = tick;
+        frame.View = viewMatrix;
+        frame.Projection = projectionMatrix;
+        frame.CameraPosition = cameraPosition;
+
+        const std::vector<const Chunk*>& caveVisible = caveCuller.cull(world, cameraPosition, viewDirection, frameArenas.get(0));
+        const std::vector<const Chunk*>& visible = occlusionCuller.cull(caveVisible, cameraPosition, projectionMatrix * viewMatrix,
+            frameArenas.get(0), jobs);
+        totalLoaded += caveCuller.getStats().ChunksLoaded;
+        totalCaveVisible += caveVisible.size();
+        totalVisible += visible.size();
+
+        renderQueue.beginFrame(frameArenas);
+        renderQueue.record((int)visible.size(), jobs, [&](RenderQueue::Recorder& recorder, int index)
+        {
+            const Chunk* chunk = visible[index];
+            glm::vec3 center = (glm::vec3(chunk->Position) + 0.5f) * (float)Chunk::Size;
+
+            DrawPacket packet;
+            packet.Program = chunkProgram;
+            packet.Mesh = chunkMeshes.at(chunk);
+            packet.Model = glm::translate(glm::mat4(1.0f), glm::vec3(chunk->Position * Chunk::Size));
+            packet.Key = RenderQueue::makeKey(RenderQueue::PASS_OPAQUE, packet.Program, packet.Texture,
+                glm::length(center - cameraPosition));
+            recorder.submit(packet);
+        });
+        renderQueue.sort();
+
+        backend.beginFrame(frame);
+        backend.drawPackets(renderQueue.getSorted());
+        backend.endFrame();
+
+        // Part of every engine frame, so it is timed and counted like the rest
+        Profiler::flush();
+
+        tickTimings.record(millisecondsSince(tickStart));
+        if (tick >= warmupTicks)
+        {
+            uint64_t tickAllocations = getHeapAllocationCount() - allocationsBefore;
+            steadyAllocations += tickAllocations;
+            maxTickAllocations = std::max(maxTickAllocations, tickAllocations);
+            arenaGrowth += frameArenas.getStats().BlockAllocations - arenaBlocksBefore;
+        }
+    }
+
+    std::cout << "Visible chunks per tick: " << (double)totalCaveVisible / tickCount << " after cave culling, "
+        << (double)totalVisible / tickCount << " after occlusion culling, of " << (double)totalLoaded / tickCount << '\n';
+    std::cout << "Draw calls: " << backend.getTotalStats().DrawCalls << '\n';
+    if (tickCount > warmupTicks)
+    {
+        FrameArena::Stats arenaStats = frameArenas.getStats();
+        std::cout << "Heap allocations per tick after " << warmupTicks << " warm up ticks: "
+            << (double)steadyAllocations / (tickCount - warmupTicks) << " average, " << maxTickAllocations << " max, "
+            << steadyAllocations - arenaGrowth << " outside frame arena growth\n";
+        std::cout << "Frame arenas: " << arenaStats.PeakBytes / 1024.0 << " KB peak, " << arenaStats.CapacityBytes / 1024.0
+            << " KB reserved, " << arenaStats.BlockAllocations << " blocks allocated\n";
+    }
+    tickTimings.printSummary(std::cout, "Simulation");
+    backend.getPassTimings().printSummary(std::cout);
+    if (!timingsPath.empty())
+    {
+        tickTimings.writeCsv(timingsPath);
+    }
+    if (!tracePath.empty())
+    {
+        Profiler::writeChromeTrace(tracePath);
+    }
+
+    return 0;
+}
@@ -0,0 +1,83 @@
+// ArenaAllocator.h
+
+#ifndef ARENA_ALLOCATOR_H
+#define ARENA_ALLOCATOR_H
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#include "utilities/FrameArena.h"
+
+// Standard allocator that takes its memory from a FrameArena. Freeing is a
+// no-op, the memory comes back when the arena is reset, so a container must
+// not outlive the frame it was filled in. A default constructed allocator
+// has no arena and falls back to the heap, which lets containers exist
+// before their first frame.
+template <typename T>
+class ArenaAllocator
+{
+public:
+	typedef T value_type;
+
+	// Assigning or swapping containers moves the arena along with the memory
+	typedef std::true_type propagate_on_container_copy_assignment;
+	typedef std::true_type propagate_on_container_move_assignment;
+	typedef std::true_type propagate_on_container_swap;
+
+	ArenaAllocator() noexcept = default;
+
+	explicit ArenaAllocator(FrameArena& arena) noexcept
+		: arena(&arena)
+	{
+	}
+
+	template <typename U>
+	ArenaAllocator(const ArenaAllocator<U>& other) noexcept
+		: arena(other.getArena())
+	{
+	}
+
+	T* allocate(size_t count)
+	{
+		if (!arena)
+		{
+			return static_cast<T*>(::operator new(count * sizeof(T)));
+		}
+		return arena->allocateArray<T>(count);
+	}
+
+	void deallocate(T* pointer, size_t) noexcept
+	{
+		if (!arena)
+		{
+			::operator delete(pointer);
+		}
+	}
+
+	FrameArena* getArena() const noexcept
+	{
+		return arena;
+	}
+
+	template <typename U>
+	bool operator==(const ArenaAllocator<U>& other) const noexcept
+	{
+		return arena == other.getArena();
+	}
+
+	template <typename U>
+	bool operator!=(const ArenaAllocator<U>& other) const noexcept
+	{
+		return arena != other.getArena();
+	}
+
+private:
+	FrameArena* arena = nullptr;
+};
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+#endif
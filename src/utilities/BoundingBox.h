@@ -0,0 +1,31 @@
+// BoundingBox.h
+
+#ifndef BOUNDING_BOX_H
+#define BOUNDING_BOX_H
+
+#include <glm/glm.hpp>
+
+struct BoundingBox
+{
+	glm::vec3 Min;
+	glm::vec3 Max;
+
+	BoundingBox() : Min(0.0f), Max(0.0f) {}
+	BoundingBox(const glm::vec3& min, const glm::vec3& max) : Min(min), Max(max) {}
+
+	glm::vec3 getCorner(int index) const
+	{
+		return glm::vec3(
+			(index & 1) ? Max.x : Min.x,
+			(index & 2) ? Max.y : Min.y,
+			(index & 4) ? Max.z : Min.z);
+	}
+
+	float getVolume() const
+	{
+		glm::vec3 size = Max - Min;
+		return size.x * size.y * size.z;
+	}
+};
+
+#endif
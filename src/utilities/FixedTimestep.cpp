@@ -0,0 +1,67 @@
+// FixedTimestep.cpp
+
+#include "FixedTimestep.h"
+
+#include <algorithm>
+
+FixedTimestep::FixedTimestep(double tickRate, int maxTicksPerFrame)
+	: tickDelta(1.0), maxTicksPerFrame(1), accumulator(0.0), tick(0)
+{
+	setTickRate(tickRate);
+	setMaxTicksPerFrame(maxTicksPerFrame);
+}
+
+void FixedTimestep::setTickRate(double tickRate)
+{
+	tickDelta = 1.0 / std::max(tickRate, 1.0);
+}
+
+double FixedTimestep::getTickRate() const
+{
+	return 1.0 / tickDelta;
+}
+
+double FixedTimestep::getTickDelta() const
+{
+	return tickDelta;
+}
+
+void FixedTimestep::setMaxTicksPerFrame(int maxTicksPerFrame)
+{
+	this->maxTicksPerFrame = std::max(maxTicksPerFrame, 1);
+}
+
+int FixedTimestep::advance(double frameSeconds)
+{
+	accumulator += std::max(frameSeconds, 0.0);
+
+	int ticks = (int)std::min(accumulator / tickDelta, (double)maxTicksPerFrame);
+	accumulator -= ticks * tickDelta;
+
+	// Past the catch-up limit the backlog is dropped and the simulation runs slow instead
+	if (accumulator >= tickDelta)
+	{
+		uint64_t dropped = (uint64_t)(accumulator / tickDelta);
+		stats.TicksDropped += dropped;
+		accumulator -= dropped * tickDelta;
+	}
+
+	tick += ticks;
+	stats.TicksRun += ticks;
+	return ticks;
+}
+
+float FixedTimestep::getAlpha() const
+{
+	return (float)(accumulator / tickDelta);
+}
+
+uint64_t FixedTimestep::getTick() const
+{
+	return tick;
+}
+
+const FixedTimestep::Stats& FixedTimestep::getStats() const
+{
+	return stats;
+}
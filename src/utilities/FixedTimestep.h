@@ -0,0 +1,48 @@
+// FixedTimestep.h
+
+#ifndef FIXED_TIMESTEP_H
+#define FIXED_TIMESTEP_H
+
+#include <cstdint>
+
+// Turns variable frame times into a whole number of fixed simulation ticks.
+// Leftover time is exposed as an interpolation factor so rendering can
+// blend between the last two simulated states.
+class FixedTimestep
+{
+public:
+	struct Stats
+	{
+		uint64_t TicksRun = 0;
+		// Ticks thrown away because a frame needed more than MaxTicksPerFrame
+		uint64_t TicksDropped = 0;
+	};
+
+	explicit FixedTimestep(double tickRate = 60.0, int maxTicksPerFrame = 5);
+
+	void setTickRate(double tickRate);
+	double getTickRate() const;
+	double getTickDelta() const;
+
+	// Catch-up limit, keeps a slow simulation from falling further behind every frame
+	void setMaxTicksPerFrame(int maxTicksPerFrame);
+
+	// Adds the real time since the last frame and returns how many ticks to simulate
+	int advance(double frameSeconds);
+
+	// How far the current time is between the last tick and the next, in [0, 1)
+	float getAlpha() const;
+	uint64_t getTick() const;
+
+	const Stats& getStats() const;
+
+private:
+	double tickDelta;
+	int maxTicksPerFrame;
+	double accumulator;
+	uint64_t tick;
+
+	Stats stats;
+};
+
+#endif
@@ -0,0 +1,112 @@
+// FrameArena.cpp
+
+#include "FrameArena.h"
+
+#include <algorithm>
+
+namespace
+{
+	// Offset into base that is aligned in memory, not just relative to base
+	size_t alignOffset(const unsigned char* base, size_t offset, size_t alignment)
+	{
+		uintptr_t address = (uintptr_t)(base + offset);
+		uintptr_t aligned = (address + alignment - 1) & ~(uintptr_t)(alignment - 1);
+		return offset + (size_t)(aligned - address);
+	}
+}
+
+FrameArena::FrameArena(size_t blockBytes)
+{
+	addBlock(std::max<size_t>(blockBytes, 64));
+}
+
+void* FrameArena::allocate(size_t bytes, size_t alignment)
+{
+	Block* block = &blocks.back();
+	size_t start = alignOffset(block->Data.get(), offset, alignment);
+	if (start + bytes > block->Size)
+	{
+		// Double the total so a frame needs few extra blocks however much it grows
+		retiredBytes += offset;
+		addBlock(std::max(bytes + alignment, capacity));
+		block = &blocks.back();
+		start = alignOffset(block->Data.get(), 0, alignment);
+	}
+
+	offset = start + bytes;
+	return block->Data.get() + start;
+}
+
+void FrameArena::reset()
+{
+	peakBytes = std::max(peakBytes, retiredBytes + offset);
+
+	if (blocks.size() > 1)
+	{
+		blocks.clear();
+		size_t size = capacity;
+		capacity = 0;
+		addBlock(size);
+	}
+
+	offset = 0;
+	retiredBytes = 0;
+}
+
+FrameArena::Stats FrameArena::getStats() const
+{
+	Stats stats;
+	stats.UsedBytes = retiredBytes + offset;
+	stats.PeakBytes = std::max(peakBytes, stats.UsedBytes);
+	stats.CapacityBytes = capacity;
+	stats.BlockAllocations = blockAllocations;
+	return stats;
+}
+
+void FrameArena::addBlock(size_t size)
+{
+	blocks.push_back({ std::unique_ptr<unsigned char[]>(new unsigned char[size]), size });
+	offset = 0;
+	capacity += size;
+	blockAllocations++;
+}
+
+FrameArenas::FrameArenas(int threadCount, size_t blockBytes)
+{
+	for (int thread = 0; thread < std::max(1, threadCount); thread++)
+	{
+		arenas.push_back(std::make_unique<FrameArena>(blockBytes));
+	}
+}
+
+FrameArena& FrameArenas::get(int thread)
+{
+	return *arenas[thread];
+}
+
+int FrameArenas::getThreadCount() const
+{
+	return (int)arenas.size();
+}
+
+void FrameArenas::reset()
+{
+	for (std::unique_ptr<FrameArena>& arena : arenas)
+	{
+		arena->reset();
+	}
+}
+
+FrameArena::Stats FrameArenas::getStats() const
+{
+	FrameArena::Stats total;
+	for (const std::unique_ptr<FrameArena>& arena : arenas)
+	{
+		FrameArena::Stats stats = arena->getStats();
+		total.UsedBytes += stats.UsedBytes;
+		total.PeakBytes += stats.PeakBytes;
+		total.CapacityBytes += stats.CapacityBytes;
+		total.BlockAllocations += stats.BlockAllocations;
+	}
+	return total;
+}
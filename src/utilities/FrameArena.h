@@ -0,0 +1,90 @@
+// FrameArena.h
+
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Bump allocator for data that only lives until the end of the frame.
+// Allocating moves a pointer and nothing is freed on its own, reset()
+// rewinds to the start. A frame that outgrows the block carries on in
+// extra blocks, and the next reset swaps them all for one block big enough
+// for that frame, so a steady frame loop stops allocating after a few frames.
+// Not thread safe, give each thread its own arena (see FrameArenas).
+class alignas(64) FrameArena
+{
+public:
+	static const size_t DefaultBlockBytes = 64 * 1024;
+
+	struct Stats
+	{
+		size_t UsedBytes = 0;
+		// Most bytes used in any one frame
+		size_t PeakBytes = 0;
+		size_t CapacityBytes = 0;
+		// Blocks taken from the heap over the arena's lifetime
+		uint64_t BlockAllocations = 0;
+	};
+
+	explicit FrameArena(size_t blockBytes = DefaultBlockBytes);
+
+	FrameArena(const FrameArena&) = delete;
+	FrameArena& operator=(const FrameArena&) = delete;
+
+	// Alignment must be a power of two
+	void* allocate(size_t bytes, size_t alignment);
+
+	template <typename T>
+	T* allocateArray(size_t count)
+	{
+		return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+	}
+
+	// Everything allocated since the last reset becomes invalid
+	void reset();
+
+	Stats getStats() const;
+
+private:
+	struct Block
+	{
+		std::unique_ptr<unsigned char[]> Data;
+		size_t Size;
+	};
+
+	std::vector<Block> blocks;
+	// Write position in the last block
+	size_t offset = 0;
+	// Bytes handed out from blocks before the last one this frame
+	size_t retiredBytes = 0;
+	size_t capacity = 0;
+	size_t peakBytes = 0;
+	uint64_t blockAllocations = 0;
+
+	void addBlock(size_t size);
+};
+
+// One arena per thread, so workers allocate without sharing a bump pointer.
+// Thread 0 is the thread that owns the frame.
+class FrameArenas
+{
+public:
+	explicit FrameArenas(int threadCount, size_t blockBytes = FrameArena::DefaultBlockBytes);
+
+	FrameArena& get(int thread);
+	int getThreadCount() const;
+
+	// Call once per frame while no thread is allocating
+	void reset();
+
+	// Summed over every thread, PeakBytes is the sum of each arena's peak
+	FrameArena::Stats getStats() const;
+
+private:
+	std::vector<std::unique_ptr<FrameArena>> arenas;
+};
+
+#endif
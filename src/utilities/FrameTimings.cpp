@@ -0,0 +1,107 @@
+// FrameTimings.cpp
+
+#include "FrameTimings.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+void FrameTimings::reserve(size_t frameCount)
+{
+	samples.reserve(frameCount);
+}
+
+void FrameTimings::record(double milliseconds)
+{
+	samples.push_back(milliseconds);
+}
+
+void FrameTimings::clear()
+{
+	samples.clear();
+}
+
+size_t FrameTimings::getCount() const
+{
+	return samples.size();
+}
+
+const std::vector<double>& FrameTimings::getSamples() const
+{
+	return samples;
+}
+
+double FrameTimings::getAverage() const
+{
+	if (samples.empty())
+	{
+		return 0.0;
+	}
+
+	double total = 0.0;
+	for (double sample : samples)
+	{
+		total += sample;
+	}
+	return total / samples.size();
+}
+
+double FrameTimings::getMin() const
+{
+	return samples.empty() ? 0.0 : *std::min_element(samples.begin(), samples.end());
+}
+
+double FrameTimings::getMax() const
+{
+	return samples.empty() ? 0.0 : *std::max_element(samples.begin(), samples.end());
+}
+
+double FrameTimings::getPercentile(double percentile) const
+{
+	if (samples.empty())
+	{
+		return 0.0;
+	}
+
+	percentile = std::min(std::max(percentile, 0.0), 100.0);
+	size_t rank = (size_t)std::ceil(percentile / 100.0 * samples.size());
+	size_t index = rank > 0 ? rank - 1 : 0;
+
+	std::vector<double> sorted(samples);
+	std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+	return sorted[index];
+}
+
+size_t FrameTimings::getCountAbove(double milliseconds) const
+{
+	return (size_t)std::count_if(samples.begin(), samples.end(), [milliseconds](double sample)
+	{
+		return sample > milliseconds;
+	});
+}
+
+bool FrameTimings::writeCsv(const std::string& path) const
+{
+	std::ofstream output(path, std::ios::trunc);
+	if (!output)
+	{
+		std::cout << "ERROR::FRAME_TIMINGS::FILE_NOT_OPENED\n" << path << '\n';
+		return false;
+	}
+
+	output << "frame,milliseconds\n";
+	for (size_t i = 0; i < samples.size(); i++)
+	{
+		output << i << ',' << samples[i] << '\n';
+	}
+	return (bool)output;
+}
+
+void FrameTimings::printSummary(std::ostream& output, const std::string& label) const
+{
+	output << label << ": " << samples.size() << " frames, avg " << getAverage()
+		<< " ms, min " << getMin() << " ms, p50 " << getPercentile(50.0)
+		<< " ms, p95 " << getPercentile(95.0) << " ms, p99 " << getPercentile(99.0)
+		<< " ms, max " << getMax() << " ms\n";
+}
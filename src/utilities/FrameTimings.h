@@ -0,0 +1,41 @@
+// FrameTimings.h
+
+#ifndef FRAME_TIMINGS_H
+#define FRAME_TIMINGS_H
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Per-frame durations of a benchmark run in milliseconds, with summary statistics
+class FrameTimings
+{
+public:
+	void reserve(size_t frameCount);
+	void record(double milliseconds);
+	void clear();
+
+	size_t getCount() const;
+	const std::vector<double>& getSamples() const;
+
+	double getAverage() const;
+	double getMin() const;
+	double getMax() const;
+
+	// Nearest-rank percentile, percentile in [0, 100]
+	double getPercentile(double percentile) const;
+
+	// Frames slower than milliseconds, i.e. hitches
+	size_t getCountAbove(double milliseconds) const;
+
+	// One "frame,milliseconds" row per frame
+	bool writeCsv(const std::string& path) const;
+
+	void printSummary(std::ostream& output, const std::string& label) const;
+
+private:
+	std::vector<double> samples;
+};
+
+#endif
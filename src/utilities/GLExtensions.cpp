@@ -0,0 +1,62 @@
+// GLExtensions.cpp
+
+#include "GLExtensions.h"
+
+#include <cstring>
+
+bool GLExtensions::ProgramBinary = false;
+bool GLExtensions::ParallelShaderCompile = false;
+
+PFNVXGETPROGRAMBINARYPROC GLExtensions::GetProgramBinary = nullptr;
+PFNVXPROGRAMBINARYPROC GLExtensions::ProgramBinaryLoad = nullptr;
+PFNVXPROGRAMPARAMETERIPROC GLExtensions::ProgramParameteri = nullptr;
+PFNVXMAXSHADERCOMPILERTHREADSPROC GLExtensions::MaxShaderCompilerThreads = nullptr;
+
+bool GLExtensions::isSupported(const char* extension)
+{
+	GLint extensionCount = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+
+	for (GLint i = 0; i < extensionCount; i++)
+	{
+		const char* name = (const char*)glGetStringi(GL_EXTENSIONS, i);
+		if (name && std::strcmp(name, extension) == 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void GLExtensions::load(GLADloadproc loader)
+{
+	// Program binaries
+	if (GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 1) || isSupported("GL_ARB_get_program_binary"))
+	{
+		GetProgramBinary = (PFNVXGETPROGRAMBINARYPROC)loader("glGetProgramBinary");
+		ProgramBinaryLoad = (PFNVXPROGRAMBINARYPROC)loader("glProgramBinary");
+		ProgramParameteri = (PFNVXPROGRAMPARAMETERIPROC)loader("glProgramParameteri");
+
+		GLint formatCount = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+
+		ProgramBinary = GetProgramBinary && ProgramBinaryLoad && ProgramParameteri && formatCount > 0;
+	}
+
+	// Parallel shader compilation
+	if (isSupported("GL_KHR_parallel_shader_compile"))
+	{
+		MaxShaderCompilerThreads = (PFNVXMAXSHADERCOMPILERTHREADSPROC)loader("glMaxShaderCompilerThreadsKHR");
+	}
+	else if (isSupported("GL_ARB_parallel_shader_compile"))
+	{
+		MaxShaderCompilerThreads = (PFNVXMAXSHADERCOMPILERTHREADSPROC)loader("glMaxShaderCompilerThreadsARB");
+	}
+
+	ParallelShaderCompile = MaxShaderCompilerThreads != nullptr;
+	if (ParallelShaderCompile)
+	{
+		// Let the driver use as many threads as it likes
+		MaxShaderCompilerThreads(0xFFFFFFFFu);
+	}
+}
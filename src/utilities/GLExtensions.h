@@ -0,0 +1,45 @@
+// GLExtensions.h
+
+#ifndef GL_EXTENSIONS_H
+#define GL_EXTENSIONS_H
+
+#include <glad/glad.h>
+
+// glad only loads core 3.3, so the few newer entry points the engine can
+// take advantage of are loaded here when the driver offers them.
+
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+typedef void (APIENTRYP PFNVXGETPROGRAMBINARYPROC)(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+typedef void (APIENTRYP PFNVXPROGRAMBINARYPROC)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+typedef void (APIENTRYP PFNVXPROGRAMPARAMETERIPROC)(GLuint program, GLenum pname, GLint value);
+typedef void (APIENTRYP PFNVXMAXSHADERCOMPILERTHREADSPROC)(GLuint count);
+
+class GLExtensions
+{
+public:
+	// GL 4.1 or ARB_get_program_binary with at least one binary format
+	static bool ProgramBinary;
+	// KHR_parallel_shader_compile or ARB_parallel_shader_compile
+	static bool ParallelShaderCompile;
+
+	static PFNVXGETPROGRAMBINARYPROC GetProgramBinary;
+	static PFNVXPROGRAMBINARYPROC ProgramBinaryLoad;
+	static PFNVXPROGRAMPARAMETERIPROC ProgramParameteri;
+	static PFNVXMAXSHADERCOMPILERTHREADSPROC MaxShaderCompilerThreads;
+
+	// Call once after gladLoadGLLoader with the same loader
+	static void load(GLADloadproc loader);
+
+	static bool isSupported(const char* extension);
+};
+
+#endif
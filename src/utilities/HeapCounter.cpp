@@ -0,0 +1,31 @@
+// HeapCounter.cpp
+
+#include "HeapCounter.h"
+
+#include <atomic>
+
+namespace
+{
+	std::atomic<uint64_t> allocationCount{ 0 };
+	std::atomic<uint64_t> freeCount{ 0 };
+}
+
+uint64_t getHeapAllocationCount()
+{
+	return allocationCount.load(std::memory_order_relaxed);
+}
+
+uint64_t getHeapFreeCount()
+{
+	return freeCount.load(std::memory_order_relaxed);
+}
+
+void countHeapAllocation()
+{
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void countHeapFree()
+{
+	freeCount.fetch_add(1, std::memory_order_relaxed);
+}
@@ -0,0 +1,20 @@
+// HeapCounter.h
+
+#ifndef HEAP_COUNTER_H
+#define HEAP_COUNTER_H
+
+#include <cstdint>
+
+// Calls to the global operator new and delete since the program started.
+// The counting operators are in HeapCounterHooks.cpp, outside voxelcore, so
+// only programs that link the voxel_heap_counter objects are counted; in
+// any other program both counts stay 0. Allocations made straight through
+// malloc, such as the GL driver's, are not seen.
+uint64_t getHeapAllocationCount();
+uint64_t getHeapFreeCount();
+
+// Called by the counting operators
+void countHeapAllocation();
+void countHeapFree();
+
+#endif
@@ -0,0 +1,135 @@
+// HeapCounterHooks.cpp
+//
+// Replaces the global operator new and delete with versions that count
+// every call for getHeapAllocationCount. Not part of voxelcore, since a
+// replacement applies to the whole program: executables opt in by linking
+// the voxel_heap_counter objects.
+
+#include <cstdlib>
+#include <new>
+
+#include "utilities/HeapCounter.h"
+
+namespace
+{
+	void* allocateCounted(size_t size)
+	{
+		countHeapAllocation();
+		return std::malloc(size > 0 ? size : 1);
+	}
+
+	void* allocateAlignedCounted(size_t size, std::align_val_t alignment)
+	{
+		countHeapAllocation();
+		size_t alignmentBytes = (size_t)alignment;
+#ifdef _WIN32
+		return _aligned_malloc(size > 0 ? size : 1, alignmentBytes);
+#else
+		// aligned_alloc wants the size to be a multiple of the alignment
+		size_t roundedSize = (size + alignmentBytes - 1) / alignmentBytes * alignmentBytes;
+		return std::aligned_alloc(alignmentBytes, roundedSize > 0 ? roundedSize : alignmentBytes);
+#endif
+	}
+
+	void freeCounted(void* pointer)
+	{
+		if (pointer)
+		{
+			countHeapFree();
+			std::free(pointer);
+		}
+	}
+
+	void freeAlignedCounted(void* pointer)
+	{
+		if (pointer)
+		{
+			countHeapFree();
+#ifdef _WIN32
+			_aligned_free(pointer);
+#else
+			std::free(pointer);
+#endif
+		}
+	}
+}
+
+void* operator new(size_t size)
+{
+	void* pointer = allocateCounted(size);
+	if (!pointer)
+	{
+		throw std::bad_alloc();
+	}
+	return pointer;
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	return allocateCounted(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	return allocateCounted(size);
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+	void* pointer = allocateAlignedCounted(size, alignment);
+	if (!pointer)
+	{
+		throw std::bad_alloc();
+	}
+	return pointer;
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+	return operator new(size, alignment);
+}
+
+void operator delete(void* pointer) noexcept
+{
+	freeCounted(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+	freeCounted(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept
+{
+	freeCounted(pointer);
+}
+
+void operator delete[](void* pointer, size_t) noexcept
+{
+	freeCounted(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept
+{
+	freeAlignedCounted(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t) noexcept
+{
+	freeAlignedCounted(pointer);
+}
+
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept
+{
+	freeAlignedCounted(pointer);
+}
+
+void operator delete[](void* pointer, size_t, std::align_val_t) noexcept
+{
+	freeAlignedCounted(pointer);
+}
@@ -0,0 +1,336 @@
+// JobSystem.cpp
+
+#include "JobSystem.h"
+
+#include <string>
+
+#include "utilities/MemoryTracker.h"
+#include "utilities/Profiler.h"
+
+namespace
+{
+	// Failed searches before an idle worker goes to sleep
+	const int IDLE_SPINS = 64;
+
+	// Which system and worker the calling thread belongs to
+	struct CurrentWorker
+	{
+		const JobSystem* System = nullptr;
+		int Index = -1;
+	};
+
+	thread_local CurrentWorker currentWorker;
+}
+
+JobSystem::JobSystem(int workerCount)
+{
+	if (workerCount <= 0)
+	{
+		workerCount = (int)std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	for (int worker = 0; worker < workerCount; worker++)
+	{
+		std::unique_ptr<Worker> state = std::make_unique<Worker>();
+		for (int priority = 0; priority < JOB_PRIORITY_COUNT; priority++)
+		{
+			state->Queues[priority] = std::make_unique<WorkStealingDeque<Job>>((size_t)JobPoolSize);
+		}
+		state->Pool.reset(new Job[JobPoolSize]);
+		workers.push_back(std::move(state));
+	}
+
+	for (SharedQueue& queue : sharedQueues)
+	{
+		queue.Jobs.resize(JobPoolSize);
+	}
+	sharedPool.reset(new Job[JobPoolSize]);
+
+	trackedBytes = (size_t)workerCount * (sizeof(Worker) + JobPoolSize * (sizeof(Job) + JOB_PRIORITY_COUNT * sizeof(Job*)))
+		+ JobPoolSize * (sizeof(Job) + JOB_PRIORITY_COUNT * sizeof(Job*));
+	MemoryTracker::add(MEMORY_JOBS, trackedBytes);
+
+	// The creating thread is worker 0 and only runs jobs while it waits
+	previousSystem = currentWorker.System;
+	previousWorker = currentWorker.Index;
+	currentWorker.System = this;
+	currentWorker.Index = 0;
+	for (int worker = 1; worker < workerCount; worker++)
+	{
+		workers[worker]->Thread = std::thread(&JobSystem::workerLoop, this, worker);
+	}
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		stopping.store(true);
+	}
+	wakeCondition.notify_all();
+
+	for (std::unique_ptr<Worker>& worker : workers)
+	{
+		if (worker->Thread.joinable())
+		{
+			worker->Thread.join();
+		}
+	}
+
+	if (currentWorker.System == this)
+	{
+		currentWorker.System = previousSystem;
+		currentWorker.Index = previousWorker;
+	}
+	MemoryTracker::remove(MEMORY_JOBS, trackedBytes);
+}
+
+void JobSystem::wait(JobCounter& counter)
+{
+	while (!counter.isDone())
+	{
+		if (!runOne())
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	// The last job may still be releasing the lock after its count reached zero
+	std::lock_guard<std::mutex> lock(counter.mutex);
+}
+
+int JobSystem::getWorkerCount() const
+{
+	return (int)workers.size();
+}
+
+int JobSystem::getCurrentWorker() const
+{
+	return currentWorker.System == this ? currentWorker.Index : -1;
+}
+
+int JobSystem::getQueuedCount() const
+{
+	return std::max(0, queuedJobs.load(std::memory_order_relaxed));
+}
+
+JobSystem::Stats JobSystem::getStats() const
+{
+	Stats stats;
+	stats.JobsRun = sharedJobsRun.load(std::memory_order_relaxed);
+	for (const std::unique_ptr<Worker>& worker : workers)
+	{
+		stats.JobsRun += worker->JobsRun.load(std::memory_order_relaxed);
+		stats.JobsStolen += worker->JobsStolen.load(std::memory_order_relaxed);
+	}
+	return stats;
+}
+
+Job* JobSystem::allocateJob()
+{
+	int worker = getCurrentWorker();
+	while (true)
+	{
+		Job* job = worker >= 0
+			? &workers[worker]->Pool[workers[worker]->NextJob++ % JobPoolSize]
+			: &sharedPool[nextSharedJob.fetch_add(1, std::memory_order_relaxed) % JobPoolSize];
+
+		// Outside threads share a pool, so two of them can wrap onto the same slot
+		bool active = false;
+		if (job->Active.compare_exchange_strong(active, true, std::memory_order_acquire, std::memory_order_relaxed))
+		{
+			return job;
+		}
+
+		// Only happens with a full pool of jobs in flight, help until one is done
+		if (!runOne())
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+void JobSystem::submit(Job* job, JobCounter* dependency)
+{
+	if (dependency)
+	{
+		std::unique_lock<std::mutex> lock(dependency->mutex);
+		if (!dependency->isDone())
+		{
+			job->Next = dependency->continuations;
+			dependency->continuations = job;
+			return;
+		}
+	}
+	enqueue(job);
+}
+
+void JobSystem::enqueue(Job* job)
+{
+	// Counted before it can be taken, so the count never goes negative
+	queuedJobs.fetch_add(1, std::memory_order_seq_cst);
+
+	int worker = getCurrentWorker();
+	if (!(worker >= 0 && workers[worker]->Queues[job->Priority]->push(job)) && !pushShared(job))
+	{
+		// Every queue is full, which means the pools are too. Running it here is always correct.
+		queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+		execute(job, worker);
+		return;
+	}
+
+	// Pairs with the check of queuedJobs under sleepMutex in workerLoop, so a wake up is never lost
+	if (sleepingWorkers.load(std::memory_order_seq_cst) > 0)
+	{
+		{
+			std::lock_guard<std::mutex> lock(sleepMutex);
+		}
+		wakeCondition.notify_one();
+	}
+}
+
+bool JobSystem::pushShared(Job* job)
+{
+	std::lock_guard<std::mutex> lock(sharedMutex);
+	SharedQueue& queue = sharedQueues[job->Priority];
+	if (queue.Count == queue.Jobs.size())
+	{
+		return false;
+	}
+	queue.Jobs[(queue.Head + queue.Count) % queue.Jobs.size()] = job;
+	queue.Count++;
+	return true;
+}
+
+Job* JobSystem::popShared(int priority)
+{
+	std::lock_guard<std::mutex> lock(sharedMutex);
+	SharedQueue& queue = sharedQueues[priority];
+	if (queue.Count == 0)
+	{
+		return nullptr;
+	}
+	Job* job = queue.Jobs[queue.Head];
+	queue.Head = (queue.Head + 1) % queue.Jobs.size();
+	queue.Count--;
+	return job;
+}
+
+Job* JobSystem::takeJob(int worker)
+{
+	int workerCount = getWorkerCount();
+	for (int priority = 0; priority < JOB_PRIORITY_COUNT; priority++)
+	{
+		Job* job = worker >= 0 ? workers[worker]->Queues[priority]->pop() : nullptr;
+		if (!job)
+		{
+			job = popShared(priority);
+		}
+
+		// Start with the next worker along, so thieves spread out over the victims
+		for (int offset = 1; !job && offset <= workerCount; offset++)
+		{
+			int victim = (std::max(worker, 0) + offset) % workerCount;
+			if (victim != worker)
+			{
+				job = workers[victim]->Queues[priority]->steal();
+				if (job && worker >= 0)
+				{
+					workers[worker]->JobsStolen.fetch_add(1, std::memory_order_relaxed);
+				}
+			}
+		}
+
+		if (job)
+		{
+			queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+			return job;
+		}
+	}
+	return nullptr;
+}
+
+bool JobSystem::runOne()
+{
+	int worker = getCurrentWorker();
+	Job* job = takeJob(worker);
+	if (!job)
+	{
+		return false;
+	}
+	execute(job, worker);
+	return true;
+}
+
+void JobSystem::execute(Job* job, int worker)
+{
+	job->Function(*job);
+
+	JobCounter* counter = job->Counter;
+	job->Active.store(false, std::memory_order_release);
+	if (counter)
+	{
+		finish(counter);
+	}
+
+	if (worker >= 0)
+	{
+		workers[worker]->JobsRun.fetch_add(1, std::memory_order_relaxed);
+	}
+	else
+	{
+		sharedJobsRun.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+void JobSystem::finish(JobCounter* counter)
+{
+	Job* ready = nullptr;
+	{
+		std::lock_guard<std::mutex> lock(counter->mutex);
+		if (counter->pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			ready = counter->continuations;
+			counter->continuations = nullptr;
+		}
+	}
+
+	while (ready)
+	{
+		Job* next = ready->Next;
+		enqueue(ready);
+		ready = next;
+	}
+}
+
+void JobSystem::workerLoop(int worker)
+{
+	currentWorker.System = this;
+	currentWorker.Index = worker;
+	Profiler::setThreadName("Worker " + std::to_string(worker));
+
+	int idleSpins = 0;
+	while (!stopping.load(std::memory_order_relaxed))
+	{
+		if (runOne())
+		{
+			idleSpins = 0;
+			continue;
+		}
+
+		if (++idleSpins < IDLE_SPINS)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		sleepingWorkers.fetch_add(1, std::memory_order_seq_cst);
+		wakeCondition.wait(lock, [&]()
+		{
+			return stopping.load(std::memory_order_relaxed) || queuedJobs.load(std::memory_order_seq_cst) > 0;
+		});
+		sleepingWorkers.fetch_sub(1, std::memory_order_relaxed);
+		idleSpins = 0;
+	}
+}
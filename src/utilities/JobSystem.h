@@ -0,0 +1,252 @@
+// JobSystem.h
+
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "utilities/WorkStealingDeque.h"
+
+// Jobs of a higher priority are always taken first, from any queue
+enum JobPriority
+{
+	JOB_PRIORITY_HIGH = 0,
+	JOB_PRIORITY_NORMAL,
+	JOB_PRIORITY_LOW,
+	JOB_PRIORITY_COUNT
+};
+
+class JobCounter;
+
+// One unit of work. Jobs live in fixed pools inside the JobSystem, the
+// task they run is copied into Storage so scheduling never allocates.
+struct Job
+{
+	static const size_t StorageBytes = 64;
+
+	void (*Function)(Job& job) = nullptr;
+	JobCounter* Counter = nullptr;
+	// Next job waiting on the same dependency
+	Job* Next = nullptr;
+	JobPriority Priority = JOB_PRIORITY_NORMAL;
+	// Set from scheduling until the job has finished, so its slot is not reused early
+	std::atomic<bool> Active{ false };
+	alignas(16) unsigned char Storage[StorageBytes];
+};
+
+// Counts jobs that have not finished yet. Pass one when scheduling to wait
+// for the jobs, or as another job's dependency to run that job after them.
+// A counter must outlive every job counted on it or waiting on it.
+class JobCounter
+{
+public:
+	JobCounter() = default;
+
+	JobCounter(const JobCounter&) = delete;
+	JobCounter& operator=(const JobCounter&) = delete;
+
+	bool isDone() const
+	{
+		return pending.load(std::memory_order_acquire) == 0;
+	}
+
+	int getPending() const
+	{
+		return pending.load(std::memory_order_acquire);
+	}
+
+private:
+	friend class JobSystem;
+
+	std::atomic<int> pending{ 0 };
+	// Guards continuations, and is held while the last job finishes
+	std::mutex mutex;
+	Job* continuations = nullptr;
+};
+
+// Work-stealing job system with one worker per core. The thread that
+// creates it is worker 0 and runs jobs whenever it waits, the others are
+// dedicated threads. Every worker has a Chase-Lev deque per priority: it
+// pushes and pops its own jobs at one end while idle workers steal from the
+// other. Threads outside the system queue into a shared list instead and
+// help out the same way when they wait.
+class JobSystem
+{
+public:
+	// Jobs each thread can have in flight at once
+	static const int JobPoolSize = 4096;
+	// Ranges parallelFor makes per worker by default, enough to even out uneven work
+	static const int BatchesPerWorker = 4;
+
+	struct Stats
+	{
+		uint64_t JobsRun = 0;
+		// Of those, jobs taken from another worker's deque
+		uint64_t JobsStolen = 0;
+	};
+
+	// workerCount 0 uses one worker per hardware thread
+	explicit JobSystem(int workerCount = 0);
+	~JobSystem();
+
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	// Queues task() to run on any worker. counter, if given, counts the job
+	// until it has finished. With a dependency the job does not start before
+	// that counter reaches zero. The task is copied into the job, so it must
+	// be trivially copyable and fit in Job::StorageBytes; capture pointers to
+	// anything bigger.
+	template <typename Task>
+	void run(const Task& task, JobCounter* counter = nullptr, JobPriority priority = JOB_PRIORITY_NORMAL,
+		JobCounter* dependency = nullptr);
+
+	// Runs queued jobs on the calling thread until counter reaches zero
+	void wait(JobCounter& counter);
+
+	// Splits [0, count) into batchCount contiguous ranges (0 picks a count
+	// from the worker count) and calls task(begin, end), or
+	// task(begin, end, batch), for each of them across the workers. Returns
+	// once every range is done, the calling thread takes ranges too.
+	template <typename Task>
+	void parallelFor(int count, const Task& task, int batchCount = 0, JobPriority priority = JOB_PRIORITY_HIGH);
+
+	int getWorkerCount() const;
+
+	// The calling thread's worker index, or -1 for threads outside the system
+	int getCurrentWorker() const;
+
+	// Jobs queued but not started, dependencies still waiting are not counted
+	int getQueuedCount() const;
+
+	Stats getStats() const;
+
+private:
+	struct alignas(64) Worker
+	{
+		std::unique_ptr<WorkStealingDeque<Job>> Queues[JOB_PRIORITY_COUNT];
+		std::unique_ptr<Job[]> Pool;
+		uint32_t NextJob = 0;
+		std::thread Thread;
+		std::atomic<uint64_t> JobsRun{ 0 };
+		std::atomic<uint64_t> JobsStolen{ 0 };
+	};
+
+	// Fixed size FIFO for jobs from outside threads, or from a worker whose deque is full
+	struct SharedQueue
+	{
+		std::vector<Job*> Jobs;
+		size_t Head = 0;
+		size_t Count = 0;
+	};
+
+	std::vector<std::unique_ptr<Worker>> workers;
+
+	std::mutex sharedMutex;
+	SharedQueue sharedQueues[JOB_PRIORITY_COUNT];
+	std::unique_ptr<Job[]> sharedPool;
+	std::atomic<uint32_t> nextSharedJob{ 0 };
+	std::atomic<uint64_t> sharedJobsRun{ 0 };
+
+	std::atomic<int> queuedJobs{ 0 };
+	std::atomic<int> sleepingWorkers{ 0 };
+	std::atomic<bool> stopping{ false };
+	std::mutex sleepMutex;
+	std::condition_variable wakeCondition;
+
+	size_t trackedBytes = 0;
+	// The creating thread's worker identity before this system, put back on destruction
+	const JobSystem* previousSystem = nullptr;
+	int previousWorker = -1;
+
+	Job* allocateJob();
+	void submit(Job* job, JobCounter* dependency);
+	void enqueue(Job* job);
+	bool pushShared(Job* job);
+	Job* popShared(int priority);
+	Job* takeJob(int worker);
+	bool runOne();
+	void execute(Job* job, int worker);
+	void finish(JobCounter* counter);
+	void workerLoop(int worker);
+};
+
+template <typename Task>
+void JobSystem::run(const Task& task, JobCounter* counter, JobPriority priority, JobCounter* dependency)
+{
+	static_assert(sizeof(Task) <= Job::StorageBytes && alignof(Task) <= 16, "Task too big for Job::Storage");
+	static_assert(std::is_trivially_copy_constructible<Task>::value && std::is_trivially_destructible<Task>::value,
+		"Tasks are copied into the job and never destroyed");
+
+	Job* job = allocateJob();
+	new (job->Storage) Task(task);
+	job->Function = [](Job& job)
+	{
+		(*std::launder(reinterpret_cast<Task*>(job.Storage)))();
+	};
+	job->Counter = counter;
+	job->Priority = priority;
+	job->Next = nullptr;
+	if (counter)
+	{
+		counter->pending.fetch_add(1, std::memory_order_relaxed);
+	}
+	submit(job, dependency);
+}
+
+template <typename Task>
+void JobSystem::parallelFor(int count, const Task& task, int batchCount, JobPriority priority)
+{
+	if (count <= 0)
+	{
+		return;
+	}
+	if (batchCount <= 0)
+	{
+		batchCount = getWorkerCount() * BatchesPerWorker;
+	}
+	batchCount = std::min(batchCount, count);
+
+	auto runBatch = [&task, count, batchCount](int batch)
+	{
+		int begin = (int)((int64_t)count * batch / batchCount);
+		int end = (int)((int64_t)count * (batch + 1) / batchCount);
+		if constexpr (std::is_invocable<const Task&, int, int, int>::value)
+		{
+			task(begin, end, batch);
+		}
+		else
+		{
+			task(begin, end);
+		}
+	};
+
+	if (batchCount == 1 || getWorkerCount() == 1)
+	{
+		for (int batch = 0; batch < batchCount; batch++)
+		{
+			runBatch(batch);
+		}
+		return;
+	}
+
+	JobCounter counter;
+	for (int batch = 1; batch < batchCount; batch++)
+	{
+		run([&runBatch, batch]() { runBatch(batch); }, &counter, priority);
+	}
+	runBatch(0);
+	wait(counter);
+}
+
+#endif
@@ -0,0 +1,152 @@
+// MappedFile.cpp
+
+#include "MappedFile.h"
+
+#include "utilities/MemoryTracker.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile()
+	: data(nullptr), size(0), fileHandle(INVALID_HANDLE_VALUE), mappingHandle(nullptr)
+{
+}
+
+bool MappedFile::open(const std::string& path)
+{
+	close();
+
+	fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (fileHandle == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0)
+	{
+		close();
+		return false;
+	}
+
+	mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mappingHandle)
+	{
+		close();
+		return false;
+	}
+
+	data = (const unsigned char*)MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+	if (!data)
+	{
+		close();
+		return false;
+	}
+
+	size = (size_t)fileSize.QuadPart;
+	MemoryTracker::add(MEMORY_IO, size);
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (data)
+	{
+		UnmapViewOfFile(data);
+		MemoryTracker::remove(MEMORY_IO, size);
+	}
+	if (mappingHandle)
+	{
+		CloseHandle(mappingHandle);
+	}
+	if (fileHandle != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(fileHandle);
+	}
+
+	data = nullptr;
+	size = 0;
+	mappingHandle = nullptr;
+	fileHandle = INVALID_HANDLE_VALUE;
+}
+
+#else
+
+MappedFile::MappedFile()
+	: data(nullptr), size(0), fileDescriptor(-1)
+{
+}
+
+bool MappedFile::open(const std::string& path)
+{
+	close();
+
+	fileDescriptor = ::open(path.c_str(), O_RDONLY);
+	if (fileDescriptor < 0)
+	{
+		return false;
+	}
+
+	struct stat fileStatus;
+	if (fstat(fileDescriptor, &fileStatus) != 0 || fileStatus.st_size == 0)
+	{
+		close();
+		return false;
+	}
+
+	void* mapping = mmap(nullptr, (size_t)fileStatus.st_size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+	if (mapping == MAP_FAILED)
+	{
+		close();
+		return false;
+	}
+
+	data = (const unsigned char*)mapping;
+	size = (size_t)fileStatus.st_size;
+	MemoryTracker::add(MEMORY_IO, size);
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (data)
+	{
+		munmap((void*)data, size);
+		MemoryTracker::remove(MEMORY_IO, size);
+	}
+	if (fileDescriptor >= 0)
+	{
+		::close(fileDescriptor);
+	}
+
+	data = nullptr;
+	size = 0;
+	fileDescriptor = -1;
+}
+
+#endif
+
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+const unsigned char* MappedFile::getData() const
+{
+	return data;
+}
+
+size_t MappedFile::getSize() const
+{
+	return size;
+}
@@ -0,0 +1,113 @@
+// MemoryTracker.cpp
+
+#include "MemoryTracker.h"
+
+#include <chrono>
+#include <iomanip>
+
+MemoryTracker::Counters MemoryTracker::counters[MEMORY_TAG_COUNT];
+
+namespace
+{
+	double toMegabytes(double bytes)
+	{
+		return bytes / (1024.0 * 1024.0);
+	}
+}
+
+MemoryTracker::TagStats MemoryTracker::getStats(MemoryTag tag)
+{
+	const Counters& tagCounters = counters[tag];
+
+	TagStats stats;
+	stats.LiveBytes = tagCounters.LiveBytes.load(std::memory_order_relaxed);
+	stats.PeakBytes = tagCounters.PeakBytes.load(std::memory_order_relaxed);
+	stats.Allocations = tagCounters.Allocations.load(std::memory_order_relaxed);
+	stats.Frees = tagCounters.Frees.load(std::memory_order_relaxed);
+	stats.AllocatedBytes = tagCounters.AllocatedBytes.load(std::memory_order_relaxed);
+	return stats;
+}
+
+MemoryTracker::Snapshot MemoryTracker::takeSnapshot()
+{
+	Snapshot snapshot;
+	for (int tag = 0; tag < MEMORY_TAG_COUNT; tag++)
+	{
+		snapshot.Tags[tag] = getStats((MemoryTag)tag);
+	}
+	snapshot.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	return snapshot;
+}
+
+const char* MemoryTracker::getTagName(MemoryTag tag)
+{
+	switch (tag)
+	{
+	case MEMORY_CHUNKS:
+		return "Chunks";
+	case MEMORY_MESHES:
+		return "Meshes";
+	case MEMORY_TEXTURES:
+		return "Textures";
+	case MEMORY_JOBS:
+		return "Jobs";
+	case MEMORY_IO:
+		return "I/O";
+	case MEMORY_GPU_BUFFERS:
+		return "GPU buffers";
+	case MEMORY_GPU_TEXTURES:
+		return "GPU textures";
+	default:
+		return "Unknown";
+	}
+}
+
+void MemoryTracker::printReport(std::ostream& output, const Snapshot& previous, const Snapshot& current)
+{
+	double seconds = current.Seconds - previous.Seconds;
+	std::ios::fmtflags flags = output.flags();
+	std::streamsize precision = output.precision();
+	output << std::fixed << std::setprecision(2);
+
+	output << "Memory:\n";
+	for (int tag = 0; tag < MEMORY_TAG_COUNT; tag++)
+	{
+		const TagStats& now = current.Tags[tag];
+		const TagStats& before = previous.Tags[tag];
+
+		output << "  " << std::left << std::setw(13) << getTagName((MemoryTag)tag) << std::right
+			<< std::setw(9) << toMegabytes((double)now.LiveBytes) << " MB live, "
+			<< std::setw(9) << toMegabytes((double)now.PeakBytes) << " MB peak, "
+			<< now.getLiveAllocations() << " allocations";
+		if (seconds > 0.0)
+		{
+			output << ", " << (now.Allocations - before.Allocations) / seconds << " allocs/s, "
+				<< toMegabytes((double)(now.AllocatedBytes - before.AllocatedBytes)) / seconds << " MB/s";
+		}
+		output << '\n';
+	}
+
+	output.flags(flags);
+	output.precision(precision);
+}
+
+bool MemoryTracker::printLeaks(std::ostream& output)
+{
+	bool clean = true;
+	for (int tag = 0; tag < MEMORY_TAG_COUNT; tag++)
+	{
+		TagStats stats = getStats((MemoryTag)tag);
+		if (stats.getLiveAllocations() != 0 || stats.LiveBytes != 0)
+		{
+			output << "LEAK::" << getTagName((MemoryTag)tag) << ": " << stats.getLiveAllocations() << " allocations, "
+				<< stats.LiveBytes << " bytes still live\n";
+			clean = false;
+		}
+	}
+
+	if (clean)
+	{
+		output << "No tracked allocations leaked\n";
+	}
+	return clean;
+}
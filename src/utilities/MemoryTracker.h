@@ -0,0 +1,119 @@
+// MemoryTracker.h
+
+#ifndef MEMORY_TRACKER_H
+#define MEMORY_TRACKER_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+// Tracking is compiled in unless the build sets VOXEL_MEMORY_TRACKING to 0
+#ifndef VOXEL_MEMORY_TRACKING
+#define VOXEL_MEMORY_TRACKING 1
+#endif
+
+// What an allocation is for. The GPU tags mirror the byte counts handed to
+// the driver, the memory itself lives wherever the driver puts it.
+enum MemoryTag
+{
+	MEMORY_CHUNKS = 0,
+	MEMORY_MESHES,
+	MEMORY_TEXTURES,
+	MEMORY_JOBS,
+	MEMORY_IO,
+	MEMORY_GPU_BUFFERS,
+	MEMORY_GPU_TEXTURES,
+	MEMORY_TAG_COUNT
+};
+
+// Live, peak and total bytes per tag, counted with relaxed atomics so any
+// thread may allocate. Recording an allocation is three atomic adds plus a
+// load of the peak, which is only written when it grows.
+class MemoryTracker
+{
+public:
+	struct TagStats
+	{
+		int64_t LiveBytes = 0;
+		int64_t PeakBytes = 0;
+		uint64_t Allocations = 0;
+		uint64_t Frees = 0;
+		// Every byte ever allocated, for the allocation rate
+		uint64_t AllocatedBytes = 0;
+
+		int64_t getLiveAllocations() const
+		{
+			return (int64_t)(Allocations - Frees);
+		}
+	};
+
+	// Every tag's counters at one moment, two of them give the rates in between
+	struct Snapshot
+	{
+		std::array<TagStats, MEMORY_TAG_COUNT> Tags;
+		// On the steady clock
+		double Seconds = 0.0;
+	};
+
+	static void add(MemoryTag tag, size_t bytes);
+	static void remove(MemoryTag tag, size_t bytes);
+
+	static TagStats getStats(MemoryTag tag);
+	static Snapshot takeSnapshot();
+
+	static const char* getTagName(MemoryTag tag);
+
+	// One line per tag with live and peak bytes, plus allocations and bytes
+	// per second between the two snapshots
+	static void printReport(std::ostream& output, const Snapshot& previous, const Snapshot& current);
+
+	// Lists every tag with allocations still alive. Returns false if there were any.
+	static bool printLeaks(std::ostream& output);
+
+private:
+	// A cache line each, so threads allocating under different tags do not contend
+	struct alignas(64) Counters
+	{
+		std::atomic<int64_t> LiveBytes{ 0 };
+		std::atomic<int64_t> PeakBytes{ 0 };
+		std::atomic<uint64_t> Allocations{ 0 };
+		std::atomic<uint64_t> Frees{ 0 };
+		std::atomic<uint64_t> AllocatedBytes{ 0 };
+	};
+
+	static Counters counters[MEMORY_TAG_COUNT];
+};
+
+inline void MemoryTracker::add(MemoryTag tag, size_t bytes)
+{
+#if VOXEL_MEMORY_TRACKING
+	Counters& tagCounters = counters[tag];
+	int64_t live = tagCounters.LiveBytes.fetch_add((int64_t)bytes, std::memory_order_relaxed) + (int64_t)bytes;
+	tagCounters.Allocations.fetch_add(1, std::memory_order_relaxed);
+	tagCounters.AllocatedBytes.fetch_add(bytes, std::memory_order_relaxed);
+
+	int64_t peak = tagCounters.PeakBytes.load(std::memory_order_relaxed);
+	while (live > peak && !tagCounters.PeakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+	{
+	}
+#else
+	(void)tag;
+	(void)bytes;
+#endif
+}
+
+inline void MemoryTracker::remove(MemoryTag tag, size_t bytes)
+{
+#if VOXEL_MEMORY_TRACKING
+	Counters& tagCounters = counters[tag];
+	tagCounters.LiveBytes.fetch_sub((int64_t)bytes, std::memory_order_relaxed);
+	tagCounters.Frees.fetch_add(1, std::memory_order_relaxed);
+#else
+	(void)tag;
+	(void)bytes;
+#endif
+}
+
+#endif
@@ -0,0 +1,123 @@
+// PngWriter.cpp
+
+#include "PngWriter.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+	uint32_t crc32(const unsigned char* data, size_t size, uint32_t crc = 0)
+	{
+		static uint32_t table[256];
+		static bool tableReady = false;
+		if (!tableReady)
+		{
+			for (uint32_t i = 0; i < 256; i++)
+			{
+				uint32_t value = i;
+				for (int bit = 0; bit < 8; bit++)
+				{
+					value = (value & 1) ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+				}
+				table[i] = value;
+			}
+			tableReady = true;
+		}
+
+		crc = ~crc;
+		for (size_t i = 0; i < size; i++)
+		{
+			crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+		}
+		return ~crc;
+	}
+
+	void appendBigEndian(std::vector<unsigned char>& out, uint32_t value)
+	{
+		out.push_back((unsigned char)(value >> 24));
+		out.push_back((unsigned char)(value >> 16));
+		out.push_back((unsigned char)(value >> 8));
+		out.push_back((unsigned char)value);
+	}
+
+	void appendChunk(std::vector<unsigned char>& out, const char* type, const std::vector<unsigned char>& data)
+	{
+		appendBigEndian(out, (uint32_t)data.size());
+		size_t typeStart = out.size();
+		out.insert(out.end(), type, type + 4);
+		out.insert(out.end(), data.begin(), data.end());
+		appendBigEndian(out, crc32(&out[typeStart], out.size() - typeStart));
+	}
+}
+
+bool writePng(const std::string& path, int width, int height, const unsigned char* pixels)
+{
+	// Every row gets a filter byte of 0 (none)
+	size_t rowBytes = (size_t)width * 4;
+	std::vector<unsigned char> raw;
+	raw.reserve((rowBytes + 1) * height);
+	for (int y = 0; y < height; y++)
+	{
+		raw.push_back(0);
+		raw.insert(raw.end(), pixels + y * rowBytes, pixels + (y + 1) * rowBytes);
+	}
+
+	// zlib stream made of stored deflate blocks
+	std::vector<unsigned char> compressed;
+	compressed.push_back(0x78);
+	compressed.push_back(0x01);
+
+	const size_t MaxBlock = 65535;
+	uint32_t adlerA = 1;
+	uint32_t adlerB = 0;
+	for (size_t offset = 0; offset < raw.size() || offset == 0; offset += MaxBlock)
+	{
+		size_t blockSize = std::min(MaxBlock, raw.size() - offset);
+		bool lastBlock = offset + blockSize >= raw.size();
+		compressed.push_back(lastBlock ? 1 : 0);
+		compressed.push_back((unsigned char)(blockSize & 0xFF));
+		compressed.push_back((unsigned char)(blockSize >> 8));
+		compressed.push_back((unsigned char)(~blockSize & 0xFF));
+		compressed.push_back((unsigned char)((~blockSize >> 8) & 0xFF));
+		compressed.insert(compressed.end(), raw.begin() + offset, raw.begin() + offset + blockSize);
+
+		for (size_t i = offset; i < offset + blockSize; i++)
+		{
+			adlerA = (adlerA + raw[i]) % 65521;
+			adlerB = (adlerB + adlerA) % 65521;
+		}
+		if (lastBlock)
+		{
+			break;
+		}
+	}
+	appendBigEndian(compressed, (adlerB << 16) | adlerA);
+
+	std::vector<unsigned char> header;
+	appendBigEndian(header, (uint32_t)width);
+	appendBigEndian(header, (uint32_t)height);
+	header.push_back(8); // bit depth
+	header.push_back(6); // RGBA
+	header.push_back(0); // deflate
+	header.push_back(0); // adaptive filtering
+	header.push_back(0); // no interlace
+
+	const unsigned char signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	std::vector<unsigned char> file(signature, signature + sizeof(signature));
+	appendChunk(file, "IHDR", header);
+	appendChunk(file, "IDAT", compressed);
+	appendChunk(file, "IEND", std::vector<unsigned char>());
+
+	std::ofstream output(path, std::ios::binary | std::ios::trunc);
+	if (!output)
+	{
+		std::cout << "ERROR::PNG_WRITER::FILE_NOT_OPENED\n" << path << '\n';
+		return false;
+	}
+	output.write((const char*)file.data(), (std::streamsize)file.size());
+	return (bool)output;
+}
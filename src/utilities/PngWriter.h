@@ -0,0 +1,13 @@
+// PngWriter.h
+
+#ifndef PNG_WRITER_H
+#define PNG_WRITER_H
+
+#include <string>
+
+// Writes 8-bit RGBA pixels, top row first, as a PNG. The image data is
+// stored uncompressed, which keeps the writer tiny and fast at the cost of
+// file size, fine for benchmark captures.
+bool writePng(const std::string& path, int width, int height, const unsigned char* pixels);
+
+#endif
@@ -0,0 +1,78 @@
+// ProcessMemory.cpp
+
+#include "ProcessMemory.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+// Version 2 resolves to the kernel32 entry points, no psapi.lib needed
+#define PSAPI_VERSION 2
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <unistd.h>
+#include <cstdio>
+#endif
+
+#ifdef _WIN32
+
+size_t getResidentBytes()
+{
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+	{
+		return 0;
+	}
+	return counters.WorkingSetSize;
+}
+
+size_t getPeakResidentBytes()
+{
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+	{
+		return 0;
+	}
+	return counters.PeakWorkingSetSize;
+}
+
+#else
+
+size_t getResidentBytes()
+{
+#ifdef __linux__
+	// Second field of statm is the resident page count
+	FILE* file = std::fopen("/proc/self/statm", "r");
+	if (!file)
+	{
+		return 0;
+	}
+
+	unsigned long long totalPages = 0;
+	unsigned long long residentPages = 0;
+	int fields = std::fscanf(file, "%llu %llu", &totalPages, &residentPages);
+	std::fclose(file);
+	return fields == 2 ? (size_t)(residentPages * (unsigned long long)sysconf(_SC_PAGESIZE)) : 0;
+#else
+	return 0;
+#endif
+}
+
+size_t getPeakResidentBytes()
+{
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+	{
+		return 0;
+	}
+
+#ifdef __APPLE__
+	// Bytes on macOS, kilobytes everywhere else
+	return (size_t)usage.ru_maxrss;
+#else
+	return (size_t)usage.ru_maxrss * 1024;
+#endif
+}
+
+#endif
@@ -0,0 +1,13 @@
+// ProcessMemory.h
+
+#ifndef PROCESS_MEMORY_H
+#define PROCESS_MEMORY_H
+
+#include <cstddef>
+
+// Resident set size of this process in bytes, as the OS reports it.
+// Both return 0 where the platform offers no cheap way to ask.
+size_t getResidentBytes();
+size_t getPeakResidentBytes();
+
+#endif
@@ -0,0 +1,367 @@
+// Profiler.cpp
+
+#include "Profiler.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+namespace
+{
+	// Fields are relaxed atomics so a flush racing a wrapping writer reads stale values, never torn ones
+	struct Slot
+	{
+		std::atomic<const char*> Name{ nullptr };
+		std::atomic<uint64_t> Start{ 0 };
+		std::atomic<uint64_t> End{ 0 };
+	};
+
+	struct ThreadBuffer
+	{
+		uint32_t ThreadId = 0;
+		std::string Name;
+		bool InUse = false;
+
+		std::array<Slot, Profiler::RingCapacity> Slots;
+		// Written only by the owning thread
+		std::atomic<uint64_t> Head{ 0 };
+		// First zone not flushed yet, touched only under the registry mutex
+		uint64_t Tail = 0;
+	};
+
+	struct Event
+	{
+		const char* Name;
+		uint64_t Start;
+		uint64_t End;
+		uint32_t ThreadId;
+	};
+
+	struct Track
+	{
+		uint32_t ThreadId;
+		std::string Name;
+	};
+
+	struct Registry
+	{
+		std::mutex Mutex;
+		std::vector<std::unique_ptr<ThreadBuffer>> Buffers;
+		std::vector<Track> Tracks;
+		// Trace rows handed out so far, threads and tracks share them
+		uint32_t NextThreadId = 0;
+		// Copies of track zone names, never freed since kept zones point at them
+		std::unordered_set<std::string> TrackZoneNames;
+		// Ring of the most recent zones while capturing, never grows past EventCapacity
+		std::vector<Event> Events;
+		size_t EventCapacity = 0;
+		size_t NextEvent = 0;
+		bool Capturing = false;
+		uint64_t Dropped = 0;
+	};
+
+	Registry& getRegistry()
+	{
+		static Registry registry;
+		return registry;
+	}
+
+	// Hands the buffer back when its thread exits, so short-lived worker
+	// threads reuse buffers (and trace rows) instead of piling up new ones
+	struct ThreadBufferOwner
+	{
+		ThreadBuffer* Buffer = nullptr;
+
+		~ThreadBufferOwner()
+		{
+			if (Buffer)
+			{
+				Registry& registry = getRegistry();
+				std::lock_guard<std::mutex> lock(registry.Mutex);
+				Buffer->InUse = false;
+			}
+		}
+	};
+
+	thread_local ThreadBufferOwner threadBuffer;
+
+	ThreadBuffer& getThreadBuffer()
+	{
+		if (threadBuffer.Buffer)
+		{
+			return *threadBuffer.Buffer;
+		}
+
+		Registry& registry = getRegistry();
+		std::lock_guard<std::mutex> lock(registry.Mutex);
+		for (std::unique_ptr<ThreadBuffer>& buffer : registry.Buffers)
+		{
+			if (!buffer->InUse)
+			{
+				threadBuffer.Buffer = buffer.get();
+				break;
+			}
+		}
+		if (!threadBuffer.Buffer)
+		{
+			registry.Buffers.push_back(std::make_unique<ThreadBuffer>());
+			threadBuffer.Buffer = registry.Buffers.back().get();
+			threadBuffer.Buffer->ThreadId = registry.NextThreadId++;
+		}
+
+		threadBuffer.Buffer->InUse = true;
+		threadBuffer.Buffer->Name.clear();
+		return *threadBuffer.Buffer;
+	}
+
+	void keepEvent(Registry& registry, const Event& event)
+	{
+		if (registry.Events.size() < registry.EventCapacity)
+		{
+			registry.Events.push_back(event);
+			return;
+		}
+
+		registry.Events[registry.NextEvent] = event;
+		registry.NextEvent = (registry.NextEvent + 1) % registry.EventCapacity;
+		registry.Dropped++;
+	}
+
+	void flushBuffer(Registry& registry, ThreadBuffer& buffer)
+	{
+		uint64_t head = buffer.Head.load(std::memory_order_acquire);
+		uint64_t first = buffer.Tail;
+		if (head - first > Profiler::RingCapacity)
+		{
+			registry.Dropped += head - Profiler::RingCapacity - first;
+			first = head - Profiler::RingCapacity;
+		}
+
+		if (registry.Capturing)
+		{
+			for (uint64_t i = first; i < head; i++)
+			{
+				const Slot& slot = buffer.Slots[i & (Profiler::RingCapacity - 1)];
+				Event event = { slot.Name.load(std::memory_order_relaxed), slot.Start.load(std::memory_order_relaxed),
+					slot.End.load(std::memory_order_relaxed), buffer.ThreadId };
+
+				// The writer may have started on this slot again while it was read
+				std::atomic_thread_fence(std::memory_order_acquire);
+				if (buffer.Head.load(std::memory_order_relaxed) - i >= Profiler::RingCapacity)
+				{
+					registry.Dropped++;
+					continue;
+				}
+				keepEvent(registry, event);
+			}
+		}
+		buffer.Tail = head;
+	}
+
+	void writeJsonString(std::ostream& output, const std::string& text)
+	{
+		output << '"';
+		for (char c : text)
+		{
+			if (c == '"' || c == '\\')
+			{
+				output << '\\' << c;
+			}
+			else if ((unsigned char)c >= 0x20)
+			{
+				output << c;
+			}
+		}
+		output << '"';
+	}
+}
+
+uint64_t Profiler::now()
+{
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Profiler::record(const char* name, uint64_t start, uint64_t end)
+{
+	ThreadBuffer& buffer = getThreadBuffer();
+	uint64_t head = buffer.Head.load(std::memory_order_relaxed);
+
+	Slot& slot = buffer.Slots[head & (RingCapacity - 1)];
+	slot.Name.store(name, std::memory_order_relaxed);
+	slot.Start.store(start, std::memory_order_relaxed);
+	slot.End.store(end, std::memory_order_relaxed);
+
+	buffer.Head.store(head + 1, std::memory_order_release);
+}
+
+void Profiler::setThreadName(const std::string& name)
+{
+	ThreadBuffer& buffer = getThreadBuffer();
+
+	Registry& registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.Mutex);
+	buffer.Name = name;
+}
+
+uint32_t Profiler::addTrack(const std::string& name)
+{
+	Registry& registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.Mutex);
+	for (const Track& track : registry.Tracks)
+	{
+		if (track.Name == name)
+		{
+			return track.ThreadId;
+		}
+	}
+
+	registry.Tracks.push_back({ registry.NextThreadId++, name });
+	return registry.Tracks.back().ThreadId;
+}
+
+void Profiler::recordTrack(uint32_t track, const std::string& name, uint64_t start, uint64_t end)
+{
+	Registry& registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.Mutex);
+	if (!registry.Capturing)
+	{
+		return;
+	}
+
+	auto keptName = registry.TrackZoneNames.find(name);
+	if (keptName == registry.TrackZoneNames.end())
+	{
+		keptName = registry.TrackZoneNames.insert(name).first;
+	}
+	keepEvent(registry, { keptName->c_str(), start, end, track });
+}
+
+void Profiler::beginCapture(size_t maxEvents)
+{
+	Registry& registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.Mutex);
+	registry.Events.clear();
+	registry.Events.reserve(std::max<size_t>(maxEvents, 1));
+	registry.EventCapacity = std::max<size_t>(maxEvents, 1);
+	registry.NextEvent = 0;
+	registry.Capturing = true;
+}
+
+void Profiler::endCapture()
+{
+	Registry& registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.Mutex);
+	std::vector<Event>().swap(registry.Events);
+	registry.EventCapacity = 0;
+	registry.NextEvent = 0;
+	registry.Capturing = false;
+}
+
+bool Profiler::isCapturing()
+{
+	Registry& registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.Mutex);
+	return registry.Capturing;
+}
+
+void Profiler::flush()
+{
+	Registry& registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.Mutex);
+	for (std::unique_ptr<ThreadBuffer>& buffer : registry.Buffers)
+	{
+		flushBuffer(registry, *buffer);
+	}
+}
+
+bool Profiler::writeChromeTrace(const std::string& path)
+{
+	flush();
+
+	std::ofstream output(path, std::ios::trunc);
+	if (!output)
+	{
+		std::cout << "ERROR::PROFILER::FILE_NOT_OPENED\n" << path << '\n';
+		return false;
+	}
+
+	Registry& registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.Mutex);
+
+	output << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	bool firstEvent = true;
+	for (const std::unique_ptr<ThreadBuffer>& buffer : registry.Buffers)
+	{
+		if (buffer->Name.empty())
+		{
+			continue;
+		}
+
+		output << (firstEvent ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->ThreadId
+			<< ",\"args\":{\"name\":";
+		writeJsonString(output, buffer->Name);
+		output << "}}";
+		firstEvent = false;
+	}
+	for (const Track& track : registry.Tracks)
+	{
+		output << (firstEvent ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << track.ThreadId
+			<< ",\"args\":{\"name\":";
+		writeJsonString(output, track.Name);
+		output << "}}";
+		firstEvent = false;
+	}
+
+	// Complete events, timestamps relative to the earliest zone and durations in microseconds
+	uint64_t origin = UINT64_MAX;
+	for (const Event& event : registry.Events)
+	{
+		origin = std::min(origin, event.Start);
+	}
+
+	output.setf(std::ios::fixed);
+	output.precision(3);
+	for (const Event& event : registry.Events)
+	{
+		double start = (event.Start - origin) / 1000.0;
+		double duration = event.End > event.Start ? (event.End - event.Start) / 1000.0 : 0.0;
+
+		output << (firstEvent ? "" : ",\n") << "{\"name\":";
+		writeJsonString(output, event.Name ? event.Name : "");
+		output << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.ThreadId << ",\"ts\":" << start << ",\"dur\":" << duration << '}';
+		firstEvent = false;
+	}
+	output << "\n]}\n";
+
+	return (bool)output;
+}
+
+void Profiler::clear()
+{
+	Registry& registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.Mutex);
+	registry.Events.clear();
+	registry.NextEvent = 0;
+	registry.Dropped = 0;
+}
+
+size_t Profiler::getEventCount()
+{
+	Registry& registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.Mutex);
+	return registry.Events.size();
+}
+
+uint64_t Profiler::getDroppedCount()
+{
+	Registry& registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.Mutex);
+	return registry.Dropped;
+}
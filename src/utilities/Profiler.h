@@ -0,0 +1,100 @@
+// Profiler.h
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Zones are compiled in unless the build sets VOXEL_PROFILER to 0
+#ifndef VOXEL_PROFILER
+#define VOXEL_PROFILER 1
+#endif
+
+// Records named CPU zones from any thread and writes them out as a Chrome
+// trace (chrome://tracing or ui.perfetto.dev). Every thread appends to its
+// own ring buffer, so recording a zone is two clock reads and three
+// relaxed stores with no lock or allocation. flush() empties every ring;
+// call it about once a frame so no ring wraps before it is read, zones
+// overwritten before a flush are counted as dropped. Flushed zones are only
+// kept while a capture is running, so an uncaptured session never grows.
+class Profiler
+{
+public:
+	// Zones per thread between flushes, a power of two
+	static const uint32_t RingCapacity = 1u << 15;
+	// Default number of the most recent flushed zones a capture keeps
+	static const size_t MaxEvents = 1u << 21;
+
+	// Nanoseconds on the steady clock
+	static uint64_t now();
+
+	static void record(const char* name, uint64_t start, uint64_t end);
+
+	// Names the calling thread in the trace
+	static void setThreadName(const std::string& name);
+
+	// Returns the trace row called name for work no thread records itself,
+	// e.g. the GPU, adding it the first time
+	static uint32_t addTrack(const std::string& name);
+	// Keeps a zone on a track right away, only while a capture is running.
+	// Takes the registry lock, so it is meant for a handful of zones a frame.
+	// name is copied, times are on the same clock as now().
+	static void recordTrack(uint32_t track, const std::string& name, uint64_t start, uint64_t end);
+
+	// Starts keeping flushed zones for writeChromeTrace. Room for maxEvents
+	// is reserved up front so flushing never allocates, once it is full the
+	// oldest zones are overwritten and counted as dropped.
+	static void beginCapture(size_t maxEvents = MaxEvents);
+	// Stops keeping zones and frees the ones kept
+	static void endCapture();
+	static bool isCapturing();
+
+	// Empties the thread rings, keeping the zones if a capture is running.
+	// Safe to call while other threads record.
+	static void flush();
+
+	// Flushes and writes every zone kept so far as Chrome trace event JSON
+	static bool writeChromeTrace(const std::string& path);
+
+	// Forgets every kept zone, the capture keeps running
+	static void clear();
+
+	static size_t getEventCount();
+	static uint64_t getDroppedCount();
+};
+
+// Records the enclosing scope as one zone. name must outlive the trace,
+// in practice a string literal.
+class ProfileScope
+{
+public:
+	explicit ProfileScope(const char* name)
+		: name(name), start(Profiler::now())
+	{
+	}
+
+	~ProfileScope()
+	{
+		Profiler::record(name, start, Profiler::now());
+	}
+
+	ProfileScope(const ProfileScope&) = delete;
+	ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+	const char* name;
+	uint64_t start;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#if VOXEL_PROFILER
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,154 @@
+// ProgramCache.cpp
+
+#include "ProgramCache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include "utilities/GLExtensions.h"
+#include "utilities/Profiler.h"
+
+namespace
+{
+	const char MAGIC[4] = { 'V', 'X', 'P', 'B' };
+
+	struct BinaryHeader
+	{
+		char Magic[4];
+		uint32_t Format;
+		uint64_t Key;
+	};
+
+	const char* getString(GLenum name)
+	{
+		const char* value = (const char*)glGetString(name);
+		return value ? value : "";
+	}
+}
+
+ProgramCache::ProgramCache(const std::string& directory)
+	: directory(directory), driverHash(0), enabled(false)
+{
+}
+
+void ProgramCache::initialize()
+{
+	enabled = GLExtensions::ProgramBinary;
+	if (!enabled)
+	{
+		return;
+	}
+
+	driverHash = hash(getString(GL_VENDOR));
+	driverHash = hash(getString(GL_RENDERER), driverHash);
+	driverHash = hash(getString(GL_VERSION), driverHash);
+
+	std::error_code error;
+	std::filesystem::create_directories(directory, error);
+}
+
+bool ProgramCache::isEnabled() const
+{
+	return enabled;
+}
+
+uint64_t ProgramCache::hash(const std::string& text, uint64_t seed)
+{
+	uint64_t result = seed;
+	for (unsigned char character : text)
+	{
+		result = (result ^ character) * 1099511628211ull;
+	}
+	return result;
+}
+
+std::string ProgramCache::getPath(uint64_t sourceHash) const
+{
+	char name[32];
+	std::snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)(sourceHash ^ driverHash));
+	return directory + "/" + name;
+}
+
+bool ProgramCache::load(GLuint program, uint64_t sourceHash) const
+{
+	PROFILE_SCOPE("Load program binary");
+
+	if (!enabled)
+	{
+		return false;
+	}
+
+	std::ifstream binaryFile(getPath(sourceHash), std::ios::binary);
+	if (!binaryFile)
+	{
+		return false;
+	}
+
+	std::vector<char> contents((std::istreambuf_iterator<char>(binaryFile)), std::istreambuf_iterator<char>());
+	if (contents.size() <= sizeof(BinaryHeader))
+	{
+		return false;
+	}
+
+	BinaryHeader header;
+	std::memcpy(&header, contents.data(), sizeof(header));
+	if (std::memcmp(header.Magic, MAGIC, sizeof(MAGIC)) != 0 || header.Key != (sourceHash ^ driverHash))
+	{
+		return false;
+	}
+
+	GLExtensions::ProgramBinaryLoad(program, header.Format,
+		contents.data() + sizeof(BinaryHeader), (GLsizei)(contents.size() - sizeof(BinaryHeader)));
+
+	// The driver is free to reject binaries, in which case the caller compiles
+	int success = 0;
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+	return success != 0;
+}
+
+void ProgramCache::prepare(GLuint program) const
+{
+	if (enabled)
+	{
+		GLExtensions::ProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	}
+}
+
+void ProgramCache::store(GLuint program, uint64_t sourceHash) const
+{
+	PROFILE_SCOPE("Store program binary");
+
+	if (!enabled)
+	{
+		return;
+	}
+
+	GLint length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0)
+	{
+		return;
+	}
+
+	std::vector<char> contents(sizeof(BinaryHeader) + length);
+	GLenum format = 0;
+	GLsizei written = 0;
+	GLExtensions::GetProgramBinary(program, length, &written, &format, contents.data() + sizeof(BinaryHeader));
+	if (written <= 0)
+	{
+		return;
+	}
+
+	BinaryHeader header;
+	std::memcpy(header.Magic, MAGIC, sizeof(MAGIC));
+	header.Format = format;
+	header.Key = sourceHash ^ driverHash;
+	std::memcpy(contents.data(), &header, sizeof(header));
+
+	std::ofstream binaryFile(getPath(sourceHash), std::ios::binary | std::ios::trunc);
+	binaryFile.write(contents.data(), sizeof(BinaryHeader) + written);
+}
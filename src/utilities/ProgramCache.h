@@ -0,0 +1,41 @@
+// ProgramCache.h
+
+#ifndef PROGRAM_CACHE_H
+#define PROGRAM_CACHE_H
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <string>
+
+// On-disk cache of linked program binaries. Entries are keyed by a hash of
+// the shader sources combined with the GL vendor, renderer and version
+// strings, so a driver update simply misses instead of loading a binary
+// the driver would reject.
+class ProgramCache
+{
+public:
+	ProgramCache(const std::string& directory);
+
+	// Call once the GL context is current and GLExtensions are loaded
+	void initialize();
+	bool isEnabled() const;
+
+	// Both expect a program object that has not been linked yet
+	bool load(GLuint program, uint64_t sourceHash) const;
+	void prepare(GLuint program) const;
+
+	// Writes the binary of a successfully linked program
+	void store(GLuint program, uint64_t sourceHash) const;
+
+	static uint64_t hash(const std::string& text, uint64_t seed = 14695981039346656037ull);
+
+private:
+	std::string directory;
+	uint64_t driverHash;
+	bool enabled;
+
+	std::string getPath(uint64_t sourceHash) const;
+};
+
+#endif
@@ -2,98 +2,332 @@
 
 #include "Shader.h"
 
-Shader::Shader(const char* vertexSourcePath, const char* fragmentSourcePath)
+#include <algorithm>
+
+#include "utilities/GLExtensions.h"
+
+namespace
 {
-	// Retrieve data from path
-	std::string vertexCode;
-	std::string fragmentCode;
+	bool readSource(const std::string& path, std::string& code)
+	{
+		// One sized read instead of streaming through a stringstream
+		std::ifstream sourceFile(path, std::ios::binary | std::ios::ate);
+		if (!sourceFile)
+		{
+			return false;
+		}
+
+		std::streamsize size = sourceFile.tellg();
+		code.resize((size_t)std::max<std::streamsize>(size, 0));
+		sourceFile.seekg(0);
+		return (bool)sourceFile.read(&code[0], size);
+	}
+
+	// Splices "#include" lines in from src/shaders/include. Each file is only
+	// included once per shader, and #line keeps error line numbers pointing
+	// into the including file.
+	void resolveIncludes(const std::string& code, std::string& output, std::vector<std::string>& included)
+	{
+		std::istringstream lines(code);
+		std::string line;
+		int lineNumber = 0;
+
+		while (std::getline(lines, line))
+		{
+			lineNumber++;
+
+			size_t directive = line.find_first_not_of(" \t");
+			if (directive == std::string::npos || line.compare(directive, 8, "#include") != 0)
+			{
+				output += line;
+				output += '\n';
+				continue;
+			}
+
+			size_t open = line.find('"', directive);
+			size_t close = open != std::string::npos ? line.find('"', open + 1) : std::string::npos;
+			if (close == std::string::npos)
+			{
+				std::cout << "ERROR::SHADER::INCLUDE_MALFORMED\n" << line << '\n';
+				continue;
+			}
+
+			std::string name = line.substr(open + 1, close - open - 1);
+			if (std::find(included.begin(), included.end(), name) == included.end())
+			{
+				included.push_back(name);
 
-	std::ifstream vShaderFile;
-	std::ifstream fShaderFile;
+				std::string includeCode;
+				if (readSource(std::string(PROJECT_ROOT) + "/src/shaders/include/" + name, includeCode))
+				{
+					resolveIncludes(includeCode, output, included);
+				}
+				else
+				{
+					std::cout << "ERROR::SHADER::INCLUDE_NOT_FOUND\n" << name << '\n';
+				}
+			}
 
-	vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-	fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+			output += "#line " + std::to_string(lineNumber + 1) + '\n';
+		}
+	}
 
-	try
+	// Expands includes and adds a #define for every permutation define right
+	// after the #version line, which GLSL requires to come first
+	std::string preprocess(const std::string& code, const std::vector<std::string>& defines)
 	{
-		// Open
-		vShaderFile.open(std::string(PROJECT_ROOT) + "/src/shaders/" + vertexSourcePath);
-		fShaderFile.open(std::string(PROJECT_ROOT) + "/src/shaders/" + fragmentSourcePath);
+		std::string expanded;
+		std::vector<std::string> included;
+		resolveIncludes(code, expanded, included);
 
-		std::stringstream vShaderStream;
-		std::stringstream fShaderStream;
+		if (defines.empty())
+		{
+			return expanded;
+		}
 
-		// Read
-		vShaderStream << vShaderFile.rdbuf();
-		fShaderStream << fShaderFile.rdbuf();
+		std::string header;
+		for (const std::string& define : defines)
+		{
+			header += "#define " + define + " 1\n";
+		}
 
-		// Close
-		vShaderFile.close();
-		fShaderFile.close();
+		size_t version = expanded.find("#version");
+		size_t insertAt = version != std::string::npos ? expanded.find('\n', version) : std::string::npos;
+		if (insertAt == std::string::npos)
+		{
+			return header + expanded;
+		}
 
-		// Convert to string
-		vertexCode = vShaderStream.str();
-		fragmentCode = fShaderStream.str();
+		int versionLine = (int)std::count(expanded.begin(), expanded.begin() + insertAt, '\n') + 1;
+		header += "#line " + std::to_string(versionLine + 1) + '\n';
+		return expanded.insert(insertAt + 1, header);
 	}
-	catch (std::ifstream::failure e)
+
+	std::string getShaderLog(GLuint shaderId)
 	{
-		std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ\n";
+		int length = 0;
+		glGetShaderiv(shaderId, GL_INFO_LOG_LENGTH, &length);
+
+		std::string log((size_t)std::max(length, 1), '\0');
+		glGetShaderInfoLog(shaderId, (GLsizei)log.size(), NULL, &log[0]);
+		return log;
 	}
 
-	const char* vShaderCode = vertexCode.c_str();
-	const char* fShaderCode = fragmentCode.c_str();
+	std::string getProgramLog(GLuint programId)
+	{
+		int length = 0;
+		glGetProgramiv(programId, GL_INFO_LOG_LENGTH, &length);
 
-	// Compile shaders
-	unsigned int vertexId;
-	unsigned int fragmentId;
+		std::string log((size_t)std::max(length, 1), '\0');
+		glGetProgramInfoLog(programId, (GLsizei)log.size(), NULL, &log[0]);
+		return log;
+	}
+}
 
-	int success;
-	char infoLog[512];
+Shader::Shader(const char* vertexSourcePath, const char* fragmentSourcePath)
+	: Shader(vertexSourcePath, fragmentSourcePath, nullptr, std::vector<std::string>())
+{
+	finishLink();
+}
+
+Shader::Shader(const char* vertexSourcePath, const char* fragmentSourcePath, const ProgramCache* cache, const std::vector<std::string>& defines)
+	: Id(0), vertexId(0), fragmentId(0), sourceHash(0), cache(cache), linkPending(false), linked(false), loadedFromCache(false)
+{
+	// Retrieve data from path
+	std::string vertexCode;
+	std::string fragmentCode;
+
+	std::string vertexPath = std::string(PROJECT_ROOT) + "/src/shaders/" + vertexSourcePath;
+	std::string fragmentPath = std::string(PROJECT_ROOT) + "/src/shaders/" + fragmentSourcePath;
+	if (!readSource(vertexPath, vertexCode) || !readSource(fragmentPath, fragmentCode))
+	{
+		std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ\n" << vertexSourcePath << " " << fragmentSourcePath << '\n';
+	}
 
-	// Vertex Compilation
+	vertexCode = preprocess(vertexCode, defines);
+	fragmentCode = preprocess(fragmentCode, defines);
+
+	Id = glCreateProgram();
+
+	// A cached binary skips compilation entirely
+	sourceHash = ProgramCache::hash(fragmentCode, ProgramCache::hash(vertexCode));
+	if (cache && cache->load(Id, sourceHash))
+	{
+		linked = true;
+		loadedFromCache = true;
+		reflect();
+		return;
+	}
+
+	const char* vShaderCode = vertexCode.c_str();
+	const char* fShaderCode = fragmentCode.c_str();
+
+	// Compilation and linking are only kicked off here. Errors are checked
+	// in finishLink() so the driver can work on several programs at once.
 	vertexId = glCreateShader(GL_VERTEX_SHADER);
 	glShaderSource(vertexId, 1, &vShaderCode, NULL);
 	glCompileShader(vertexId);
 
-	// Print errors
-	glGetShaderiv(vertexId, GL_COMPILE_STATUS, &success);
-	if (!success)
-	{
-		glGetShaderInfoLog(vertexId, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << '\n';
-	};
-
-	// Fragment Compilation
 	fragmentId = glCreateShader(GL_FRAGMENT_SHADER);
 	glShaderSource(fragmentId, 1, &fShaderCode, NULL);
 	glCompileShader(fragmentId);
 
-	// Print errors
-	glGetShaderiv(fragmentId, GL_COMPILE_STATUS, &success);
-	if (!success)
-	{
-		glGetShaderInfoLog(fragmentId, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << '\n';
-	};
-
-	// Create Shader Program
-	Id = glCreateProgram();
-	
 	glAttachShader(Id, vertexId);
 	glAttachShader(Id, fragmentId);
+	if (cache)
+	{
+		cache->prepare(Id);
+	}
 	glLinkProgram(Id);
 
+	linkPending = true;
+}
+
+bool Shader::isLinkComplete() const
+{
+	if (!linkPending)
+	{
+		return true;
+	}
+
+	// Without parallel compile support there is no way to ask without blocking
+	if (!GLExtensions::ParallelShaderCompile)
+	{
+		return false;
+	}
+
+	int complete = 0;
+	glGetProgramiv(Id, GL_COMPLETION_STATUS_KHR, &complete);
+	return complete != 0;
+}
+
+bool Shader::finishLink()
+{
+	if (!linkPending)
+	{
+		return linked;
+	}
+	linkPending = false;
+
 	// Print errors
-	glGetProgramiv(Id, GL_LINK_STATUS, &success);
+	int success;
+	glGetShaderiv(vertexId, GL_COMPILE_STATUS, &success);
+	if (!success)
+	{
+		std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << getShaderLog(vertexId) << '\n';
+	}
+
+	glGetShaderiv(fragmentId, GL_COMPILE_STATUS, &success);
 	if (!success)
 	{
-		glGetProgramInfoLog(Id, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << '\n';
+		std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << getShaderLog(fragmentId) << '\n';
+	}
+
+	glGetProgramiv(Id, GL_LINK_STATUS, &success);
+	linked = success != 0;
+	if (!linked)
+	{
+		std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << getProgramLog(Id) << '\n';
 	}
 
 	// Delete shaders
+	glDetachShader(Id, vertexId);
+	glDetachShader(Id, fragmentId);
 	glDeleteShader(vertexId);
 	glDeleteShader(fragmentId);
+	vertexId = 0;
+	fragmentId = 0;
+
+	if (linked && cache)
+	{
+		cache->store(Id, sourceHash);
+	}
+
+	reflect();
+	return linked;
+}
+
+bool Shader::isLinkPending() const
+{
+	return linkPending;
+}
+
+bool Shader::isLinked() const
+{
+	return linked;
+}
+
+bool Shader::wasLoadedFromCache() const
+{
+	return loadedFromCache;
+}
+
+void Shader::reflect()
+{
+	uniforms.clear();
+	uniformBlocks.clear();
+
+	int maxNameLength = 0;
+	glGetProgramiv(Id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+	int maxBlockNameLength = 0;
+	glGetProgramiv(Id, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxBlockNameLength);
+
+	std::vector<char> name(std::max(maxNameLength, maxBlockNameLength) + 1);
+
+	// Uniforms
+	int uniformCount = 0;
+	glGetProgramiv(Id, GL_ACTIVE_UNIFORMS, &uniformCount);
+	for (int i = 0; i < uniformCount; i++)
+	{
+		GLsizei length = 0;
+		Uniform uniform;
+		glGetActiveUniform(Id, i, (GLsizei)name.size(), &length, &uniform.Size, &uniform.Type, name.data());
+
+		uniform.Name.assign(name.data(), length);
+		uniform.Location = glGetUniformLocation(Id, uniform.Name.c_str());
+
+		// Members of uniform blocks have no location
+		if (uniform.Location < 0)
+		{
+			continue;
+		}
+
+		// Arrays are reported as "name[0]", but are set through "name"
+		size_t bracket = uniform.Name.find('[');
+		if (bracket != std::string::npos)
+		{
+			uniform.Name.resize(bracket);
+		}
+
+		uniform.Hash = hashUniformName(uniform.Name.c_str());
+		uniforms.push_back(uniform);
+	}
+
+	std::sort(uniforms.begin(), uniforms.end(), [](const Uniform& a, const Uniform& b) { return a.Hash < b.Hash; });
+	for (size_t i = 1; i < uniforms.size(); i++)
+	{
+		if (uniforms[i].Hash == uniforms[i - 1].Hash)
+		{
+			std::cout << "ERROR::SHADER::UNIFORM::HASH_COLLISION\n" << uniforms[i - 1].Name << " " << uniforms[i].Name << '\n';
+		}
+	}
+	values.assign(uniforms.size(), UniformValue());
+
+	// Uniform blocks
+	int blockCount = 0;
+	glGetProgramiv(Id, GL_ACTIVE_UNIFORM_BLOCKS, &blockCount);
+	for (int i = 0; i < blockCount; i++)
+	{
+		GLsizei length = 0;
+		UniformBlock block;
+		glGetActiveUniformBlockName(Id, i, (GLsizei)name.size(), &length, name.data());
+		glGetActiveUniformBlockiv(Id, i, GL_UNIFORM_BLOCK_DATA_SIZE, &block.DataSize);
+
+		block.Name.assign(name.data(), length);
+		block.Hash = hashUniformName(block.Name.c_str());
+		block.Index = (GLuint)i;
+		uniformBlocks.push_back(block);
+	}
 }
 
 void Shader::use()
@@ -101,52 +335,124 @@ void Shader::use()
 	glUseProgram(Id);
 }
 
-void Shader::setBool(const std::string& name, bool value) const
+UniformHandle Shader::getUniform(UniformName name) const
 {
-	glUniform1i(glGetUniformLocation(Id, name.c_str()), (int)value);
+	auto it = std::lower_bound(uniforms.begin(), uniforms.end(), name.Hash,
+		[](const Uniform& uniform, uint32_t hash) { return uniform.Hash < hash; });
+
+	if (it == uniforms.end() || it->Hash != name.Hash)
+	{
+		return -1;
+	}
+	return (UniformHandle)(it - uniforms.begin());
 }
 
-void Shader::setInt(const std::string& name, int value) const
+GLint Shader::getUniformLocation(UniformName name) const
 {
-	glUniform1i(glGetUniformLocation(Id, name.c_str()), value);
+	UniformHandle uniform = getUniform(name);
+	return uniform >= 0 ? uniforms[uniform].Location : -1;
 }
 
-void Shader::setFloat(const std::string& name, float value) const
+GLuint Shader::getUniformBlockIndex(UniformName name) const
 {
-	glUniform1f(glGetUniformLocation(Id, name.c_str()), value);
+	for (const UniformBlock& block : uniformBlocks)
+	{
+		if (block.Hash == name.Hash)
+		{
+			return block.Index;
+		}
+	}
+	return GL_INVALID_INDEX;
+}
+
+const std::vector<Shader::Uniform>& Shader::getUniforms() const
+{
+	return uniforms;
 }
 
-void Shader::setVec2i(const std::string& name, int x, int y) const
+const std::vector<Shader::UniformBlock>& Shader::getUniformBlocks() const
 {
-	glUniform2i(glGetUniformLocation(Id, name.c_str()), x, y);
+	return uniformBlocks;
 }
 
-void Shader::setVec2f(const std::string& name, float x, float y) const
+unsigned int Shader::getSkippedUploads() const
 {
-	glUniform2f(glGetUniformLocation(Id, name.c_str()), x, y);
+	return skippedUploads;
 }
 
-void Shader::setVec3i(const std::string& name, int x, int y, int z) const
+void Shader::setBool(UniformHandle uniform, bool value) const
 {
-	glUniform3i(glGetUniformLocation(Id, name.c_str()), x, y, z);
+	setInt(uniform, (int)value);
+}
+
+void Shader::setInt(UniformHandle uniform, int value) const
+{
+	if (updateValue(uniform, value))
+	{
+		glUniform1i(uniforms[uniform].Location, value);
+	}
 }
 
-void Shader::setVec3f(const std::string& name, float x, float y, float z) const
+void Shader::setFloat(UniformHandle uniform, float value) const
 {
-	glUniform3f(glGetUniformLocation(Id, name.c_str()), x, y, z);
+	if (updateValue(uniform, value))
+	{
+		glUniform1f(uniforms[uniform].Location, value);
+	}
 }
 
-void Shader::setVec4i(const std::string& name, int x, int y, int z, int w) const
+void Shader::setVec2i(UniformHandle uniform, int x, int y) const
 {
-	glUniform4i(glGetUniformLocation(Id, name.c_str()), x, y, z, w);
+	if (updateValue(uniform, glm::ivec2(x, y)))
+	{
+		glUniform2i(uniforms[uniform].Location, x, y);
+	}
 }
 
-void Shader::setVec4f(const std::string& name, float x, float y, float z, float w) const
+void Shader::setVec2f(UniformHandle uniform, float x, float y) const
 {
-	glUniform4f(glGetUniformLocation(Id, name.c_str()), x,y ,z, w);
+	if (updateValue(uniform, glm::vec2(x, y)))
+	{
+		glUniform2f(uniforms[uniform].Location, x, y);
+	}
 }
 
-void Shader::setMat4(const std::string& name, const glm::mat4& matrix) const
+void Shader::setVec3i(UniformHandle uniform, int x, int y, int z) const
 {
-	glUniformMatrix4fv(glGetUniformLocation(Id, name.c_str()), 1, GL_FALSE, glm::value_ptr(matrix));
-}
\ No newline at end of file
+	if (updateValue(uniform, glm::ivec3(x, y, z)))
+	{
+		glUniform3i(uniforms[uniform].Location, x, y, z);
+	}
+}
+
+void Shader::setVec3f(UniformHandle uniform, float x, float y, float z) const
+{
+	if (updateValue(uniform, glm::vec3(x, y, z)))
+	{
+		glUniform3f(uniforms[uniform].Location, x, y, z);
+	}
+}
+
+void Shader::setVec4i(UniformHandle uniform, int x, int y, int z, int w) const
+{
+	if (updateValue(uniform, glm::ivec4(x, y, z, w)))
+	{
+		glUniform4i(uniforms[uniform].Location, x, y, z, w);
+	}
+}
+
+void Shader::setVec4f(UniformHandle uniform, float x, float y, float z, float w) const
+{
+	if (updateValue(uniform, glm::vec4(x, y, z, w)))
+	{
+		glUniform4f(uniforms[uniform].Location, x, y, z, w);
+	}
+}
+
+void Shader::setMat4(UniformHandle uniform, const glm::mat4& matrix) const
+{
+	if (updateValue(uniform, matrix))
+	{
+		glUniformMatrix4fv(uniforms[uniform].Location, 1, GL_FALSE, glm::value_ptr(matrix));
+	}
+}
@@ -10,33 +10,170 @@
 #include <sstream>
 #include <iostream>
 #include <filesystem>
+#include <vector>
+#include <cstdint>
+#include <cstring>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include "utilities/ProgramCache.h"
+
+// FNV-1a, constexpr so names written as literals are hashed at compile time
+constexpr uint32_t hashUniformName(const char* name)
+{
+	uint32_t hash = 2166136261u;
+	while (*name)
+	{
+		hash = (hash ^ (uint32_t)(unsigned char)*name++) * 16777619u;
+	}
+	return hash;
+}
+
+struct UniformName
+{
+	uint32_t Hash;
+
+	constexpr UniformName(const char* name) : Hash(hashUniformName(name)) {}
+	UniformName(const std::string& name) : Hash(hashUniformName(name.c_str())) {}
+};
+
+// Index into the uniforms reflected at link time, -1 for inactive uniforms
+typedef int UniformHandle;
+
 class Shader
 {
 public:
+	struct Uniform
+	{
+		uint32_t Hash;
+		std::string Name;
+		GLint Location;
+		GLenum Type;
+		GLint Size;
+	};
+
+	struct UniformBlock
+	{
+		uint32_t Hash;
+		std::string Name;
+		GLuint Index;
+		GLint DataSize;
+	};
+
 	unsigned int Id;
 
+	// Compiles and links straight away
 	Shader(const char* vertexSourcePath, const char* fragmentSourcePath);
 
+	// Loads the program from the cache, or only starts compiling and linking
+	// it without waiting on the driver. finishLink() must run before use.
+	// Every define is set to 1 in both stages to select a permutation.
+	Shader(const char* vertexSourcePath, const char* fragmentSourcePath, const ProgramCache* cache, const std::vector<std::string>& defines);
+
+	// Never blocks. Always false while a link is pending on drivers without
+	// parallel shader compile support, since they can only be asked by waiting.
+	bool isLinkComplete() const;
+
+	// Waits for a pending link, prints any errors, stores the binary in the
+	// cache and reflects the uniforms. Returns whether the program linked.
+	bool finishLink();
+
+	bool isLinkPending() const;
+	bool isLinked() const;
+	bool wasLoadedFromCache() const;
+
 	void use();
-	void setBool(const std::string& name, bool value) const;
-	void setInt(const std::string& name, int value) const;
-	void setFloat(const std::string& name, float value) const;
 
-	void setVec2i(const std::string& name, int x, int y) const;
-	void setVec2f(const std::string& name, float x, float y) const;
+	UniformHandle getUniform(UniformName name) const;
+	GLint getUniformLocation(UniformName name) const;
+	GLuint getUniformBlockIndex(UniformName name) const;
+
+	const std::vector<Uniform>& getUniforms() const;
+	const std::vector<UniformBlock>& getUniformBlocks() const;
+
+	// Uploads skipped because the uniform already held the value
+	unsigned int getSkippedUploads() const;
+
+	// Setters upload to the program in use and skip the upload entirely
+	// when the uniform already holds the value
+	void setBool(UniformHandle uniform, bool value) const;
+	void setInt(UniformHandle uniform, int value) const;
+	void setFloat(UniformHandle uniform, float value) const;
+
+	void setVec2i(UniformHandle uniform, int x, int y) const;
+	void setVec2f(UniformHandle uniform, float x, float y) const;
+
+	void setVec3i(UniformHandle uniform, int x, int y, int z) const;
+	void setVec3f(UniformHandle uniform, float x, float y, float z) const;
+
+	void setVec4i(UniformHandle uniform, int x, int y, int z, int w) const;
+	void setVec4f(UniformHandle uniform, float x, float y, float z, float w) const;
+
+	void setMat4(UniformHandle uniform, const glm::mat4& matrix) const;
+
+	void setBool(UniformName name, bool value) const { setBool(getUniform(name), value); }
+	void setInt(UniformName name, int value) const { setInt(getUniform(name), value); }
+	void setFloat(UniformName name, float value) const { setFloat(getUniform(name), value); }
+
+	void setVec2i(UniformName name, int x, int y) const { setVec2i(getUniform(name), x, y); }
+	void setVec2f(UniformName name, float x, float y) const { setVec2f(getUniform(name), x, y); }
+
+	void setVec3i(UniformName name, int x, int y, int z) const { setVec3i(getUniform(name), x, y, z); }
+	void setVec3f(UniformName name, float x, float y, float z) const { setVec3f(getUniform(name), x, y, z); }
+
+	void setVec4i(UniformName name, int x, int y, int z, int w) const { setVec4i(getUniform(name), x, y, z, w); }
+	void setVec4f(UniformName name, float x, float y, float z, float w) const { setVec4f(getUniform(name), x, y, z, w); }
+
+	void setMat4(UniformName name, const glm::mat4& matrix) const { setMat4(getUniform(name), matrix); }
+
+private:
+	struct UniformValue
+	{
+		bool Valid = false;
+		unsigned char Data[sizeof(glm::mat4)];
+	};
+
+	unsigned int vertexId;
+	unsigned int fragmentId;
+	uint64_t sourceHash;
+	const ProgramCache* cache;
+	bool linkPending;
+	bool linked;
+	bool loadedFromCache;
+
+	// Sorted by hash so lookups are a binary search
+	std::vector<Uniform> uniforms;
+	std::vector<UniformBlock> uniformBlocks;
+
+	mutable std::vector<UniformValue> values;
+	mutable unsigned int skippedUploads = 0;
+
+	void reflect();
+
+	// Returns false if the uniform is inactive or already holds the value
+	template <typename T>
+	bool updateValue(UniformHandle uniform, const T& value) const
+	{
+		static_assert(sizeof(T) <= sizeof(UniformValue::Data), "Uniform value too large to cache");
 
-	void setVec3i(const std::string& name, int x, int y, int z) const;
-	void setVec3f(const std::string& name, float x, float y, float z) const;
+		if (uniform < 0)
+		{
+			return false;
+		}
 
-	void setVec4i(const std::string& name, int x, int y, int z, int w) const;
-	void setVec4f(const std::string& name, float x, float y, float z, float w) const;
+		UniformValue& cached = values[uniform];
+		if (cached.Valid && std::memcmp(cached.Data, &value, sizeof(T)) == 0)
+		{
+			skippedUploads++;
+			return false;
+		}
 
-	void setMat4(const std::string& name, const glm::mat4& matrix) const;
+		std::memcpy(cached.Data, &value, sizeof(T));
+		cached.Valid = true;
+		return true;
+	}
 };
 
-#endif
\ No newline at end of file
+#endif
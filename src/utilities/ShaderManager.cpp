@@ -0,0 +1,147 @@
+// ShaderManager.cpp
+
+#include "ShaderManager.h"
+
+#include <cstdlib>
+
+#include "utilities/Profiler.h"
+
+ShaderManager::ShaderManager(const std::string& cacheDirectory)
+	: cache(cacheDirectory)
+{
+}
+
+void ShaderManager::initialize()
+{
+	cache.initialize();
+}
+
+void ShaderManager::registerProgram(const std::string& name, const char* vertexSourcePath, const char* fragmentSourcePath,
+	const std::vector<std::string>& features)
+{
+	if (features.size() > MaxFeatures)
+	{
+		std::cout << "ERROR::SHADER_MANAGER::TOO_MANY_FEATURES\n" << name << '\n';
+	}
+
+	Program& program = programs[name];
+	program.VertexSourcePath = vertexSourcePath;
+	program.FragmentSourcePath = fragmentSourcePath;
+	program.Features = features;
+	program.Variants.clear();
+}
+
+ShaderFeatures ShaderManager::getFeature(const std::string& name, const std::string& feature) const
+{
+	auto it = programs.find(name);
+	if (it == programs.end())
+	{
+		return 0;
+	}
+
+	const std::vector<std::string>& features = it->second.Features;
+	for (size_t i = 0; i < features.size() && i < MaxFeatures; i++)
+	{
+		if (features[i] == feature)
+		{
+			return 1u << i;
+		}
+	}
+	return 0;
+}
+
+ShaderManager::Program& ShaderManager::getProgram(const std::string& name)
+{
+	auto it = programs.find(name);
+	if (it == programs.end())
+	{
+		std::cout << "ERROR::SHADER_MANAGER::UNKNOWN_PROGRAM\n" << name << '\n';
+		std::abort();
+	}
+	return it->second;
+}
+
+Shader& ShaderManager::getVariant(Program& program, ShaderFeatures features)
+{
+	std::unique_ptr<Shader>& variant = program.Variants[features];
+	if (variant)
+	{
+		return *variant;
+	}
+
+	PROFILE_SCOPE("Compile shader");
+	std::vector<std::string> defines;
+	for (size_t i = 0; i < program.Features.size() && i < MaxFeatures; i++)
+	{
+		if (features & (1u << i))
+		{
+			defines.push_back(program.Features[i]);
+		}
+	}
+
+	variant = std::make_unique<Shader>(program.VertexSourcePath.c_str(), program.FragmentSourcePath.c_str(), &cache, defines);
+	if (variant->wasLoadedFromCache())
+	{
+		stats.ProgramsFromCache++;
+	}
+	return *variant;
+}
+
+void ShaderManager::load(const std::string& name, ShaderFeatures features)
+{
+	getVariant(getProgram(name), features);
+}
+
+Shader& ShaderManager::get(const std::string& name, ShaderFeatures features)
+{
+	Shader& shader = getVariant(getProgram(name), features);
+	finish(shader);
+	return shader;
+}
+
+void ShaderManager::poll()
+{
+	for (auto& program : programs)
+	{
+		for (auto& variant : program.second.Variants)
+		{
+			if (variant.second->isLinkComplete())
+			{
+				finish(*variant.second);
+			}
+		}
+	}
+}
+
+void ShaderManager::finishAll()
+{
+	for (auto& program : programs)
+	{
+		for (auto& variant : program.second.Variants)
+		{
+			finish(*variant.second);
+		}
+	}
+}
+
+void ShaderManager::finish(Shader& shader)
+{
+	if (!shader.isLinkPending())
+	{
+		return;
+	}
+
+	if (shader.finishLink())
+	{
+		stats.ProgramsCompiled++;
+	}
+	else
+	{
+		stats.ProgramsFailed++;
+	}
+}
+
+const ShaderManager::Stats& ShaderManager::getStats() const
+{
+	return stats;
+}
@@ -0,0 +1,81 @@
+// ShaderManager.h
+
+#ifndef SHADER_MANAGER_H
+#define SHADER_MANAGER_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "utilities/ProgramCache.h"
+#include "utilities/Shader.h"
+
+// Bit i enables the i-th feature define a program was registered with
+typedef uint32_t ShaderFeatures;
+
+// Owns every program and its permutations. A program is registered with
+// the list of #define features it supports, and each combination of them
+// is compiled as its own variant the first time it is asked for, so
+// disabled features cost nothing in the shader instead of being branched
+// on at runtime.
+//
+// Variants that are known to be needed should be requested with load() up
+// front so the driver can compile them in parallel. Each link is only
+// checked when the variant is first fetched or poll() finds it finished.
+class ShaderManager
+{
+public:
+	struct Stats
+	{
+		int ProgramsFromCache = 0;
+		int ProgramsCompiled = 0;
+		int ProgramsFailed = 0;
+	};
+
+	static const int MaxFeatures = 32;
+
+	ShaderManager(const std::string& cacheDirectory);
+
+	// Call once after the GL context is current and GLExtensions are loaded
+	void initialize();
+
+	void registerProgram(const std::string& name, const char* vertexSourcePath, const char* fragmentSourcePath,
+		const std::vector<std::string>& features = std::vector<std::string>());
+
+	// Bit for a feature define of a registered program, 0 if it has no such feature
+	ShaderFeatures getFeature(const std::string& name, const std::string& feature) const;
+
+	// Starts loading a variant, returns immediately
+	void load(const std::string& name, ShaderFeatures features = 0);
+
+	// Returns a linked variant, compiling it on demand and waiting for the
+	// driver only if it is not done yet
+	Shader& get(const std::string& name, ShaderFeatures features = 0);
+
+	// Finishes every variant the driver reports as done, never blocks
+	void poll();
+	void finishAll();
+
+	const Stats& getStats() const;
+
+private:
+	struct Program
+	{
+		std::string VertexSourcePath;
+		std::string FragmentSourcePath;
+		std::vector<std::string> Features;
+		std::unordered_map<ShaderFeatures, std::unique_ptr<Shader>> Variants;
+	};
+
+	ProgramCache cache;
+	std::unordered_map<std::string, Program> programs;
+	Stats stats;
+
+	Program& getProgram(const std::string& name);
+	Shader& getVariant(Program& program, ShaderFeatures features);
+	void finish(Shader& shader);
+};
+
+#endif
@@ -0,0 +1,63 @@
+// TrackingAllocator.h
+
+#ifndef TRACKING_ALLOCATOR_H
+#define TRACKING_ALLOCATOR_H
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+#include "utilities/MemoryTracker.h"
+
+// Standard allocator that counts its bytes towards a MemoryTracker tag.
+// Stateless, so containers with the same tag swap and move freely.
+template <typename T, MemoryTag Tag>
+class TrackingAllocator
+{
+public:
+	typedef T value_type;
+
+	// The tag is a value parameter, so allocator_traits cannot rebind on its own
+	template <typename U>
+	struct rebind
+	{
+		typedef TrackingAllocator<U, Tag> other;
+	};
+
+	TrackingAllocator() noexcept = default;
+
+	template <typename U>
+	TrackingAllocator(const TrackingAllocator<U, Tag>&) noexcept
+	{
+	}
+
+	T* allocate(size_t count)
+	{
+		T* pointer = static_cast<T*>(::operator new(count * sizeof(T)));
+		MemoryTracker::add(Tag, count * sizeof(T));
+		return pointer;
+	}
+
+	void deallocate(T* pointer, size_t count) noexcept
+	{
+		MemoryTracker::remove(Tag, count * sizeof(T));
+		::operator delete(pointer);
+	}
+
+	template <typename U>
+	bool operator==(const TrackingAllocator<U, Tag>&) const noexcept
+	{
+		return true;
+	}
+
+	template <typename U>
+	bool operator!=(const TrackingAllocator<U, Tag>&) const noexcept
+	{
+		return false;
+	}
+};
+
+template <typename T, MemoryTag Tag>
+using TrackedVector = std::vector<T, TrackingAllocator<T, Tag>>;
+
+#endif
@@ -0,0 +1,106 @@
+// WorkStealingDeque.h
+
+#ifndef WORK_STEALING_DEQUE_H
+#define WORK_STEALING_DEQUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Chase-Lev deque of pointers with a fixed, power of two capacity. The
+// owning thread pushes and pops at the bottom without contention, any
+// other thread steals from the top. Follows "Correct and Efficient
+// Work-Stealing for Weak Memory Models" (Le et al. 2013), with sequentially
+// consistent loads and stores where the paper uses fences.
+template <typename T>
+class WorkStealingDeque
+{
+public:
+	explicit WorkStealingDeque(size_t capacity)
+		: items(new std::atomic<T*>[capacity]), capacity((int64_t)capacity), mask((int64_t)capacity - 1)
+	{
+		for (size_t i = 0; i < capacity; i++)
+		{
+			items[i].store(nullptr, std::memory_order_relaxed);
+		}
+	}
+
+	WorkStealingDeque(const WorkStealingDeque&) = delete;
+	WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+	// Owner only. Returns false when the deque is full.
+	bool push(T* item)
+	{
+		int64_t b = bottom.load(std::memory_order_relaxed);
+		int64_t t = top.load(std::memory_order_acquire);
+		if (b - t >= capacity)
+		{
+			return false;
+		}
+
+		items[b & mask].store(item, std::memory_order_relaxed);
+		bottom.store(b + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Owner only, takes the most recently pushed item
+	T* pop()
+	{
+		int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+		bottom.store(b, std::memory_order_seq_cst);
+		int64_t t = top.load(std::memory_order_seq_cst);
+
+		if (t > b)
+		{
+			bottom.store(b + 1, std::memory_order_release);
+			return nullptr;
+		}
+
+		T* item = items[b & mask].load(std::memory_order_relaxed);
+		if (t == b)
+		{
+			// Last item, thieves may be after it too
+			if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			{
+				item = nullptr;
+			}
+			bottom.store(b + 1, std::memory_order_release);
+		}
+		return item;
+	}
+
+	// Any thread, takes the oldest item. Returns null when empty or when
+	// another thread got there first.
+	T* steal()
+	{
+		int64_t t = top.load(std::memory_order_seq_cst);
+		int64_t b = bottom.load(std::memory_order_seq_cst);
+		if (t >= b)
+		{
+			return nullptr;
+		}
+
+		T* item = items[t & mask].load(std::memory_order_relaxed);
+		if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		{
+			return nullptr;
+		}
+		return item;
+	}
+
+	size_t getCapacity() const
+	{
+		return (size_t)capacity;
+	}
+
+private:
+	// Thieves hammer top while the owner works at bottom, keep them on separate lines
+	alignas(64) std::atomic<int64_t> top{ 0 };
+	alignas(64) std::atomic<int64_t> bottom{ 0 };
+	std::unique_ptr<std::atomic<T*>[]> items;
+	int64_t capacity;
+	int64_t mask;
+};
+
+#endif
@@ -0,0 +1,174 @@
+// CameraPath.cpp
+
+#include "CameraPath.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+void CameraPath::addPoint(const glm::vec3& point)
+{
+	points.push_back(point);
+	arcLengthsDirty = true;
+}
+
+void CameraPath::clear()
+{
+	points.clear();
+	arcLengthsDirty = true;
+}
+
+bool CameraPath::load(const std::string& path)
+{
+	std::ifstream input(path);
+	if (!input)
+	{
+		std::cout << "ERROR::CAMERA_PATH::FILE_NOT_OPENED\n" << path << '\n';
+		return false;
+	}
+
+	clear();
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(input, line))
+	{
+		lineNumber++;
+		size_t first = line.find_first_not_of(" \t\r");
+		if (first == std::string::npos || line[first] == '#')
+		{
+			continue;
+		}
+
+		std::istringstream fields(line);
+		glm::vec3 point;
+		if (!(fields >> point.x >> point.y >> point.z))
+		{
+			std::cout << "ERROR::CAMERA_PATH::INVALID_POINT\n" << path << ':' << lineNumber << '\n';
+			clear();
+			return false;
+		}
+		addPoint(point);
+	}
+
+	return true;
+}
+
+bool CameraPath::save(const std::string& path) const
+{
+	std::ofstream output(path, std::ios::trunc);
+	if (!output)
+	{
+		std::cout << "ERROR::CAMERA_PATH::FILE_NOT_OPENED\n" << path << '\n';
+		return false;
+	}
+
+	output << "# x y z, one camera path point per line\n";
+	for (const glm::vec3& point : points)
+	{
+		output << point.x << ' ' << point.y << ' ' << point.z << '\n';
+	}
+	return (bool)output;
+}
+
+const std::vector<glm::vec3>& CameraPath::getPoints() const
+{
+	return points;
+}
+
+float CameraPath::getLength() const
+{
+	if (points.size() < 2)
+	{
+		return 0.0f;
+	}
+
+	rebuildArcLengths();
+	return arcLengths.back();
+}
+
+glm::vec3 CameraPath::getPosition(float distance) const
+{
+	if (points.empty())
+	{
+		return glm::vec3(0.0f);
+	}
+	if (points.size() < 2)
+	{
+		return points.front();
+	}
+
+	return evaluate(getParameter(distance));
+}
+
+glm::vec3 CameraPath::getDirection(float distance) const
+{
+	if (points.size() < 2)
+	{
+		return glm::vec3(0.0f, 0.0f, -1.0f);
+	}
+
+	// Central difference over a block either side, so the view turns smoothly through the points
+	float length = getLength();
+	float ahead = std::min(distance + 1.0f, length);
+	float behind = std::max(ahead - 2.0f, 0.0f);
+	glm::vec3 direction = getPosition(ahead) - getPosition(behind);
+	float directionLength = glm::length(direction);
+	return directionLength > 0.0f ? direction / directionLength : glm::vec3(0.0f, 0.0f, -1.0f);
+}
+
+void CameraPath::rebuildArcLengths() const
+{
+	if (!arcLengthsDirty)
+	{
+		return;
+	}
+
+	int segments = (int)points.size() - 1;
+	arcLengths.assign(1, 0.0f);
+	glm::vec3 previous = points.front();
+	for (int i = 1; i <= segments * SamplesPerSegment; i++)
+	{
+		glm::vec3 current = evaluate((float)i / SamplesPerSegment);
+		arcLengths.push_back(arcLengths.back() + glm::length(current - previous));
+		previous = current;
+	}
+	arcLengthsDirty = false;
+}
+
+glm::vec3 CameraPath::evaluate(float t) const
+{
+	int last = (int)points.size() - 1;
+	int segment = std::min(std::max((int)std::floor(t), 0), last - 1);
+	float f = std::min(std::max(t - segment, 0.0f), 1.0f);
+
+	// The end points are repeated so the curve starts and ends on them
+	const glm::vec3& p0 = points[std::max(segment - 1, 0)];
+	const glm::vec3& p1 = points[segment];
+	const glm::vec3& p2 = points[segment + 1];
+	const glm::vec3& p3 = points[std::min(segment + 2, last)];
+
+	float f2 = f * f;
+	float f3 = f2 * f;
+	return 0.5f * (2.0f * p1 + (p2 - p0) * f + (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * f2
+		+ (3.0f * p1 - p0 - 3.0f * p2 + p3) * f3);
+}
+
+float CameraPath::getParameter(float distance) const
+{
+	rebuildArcLengths();
+
+	distance = std::min(std::max(distance, 0.0f), arcLengths.back());
+	size_t upper = std::lower_bound(arcLengths.begin(), arcLengths.end(), distance) - arcLengths.begin();
+	if (upper == 0)
+	{
+		return 0.0f;
+	}
+
+	// Linear between table entries, close enough at this sampling density
+	float below = arcLengths[upper - 1];
+	float above = arcLengths[upper];
+	float fraction = above > below ? (distance - below) / (above - below) : 0.0f;
+	return ((float)(upper - 1) + fraction) / SamplesPerSegment;
+}
@@ -0,0 +1,51 @@
+// CameraPath.h
+
+#ifndef CAMERA_PATH_H
+#define CAMERA_PATH_H
+
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// Catmull-Rom spline through a list of camera positions, sampled by
+// distance travelled so a camera following it moves at a constant speed
+// however unevenly the points are spaced. The camera looks along the path.
+class CameraPath
+{
+public:
+	// Arc length table entries per segment
+	static const int SamplesPerSegment = 32;
+
+	void addPoint(const glm::vec3& point);
+	void clear();
+
+	// One point per line as "x y z", blank lines and lines starting with # are skipped
+	bool load(const std::string& path);
+	bool save(const std::string& path) const;
+
+	const std::vector<glm::vec3>& getPoints() const;
+
+	// Total length in blocks, 0 with fewer than two points
+	float getLength() const;
+
+	// Position and unit view direction after travelling distance along the
+	// path, clamped to its ends
+	glm::vec3 getPosition(float distance) const;
+	glm::vec3 getDirection(float distance) const;
+
+private:
+	std::vector<glm::vec3> points;
+
+	// Distance along the path at each table entry, rebuilt when points change
+	mutable std::vector<float> arcLengths;
+	mutable bool arcLengthsDirty = true;
+
+	void rebuildArcLengths() const;
+
+	// t runs from 0 at the first point to (points - 1) at the last
+	glm::vec3 evaluate(float t) const;
+	float getParameter(float distance) const;
+};
+
+#endif
@@ -0,0 +1,302 @@
+// Chunk.cpp
+
+#include "Chunk.h"
+
+#include <new>
+
+#include "utilities/MemoryTracker.h"
+#include "utilities/Profiler.h"
+
+namespace
+{
+	// Bit index of every unordered face pair, -1 on the diagonal
+	const int FACE_PAIR_BITS[FACE_COUNT][FACE_COUNT] = {
+		{ -1,  0,  1,  2,  3,  4 },
+		{  0, -1,  5,  6,  7,  8 },
+		{  1,  5, -1,  9, 10, 11 },
+		{  2,  6,  9, -1, 12, 13 },
+		{  3,  7, 10, 12, -1, 14 },
+		{  4,  8, 11, 13, 14, -1 }
+	};
+
+	const uint16_t ALL_FACES_CONNECTED = 0x7FFF;
+}
+
+Chunk::Chunk(const glm::ivec3& position)
+	: Position(position), opaqueCount(0), visibilityMask(ALL_FACES_CONNECTED), visibilityDirty(false), occludersDirty(false)
+{
+	blocks.fill(BLOCK_AIR);
+}
+
+void* Chunk::operator new(size_t size)
+{
+	void* pointer = ::operator new(size);
+	MemoryTracker::add(MEMORY_CHUNKS, size);
+	return pointer;
+}
+
+void Chunk::operator delete(void* pointer, size_t size)
+{
+	MemoryTracker::remove(MEMORY_CHUNKS, size);
+	::operator delete(pointer);
+}
+
+int Chunk::getIndex(int x, int y, int z)
+{
+	return x + Size * (z + Size * y);
+}
+
+BlockId Chunk::getBlock(int x, int y, int z) const
+{
+	return blocks[getIndex(x, y, z)];
+}
+
+void Chunk::setBlock(int x, int y, int z, BlockId block)
+{
+	BlockId& current = blocks[getIndex(x, y, z)];
+	if (current == block)
+	{
+		return;
+	}
+
+	opaqueCount += (block != BLOCK_AIR) - (current != BLOCK_AIR);
+	current = block;
+	visibilityDirty = true;
+	occludersDirty = true;
+}
+
+bool Chunk::isOpaque(int x, int y, int z) const
+{
+	return getBlock(x, y, z) != BLOCK_AIR;
+}
+
+void Chunk::rebuildVisibility()
+{
+	if (!visibilityDirty)
+	{
+		return;
+	}
+	visibilityDirty = false;
+	PROFILE_SCOPE("Chunk visibility");
+
+	// Trivial cases skip the flood fill entirely
+	if (opaqueCount == 0)
+	{
+		visibilityMask = ALL_FACES_CONNECTED;
+		return;
+	}
+	if (opaqueCount == Volume)
+	{
+		visibilityMask = 0;
+		return;
+	}
+
+	visibilityMask = 0;
+
+	std::array<bool, Volume> visited = {};
+	std::array<int, Volume> stack;
+
+	for (int start = 0; start < Volume; start++)
+	{
+		if (visited[start] || blocks[start] != BLOCK_AIR)
+		{
+			continue;
+		}
+
+		// Flood one connected region of air and record which faces it touches
+		int touchedFaces = 0;
+		int stackSize = 0;
+		stack[stackSize++] = start;
+		visited[start] = true;
+
+		while (stackSize > 0)
+		{
+			int index = stack[--stackSize];
+			int x = index % Size;
+			int z = (index / Size) % Size;
+			int y = index / (Size * Size);
+
+			if (x == 0)        touchedFaces |= 1 << FACE_NEG_X;
+			if (x == Size - 1) touchedFaces |= 1 << FACE_POS_X;
+			if (y == 0)        touchedFaces |= 1 << FACE_NEG_Y;
+			if (y == Size - 1) touchedFaces |= 1 << FACE_POS_Y;
+			if (z == 0)        touchedFaces |= 1 << FACE_NEG_Z;
+			if (z == Size - 1) touchedFaces |= 1 << FACE_POS_Z;
+
+			const int neighbours[6][2] = {
+				{ x > 0,        index - 1 },
+				{ x < Size - 1, index + 1 },
+				{ z > 0,        index - Size },
+				{ z < Size - 1, index + Size },
+				{ y > 0,        index - Size * Size },
+				{ y < Size - 1, index + Size * Size }
+			};
+
+			for (const auto& neighbour : neighbours)
+			{
+				int next = neighbour[1];
+				if (neighbour[0] && !visited[next] && blocks[next] == BLOCK_AIR)
+				{
+					visited[next] = true;
+					stack[stackSize++] = next;
+				}
+			}
+		}
+
+		// Every pair of faces touched by the same region can see each other
+		for (int a = 0; a < FACE_COUNT; a++)
+		{
+			if (!(touchedFaces & (1 << a)))
+			{
+				continue;
+			}
+			for (int b = a + 1; b < FACE_COUNT; b++)
+			{
+				if (touchedFaces & (1 << b))
+				{
+					visibilityMask |= 1 << FACE_PAIR_BITS[a][b];
+				}
+			}
+		}
+
+		if (visibilityMask == ALL_FACES_CONNECTED)
+		{
+			break;
+		}
+	}
+}
+
+bool Chunk::areFacesConnected(int faceA, int faceB) const
+{
+	if (faceA == faceB)
+	{
+		return true;
+	}
+	return (visibilityMask >> FACE_PAIR_BITS[faceA][faceB]) & 1;
+}
+
+uint16_t Chunk::getVisibilityMask() const
+{
+	return visibilityMask;
+}
+
+void Chunk::rebuildOccluders()
+{
+	if (!occludersDirty)
+	{
+		return;
+	}
+	occludersDirty = false;
+	PROFILE_SCOPE("Chunk occluders");
+	occluders.clear();
+
+	if (opaqueCount < MinOccluderVolume)
+	{
+		return;
+	}
+
+	glm::vec3 origin = glm::vec3(Position * Size);
+	if (opaqueCount == Volume)
+	{
+		occluders.push_back(getBounds());
+		return;
+	}
+
+	std::array<bool, Volume> merged = {};
+	auto isFree = [&](int x, int y, int z)
+	{
+		int index = getIndex(x, y, z);
+		return !merged[index] && blocks[index] != BLOCK_AIR;
+	};
+
+	for (int y = 0; y < Size; y++)
+	{
+		for (int z = 0; z < Size; z++)
+		{
+			for (int x = 0; x < Size; x++)
+			{
+				if (!isFree(x, y, z))
+				{
+					continue;
+				}
+
+				// Grow along x, then z, then y while the whole slab stays solid
+				int endX = x + 1;
+				while (endX < Size && isFree(endX, y, z))
+				{
+					endX++;
+				}
+
+				int endZ = z + 1;
+				for (bool grow = true; grow && endZ < Size; )
+				{
+					for (int i = x; i < endX && grow; i++)
+					{
+						grow = isFree(i, y, endZ);
+					}
+					endZ += grow;
+				}
+
+				int endY = y + 1;
+				for (bool grow = true; grow && endY < Size; )
+				{
+					for (int k = z; k < endZ && grow; k++)
+					{
+						for (int i = x; i < endX && grow; i++)
+						{
+							grow = isFree(i, endY, k);
+						}
+					}
+					endY += grow;
+				}
+
+				for (int j = y; j < endY; j++)
+				{
+					for (int k = z; k < endZ; k++)
+					{
+						for (int i = x; i < endX; i++)
+						{
+							merged[getIndex(i, j, k)] = true;
+						}
+					}
+				}
+
+				if ((endX - x) * (endY - y) * (endZ - z) >= MinOccluderVolume)
+				{
+					occluders.push_back(BoundingBox(
+						origin + glm::vec3(x, y, z),
+						origin + glm::vec3(endX, endY, endZ)));
+				}
+			}
+		}
+	}
+}
+
+const std::vector<BoundingBox>& Chunk::getOccluders() const
+{
+	return occluders;
+}
+
+BoundingBox Chunk::getBounds() const
+{
+	glm::vec3 origin = glm::vec3(Position * Size);
+	return BoundingBox(origin, origin + glm::vec3((float)Size));
+}
+
+int Chunk::getFacePairBit(int faceA, int faceB)
+{
+	return FACE_PAIR_BITS[faceA][faceB];
+}
+
+glm::ivec3 Chunk::getFaceDirection(int face)
+{
+	static const glm::ivec3 directions[FACE_COUNT] = {
+		glm::ivec3(-1,  0,  0),
+		glm::ivec3( 1,  0,  0),
+		glm::ivec3( 0, -1,  0),
+		glm::ivec3( 0,  1,  0),
+		glm::ivec3( 0,  0, -1),
+		glm::ivec3( 0,  0,  1)
+	};
+	return directions[face];
+}
@@ -0,0 +1,87 @@
+// Chunk.h
+
+#ifndef CHUNK_H
+#define CHUNK_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "utilities/BoundingBox.h"
+
+typedef uint8_t BlockId;
+
+const BlockId BLOCK_AIR = 0;
+const BlockId BLOCK_STONE = 1;
+const BlockId BLOCK_DIRT = 2;
+const BlockId BLOCK_GRASS = 3;
+
+// The six faces of a chunk, ordered so that (face ^ 1) is the opposite face
+enum ChunkFace
+{
+	FACE_NEG_X = 0,
+	FACE_POS_X = 1,
+	FACE_NEG_Y = 2,
+	FACE_POS_Y = 3,
+	FACE_NEG_Z = 4,
+	FACE_POS_Z = 5,
+	FACE_COUNT = 6
+};
+
+class Chunk
+{
+public:
+	static const int Size = 16;
+	static const int Volume = Size * Size * Size;
+	static const int MinOccluderVolume = 64;
+
+	// Chunk coordinates, in units of chunks
+	glm::ivec3 Position;
+
+	Chunk(const glm::ivec3& position);
+
+	// Chunks are counted under MEMORY_CHUNKS
+	static void* operator new(size_t size);
+	static void operator delete(void* pointer, size_t size);
+
+	BlockId getBlock(int x, int y, int z) const;
+	void setBlock(int x, int y, int z, BlockId block);
+	bool isOpaque(int x, int y, int z) const;
+
+	// Flood fills the non-opaque voxels and records which pairs of faces
+	// can see each other through the chunk. Run this when the chunk is
+	// (re)meshed; it is a no-op if no block changed since the last run.
+	void rebuildVisibility();
+
+	bool areFacesConnected(int faceA, int faceB) const;
+	uint16_t getVisibilityMask() const;
+
+	// Greedily merges the opaque voxels into a few large world space boxes
+	// for the software occlusion buffer. Boxes smaller than
+	// MinOccluderVolume voxels are dropped since they rarely hide anything.
+	void rebuildOccluders();
+	const std::vector<BoundingBox>& getOccluders() const;
+
+	BoundingBox getBounds() const;
+
+	static int getFacePairBit(int faceA, int faceB);
+	static glm::ivec3 getFaceDirection(int face);
+
+private:
+	std::array<BlockId, Volume> blocks;
+	int opaqueCount;
+
+	// 15 bits, one per unordered pair of distinct faces
+	uint16_t visibilityMask;
+	bool visibilityDirty;
+
+	std::vector<BoundingBox> occluders;
+	bool occludersDirty;
+
+	static int getIndex(int x, int y, int z);
+};
+
+#endif
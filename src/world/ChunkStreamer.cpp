@@ -0,0 +1,139 @@
+// ChunkStreamer.cpp
+
+#include "ChunkStreamer.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "utilities/Profiler.h"
+
+ChunkStreamer::ChunkStreamer(World& world)
+	: world(world)
+{
+}
+
+std::vector<Chunk*>& ChunkStreamer::update(const glm::vec3& cameraPosition)
+{
+	PROFILE_SCOPE("Stream chunks");
+
+	Clock::time_point now = Clock::now();
+	glm::ivec3 cameraChunk = World::worldToChunk(cameraPosition);
+
+	// Unload first, so a chunk that leaves and comes back is requested again
+	unloaded.clear();
+	for (const auto& entry : world.getChunks())
+	{
+		glm::ivec2 offset(entry.first.x - cameraChunk.x, entry.first.z - cameraChunk.z);
+		if (offset.x * offset.x + offset.y * offset.y > UnloadRadius * UnloadRadius)
+		{
+			unloaded.push_back(entry.first);
+		}
+	}
+	for (const glm::ivec3& position : unloaded)
+	{
+		world.removeChunk(position);
+	}
+	stats.ChunksUnloaded += unloaded.size();
+
+	for (auto& entry : pending)
+	{
+		entry.second.Wanted = false;
+	}
+
+	candidates.clear();
+	for (int z = -LoadRadius; z <= LoadRadius; z++)
+	{
+		for (int x = -LoadRadius; x <= LoadRadius; x++)
+		{
+			if (x * x + z * z > LoadRadius * LoadRadius)
+			{
+				continue;
+			}
+
+			for (int y = 0; y < Layers; y++)
+			{
+				glm::ivec3 position(cameraChunk.x + x, y, cameraChunk.z + z);
+				if (world.getChunk(position))
+				{
+					continue;
+				}
+
+				auto inserted = pending.emplace(position, Request());
+				if (inserted.second)
+				{
+					inserted.first->second.Time = now;
+					stats.ChunksRequested++;
+				}
+				inserted.first->second.Wanted = true;
+
+				int dy = y - cameraChunk.y;
+				candidates.emplace_back(x * x + dy * dy + z * z, position);
+			}
+		}
+	}
+
+	// Requests the camera moved away from before they were built are dropped
+	for (auto it = pending.begin(); it != pending.end();)
+	{
+		it = it->second.Wanted ? std::next(it) : pending.erase(it);
+	}
+
+	size_t buildCount = std::min(candidates.size(), (size_t)std::max(BuildBudget, 0));
+	std::partial_sort(candidates.begin(), candidates.begin() + buildCount, candidates.end(),
+		[](const std::pair<int, glm::ivec3>& a, const std::pair<int, glm::ivec3>& b)
+		{
+			return a.first < b.first;
+		});
+
+	building.clear();
+	buildList.clear();
+	buildRequestTimes.clear();
+	for (size_t i = 0; i < buildCount; i++)
+	{
+		const glm::ivec3& position = candidates[i].second;
+		auto it = pending.find(position);
+		buildRequestTimes.push_back(it->second.Time);
+		pending.erase(it);
+
+		building.push_back(std::make_unique<Chunk>(position));
+		buildList.push_back(building.back().get());
+	}
+
+	return buildList;
+}
+
+void ChunkStreamer::finishBuilds()
+{
+	Clock::time_point now = Clock::now();
+	for (size_t i = 0; i < building.size(); i++)
+	{
+		latencies.push_back(std::chrono::duration<double, std::milli>(now - buildRequestTimes[i]).count());
+		world.addChunk(std::move(building[i]));
+	}
+	stats.ChunksBuilt += building.size();
+	stats.PeakChunksLoaded = std::max(stats.PeakChunksLoaded, world.getChunkCount());
+
+	building.clear();
+	buildList.clear();
+	buildRequestTimes.clear();
+}
+
+const std::vector<glm::ivec3>& ChunkStreamer::getUnloaded() const
+{
+	return unloaded;
+}
+
+size_t ChunkStreamer::getPendingCount() const
+{
+	return pending.size();
+}
+
+const std::vector<double>& ChunkStreamer::getLatencies() const
+{
+	return latencies;
+}
+
+const ChunkStreamer::Stats& ChunkStreamer::getStats() const
+{
+	return stats;
+}
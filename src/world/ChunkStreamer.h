@@ -0,0 +1,82 @@
+// ChunkStreamer.h
+
+#ifndef CHUNK_STREAMER_H
+#define CHUNK_STREAMER_H
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "world/World.h"
+
+// Keeps the chunks around the camera loaded. Every update requests the
+// missing chunks within LoadRadius, hands out the nearest few to build and
+// unloads chunks past UnloadRadius. Building is left to the caller (so it
+// can spread it over threads); a chunk only enters the world once it is
+// built, so culling never sees a half generated one. The time from request
+// to finished build is kept as the streaming latency.
+class ChunkStreamer
+{
+public:
+	struct Stats
+	{
+		size_t ChunksRequested = 0;
+		size_t ChunksBuilt = 0;
+		size_t ChunksUnloaded = 0;
+		size_t PeakChunksLoaded = 0;
+	};
+
+	// Horizontal distances in chunks, chunks outside [0, Layers) vertically are never loaded
+	int LoadRadius = 8;
+	int UnloadRadius = 10;
+	int Layers = 6;
+	// Chunks handed out to build per update
+	int BuildBudget = 64;
+
+	explicit ChunkStreamer(World& world);
+
+	// Returns the chunks to build this frame, nearest the camera first. They
+	// are empty and not yet part of the world.
+	std::vector<Chunk*>& update(const glm::vec3& cameraPosition);
+
+	// Adds the chunks returned by the last update to the world
+	void finishBuilds();
+
+	// Positions unloaded by the last update
+	const std::vector<glm::ivec3>& getUnloaded() const;
+
+	size_t getPendingCount() const;
+
+	// Milliseconds from request to finished build, one entry per built chunk
+	const std::vector<double>& getLatencies() const;
+
+	const Stats& getStats() const;
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	struct Request
+	{
+		Clock::time_point Time;
+		// Still within LoadRadius as of the last update
+		bool Wanted = false;
+	};
+
+	World& world;
+	std::unordered_map<glm::ivec3, Request, ChunkPositionHash> pending;
+	std::vector<std::pair<int, glm::ivec3>> candidates;
+	std::vector<std::unique_ptr<Chunk>> building;
+	std::vector<Chunk*> buildList;
+	std::vector<Clock::time_point> buildRequestTimes;
+	std::vector<glm::ivec3> unloaded;
+	std::vector<double> latencies;
+
+	Stats stats;
+};
+
+#endif
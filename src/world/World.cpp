@@ -0,0 +1,48 @@
+// World.cpp
+
+#include "World.h"
+
+#include <cmath>
+
+Chunk* World::getChunk(const glm::ivec3& position) const
+{
+	auto it = chunks.find(position);
+	return it != chunks.end() ? it->second.get() : nullptr;
+}
+
+Chunk& World::createChunk(const glm::ivec3& position)
+{
+	std::unique_ptr<Chunk>& chunk = chunks[position];
+	if (!chunk)
+	{
+		chunk = std::make_unique<Chunk>(position);
+	}
+	return *chunk;
+}
+
+Chunk& World::addChunk(std::unique_ptr<Chunk> chunk)
+{
+	std::unique_ptr<Chunk>& slot = chunks[chunk->Position];
+	slot = std::move(chunk);
+	return *slot;
+}
+
+void World::removeChunk(const glm::ivec3& position)
+{
+	chunks.erase(position);
+}
+
+const World::ChunkMap& World::getChunks() const
+{
+	return chunks;
+}
+
+size_t World::getChunkCount() const
+{
+	return chunks.size();
+}
+
+glm::ivec3 World::worldToChunk(const glm::vec3& worldPosition)
+{
+	return glm::ivec3(glm::floor(worldPosition / (float)Chunk::Size));
+}
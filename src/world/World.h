@@ -0,0 +1,45 @@
+// World.h
+
+#ifndef WORLD_H
+#define WORLD_H
+
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+
+#include <glm/glm.hpp>
+
+#include "Chunk.h"
+
+struct ChunkPositionHash
+{
+	size_t operator()(const glm::ivec3& position) const
+	{
+		size_t hash = (size_t)(uint32_t)position.x * 73856093u;
+		hash ^= (size_t)(uint32_t)position.y * 19349663u;
+		hash ^= (size_t)(uint32_t)position.z * 83492791u;
+		return hash;
+	}
+};
+
+class World
+{
+public:
+	typedef std::unordered_map<glm::ivec3, std::unique_ptr<Chunk>, ChunkPositionHash> ChunkMap;
+
+	Chunk* getChunk(const glm::ivec3& position) const;
+	Chunk& createChunk(const glm::ivec3& position);
+	// Takes over a chunk built outside the world, replacing any at its position
+	Chunk& addChunk(std::unique_ptr<Chunk> chunk);
+	void removeChunk(const glm::ivec3& position);
+
+	const ChunkMap& getChunks() const;
+	size_t getChunkCount() const;
+
+	static glm::ivec3 worldToChunk(const glm::vec3& worldPosition);
+
+private:
+	ChunkMap chunks;
+};
+
+#endif
@@ -0,0 +1,130 @@
+// WorldGenerator.cpp
+
+#include "WorldGenerator.h"
+
+#include <cmath>
+
+#include "utilities/Profiler.h"
+
+namespace
+{
+	float smooth(float t)
+	{
+		return t * t * (3.0f - 2.0f * t);
+	}
+
+	float lerp(float a, float b, float t)
+	{
+		return a + (b - a) * t;
+	}
+}
+
+WorldGenerator::WorldGenerator(uint32_t seed)
+	: seed(seed)
+{
+}
+
+uint32_t WorldGenerator::getSeed() const
+{
+	return seed;
+}
+
+float WorldGenerator::hash(int x, int y, int z) const
+{
+	uint32_t h = seed;
+	h ^= (uint32_t)x * 0x8DA6B343u;
+	h ^= (uint32_t)y * 0xD8163841u;
+	h ^= (uint32_t)z * 0xCB1AB31Fu;
+	h ^= h >> 15;
+	h *= 0x2C1B3C6Du;
+	h ^= h >> 12;
+	h *= 0x297A2D39u;
+	h ^= h >> 15;
+	return (float)(h & 0xFFFFFF) / (float)0xFFFFFF;
+}
+
+float WorldGenerator::noise2(float x, float z) const
+{
+	int x0 = (int)std::floor(x);
+	int z0 = (int)std::floor(z);
+	float tx = smooth(x - (float)x0);
+	float tz = smooth(z - (float)z0);
+
+	float front = lerp(hash(x0, 0, z0), hash(x0 + 1, 0, z0), tx);
+	float back = lerp(hash(x0, 0, z0 + 1), hash(x0 + 1, 0, z0 + 1), tx);
+	return lerp(front, back, tz);
+}
+
+float WorldGenerator::noise3(float x, float y, float z) const
+{
+	int x0 = (int)std::floor(x);
+	int y0 = (int)std::floor(y);
+	int z0 = (int)std::floor(z);
+	float tx = smooth(x - (float)x0);
+	float ty = smooth(y - (float)y0);
+	float tz = smooth(z - (float)z0);
+
+	float bottom = lerp(
+		lerp(hash(x0, y0, z0), hash(x0 + 1, y0, z0), tx),
+		lerp(hash(x0, y0, z0 + 1), hash(x0 + 1, y0, z0 + 1), tx), tz);
+	float top = lerp(
+		lerp(hash(x0, y0 + 1, z0), hash(x0 + 1, y0 + 1, z0), tx),
+		lerp(hash(x0, y0 + 1, z0 + 1), hash(x0 + 1, y0 + 1, z0 + 1), tx), tz);
+	return lerp(bottom, top, ty);
+}
+
+int WorldGenerator::getHeight(int worldX, int worldZ) const
+{
+	// Two octaves, broad hills with some roughness on top
+	float height = noise2(worldX / 64.0f, worldZ / 64.0f) * 0.75f + noise2(worldX / 16.0f, worldZ / 16.0f) * 0.25f;
+	return BaseHeight + (int)((height * 2.0f - 1.0f) * (float)HeightRange);
+}
+
+bool WorldGenerator::isCave(int worldX, int worldY, int worldZ) const
+{
+	// Squashed vertically so caves run as horizontal tunnels
+	return noise3(worldX / 12.0f, worldY / 6.0f, worldZ / 12.0f) > CaveThreshold;
+}
+
+void WorldGenerator::generate(Chunk& chunk) const
+{
+	PROFILE_SCOPE("Generate chunk");
+
+	glm::ivec3 origin = chunk.Position * Chunk::Size;
+
+	for (int z = 0; z < Chunk::Size; z++)
+	{
+		for (int x = 0; x < Chunk::Size; x++)
+		{
+			int worldX = origin.x + x;
+			int worldZ = origin.z + z;
+			int height = getHeight(worldX, worldZ);
+
+			for (int y = 0; y < Chunk::Size; y++)
+			{
+				int worldY = origin.y + y;
+				if (worldY > height)
+				{
+					break;
+				}
+
+				BlockId block = BLOCK_STONE;
+				if (worldY == height)
+				{
+					block = BLOCK_GRASS;
+				}
+				else if (worldY > height - 4)
+				{
+					block = BLOCK_DIRT;
+				}
+
+				if (worldY < height - CaveCeiling && isCave(worldX, worldY, worldZ))
+				{
+					block = BLOCK_AIR;
+				}
+
+				chunk.setBlock(x, y, z, block);
+			}
+		}
+	}
+}
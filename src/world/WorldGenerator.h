@@ -0,0 +1,42 @@
+// WorldGenerator.h
+
+#ifndef WORLD_GENERATOR_H
+#define WORLD_GENERATOR_H
+
+#include <cstdint>
+
+#include "Chunk.h"
+
+// Fills chunks from a seeded value noise heightmap with noise caves carved
+// out below the surface. Every block depends only on the seed and its world
+// position, so chunks can be generated in any order and on any thread.
+class WorldGenerator
+{
+public:
+	// Terrain height in blocks, the surface lies within BaseHeight +- HeightRange
+	int BaseHeight = 32;
+	int HeightRange = 24;
+
+	// Caves stay at least this many blocks below the surface
+	int CaveCeiling = 4;
+	float CaveThreshold = 0.62f;
+
+	explicit WorldGenerator(uint32_t seed = 1);
+
+	void generate(Chunk& chunk) const;
+
+	// Height of the topmost solid block in the column
+	int getHeight(int worldX, int worldZ) const;
+	bool isCave(int worldX, int worldY, int worldZ) const;
+
+	uint32_t getSeed() const;
+
+private:
+	uint32_t seed;
+
+	float hash(int x, int y, int z) const;
+	float noise2(float x, float z) const;
+	float noise3(float x, float y, float z) const;
+};
+
+#endif
@@ -0,0 +1,152 @@
+// CaveCullerTests.cpp
+
+#include <algorithm>
+
+#include "TestFramework.h"
+#include "rendering/CaveCuller.h"
+
+namespace
+{
+	void fillChunk(Chunk& chunk)
+	{
+		for (int y = 0; y < Chunk::Size; y++)
+		{
+			for (int z = 0; z < Chunk::Size; z++)
+			{
+				for (int x = 0; x < Chunk::Size; x++)
+				{
+					chunk.setBlock(x, y, z, BLOCK_STONE);
+				}
+			}
+		}
+	}
+
+	// A solid slab across the chunk at x = 8, splitting -X from +X
+	void addWallAcrossX(Chunk& chunk)
+	{
+		for (int y = 0; y < Chunk::Size; y++)
+		{
+			for (int z = 0; z < Chunk::Size; z++)
+			{
+				chunk.setBlock(Chunk::Size / 2, y, z, BLOCK_STONE);
+			}
+		}
+	}
+
+	bool contains(const std::vector<const Chunk*>& chunks, const Chunk* chunk)
+	{
+		return std::find(chunks.begin(), chunks.end(), chunk) != chunks.end();
+	}
+}
+
+TEST(CaveCuller, FacePairBitsAreUniqueAndSymmetric)
+{
+	int seen = 0;
+	for (int a = 0; a < FACE_COUNT; a++)
+	{
+		for (int b = 0; b < FACE_COUNT; b++)
+		{
+			if (a == b)
+			{
+				continue;
+			}
+			int bit = Chunk::getFacePairBit(a, b);
+			CHECK(bit >= 0 && bit < 15);
+			CHECK(bit == Chunk::getFacePairBit(b, a));
+			seen |= 1 << bit;
+		}
+	}
+	CHECK(seen == 0x7FFF);
+
+	for (int face = 0; face < FACE_COUNT; face++)
+	{
+		CHECK(Chunk::getFaceDirection(face) == -Chunk::getFaceDirection(face ^ 1));
+	}
+}
+
+TEST(CaveCuller, EmptyAndSolidChunkMasks)
+{
+	Chunk empty(glm::ivec3(0));
+	empty.rebuildVisibility();
+	CHECK(empty.getVisibilityMask() == 0x7FFF);
+
+	Chunk solid(glm::ivec3(0));
+	fillChunk(solid);
+	solid.rebuildVisibility();
+	CHECK(solid.getVisibilityMask() == 0);
+}
+
+TEST(CaveCuller, WallSeparatesOppositeFaces)
+{
+	Chunk chunk(glm::ivec3(0));
+	addWallAcrossX(chunk);
+	chunk.rebuildVisibility();
+
+	CHECK(!chunk.areFacesConnected(FACE_NEG_X, FACE_POS_X));
+	CHECK(chunk.areFacesConnected(FACE_NEG_X, FACE_POS_Y));
+	CHECK(chunk.areFacesConnected(FACE_POS_X, FACE_NEG_Z));
+	CHECK(chunk.areFacesConnected(FACE_NEG_Y, FACE_POS_Y));
+	CHECK(chunk.areFacesConnected(FACE_NEG_Z, FACE_POS_Z));
+}
+
+TEST(CaveCuller, TunnelConnectsOnlyItsEnds)
+{
+	Chunk chunk(glm::ivec3(0));
+	fillChunk(chunk);
+	for (int x = 0; x < Chunk::Size; x++)
+	{
+		chunk.setBlock(x, 8, 8, BLOCK_AIR);
+	}
+	chunk.rebuildVisibility();
+
+	CHECK(chunk.getVisibilityMask() == (1 << Chunk::getFacePairBit(FACE_NEG_X, FACE_POS_X)));
+
+	// Opening the wall again only takes effect after a rebuild
+	chunk.setBlock(4, 8, 8, BLOCK_STONE);
+	CHECK(chunk.areFacesConnected(FACE_NEG_X, FACE_POS_X));
+	chunk.rebuildVisibility();
+	CHECK(chunk.getVisibilityMask() == 0);
+}
+
+TEST(CaveCuller, WallsStopTheSearch)
+{
+	// A row of chunks along +X, the middle one walled off across X
+	World world;
+	Chunk& camera = world.createChunk(glm::ivec3(0, 0, 0));
+	Chunk& walled = world.createChunk(glm::ivec3(1, 0, 0));
+	Chunk& hidden = world.createChunk(glm::ivec3(2, 0, 0));
+	Chunk& behind = world.createChunk(glm::ivec3(-1, 0, 0));
+	addWallAcrossX(walled);
+	for (const auto& entry : world.getChunks())
+	{
+		entry.second->rebuildVisibility();
+	}
+
+	FrameArena arena;
+	CaveCuller culler;
+	glm::vec3 cameraPosition(8.0f, 8.0f, 8.0f);
+	const std::vector<const Chunk*>& visible = culler.cull(world, cameraPosition, glm::vec3(1.0f, 0.0f, 0.0f), arena);
+
+	CHECK(contains(visible, &camera));
+	CHECK(contains(visible, &walled));
+	CHECK(!contains(visible, &hidden));
+	CHECK(!contains(visible, &behind));
+	CHECK(culler.getStats().ChunksLoaded == 4);
+	CHECK(culler.getStats().ChunksVisible == 2);
+
+	// Knock the wall down and the far chunk shows up
+	walled.setBlock(Chunk::Size / 2, 8, 8, BLOCK_AIR);
+	walled.rebuildVisibility();
+	arena.reset();
+	CHECK(contains(culler.cull(world, cameraPosition, glm::vec3(1.0f, 0.0f, 0.0f), arena), &hidden));
+}
+
+TEST(CaveCuller, NoCameraChunkMeansNothingVisible)
+{
+	World world;
+	world.createChunk(glm::ivec3(1, 0, 0));
+
+	FrameArena arena;
+	CaveCuller culler;
+	CHECK(culler.cull(world, glm::vec3(-100.0f), glm::vec3(1.0f, 0.0f, 0.0f), arena).empty());
+}
@@ -0,0 +1,101 @@
+// FrameArenaTests.cpp
+
+#include <cstdint>
+
+#include "TestFramework.h"
+#include "utilities/ArenaAllocator.h"
+#include "utilities/FrameArena.h"
+
+TEST(FrameArena, AllocationsAreAligned)
+{
+	FrameArena arena(1024);
+	arena.allocate(1, 1);
+	for (size_t alignment = 1; alignment <= 64; alignment *= 2)
+	{
+		void* pointer = arena.allocate(3, alignment);
+		CHECK((uintptr_t)pointer % alignment == 0);
+	}
+}
+
+TEST(FrameArena, ResetRewindsToTheStart)
+{
+	FrameArena arena(1024);
+	void* first = arena.allocate(100, 8);
+	arena.allocate(100, 8);
+	CHECK(arena.getStats().UsedBytes >= 200);
+
+	arena.reset();
+	CHECK(arena.getStats().UsedBytes == 0);
+	CHECK(arena.allocate(100, 8) == first);
+	CHECK(arena.getStats().BlockAllocations == 1);
+}
+
+TEST(FrameArena, OverflowMergesIntoOneBlockOnReset)
+{
+	FrameArena arena(256);
+	for (int i = 0; i < 10; i++)
+	{
+		arena.allocate(200, 8);
+	}
+
+	FrameArena::Stats grown = arena.getStats();
+	CHECK(grown.BlockAllocations > 1);
+	CHECK(grown.UsedBytes >= 2000);
+
+	// One block of the whole capacity replaces the overflow blocks
+	arena.reset();
+	FrameArena::Stats merged = arena.getStats();
+	CHECK(merged.BlockAllocations == grown.BlockAllocations + 1);
+	CHECK(merged.CapacityBytes == grown.CapacityBytes);
+	CHECK(merged.PeakBytes == grown.UsedBytes);
+
+	// The same frame again fits without taking anything more from the heap
+	for (int i = 0; i < 10; i++)
+	{
+		arena.allocate(200, 8);
+	}
+	arena.reset();
+	CHECK(arena.getStats().BlockAllocations == merged.BlockAllocations);
+}
+
+TEST(FrameArena, LargeAllocationsGetTheirOwnBlock)
+{
+	FrameArena arena(64);
+	unsigned char* large = arena.allocateArray<unsigned char>(4096);
+	large[0] = 1;
+	large[4095] = 2;
+	CHECK(arena.getStats().CapacityBytes >= 4096 + 64);
+}
+
+TEST(FrameArena, ArenaVectorsUseTheArena)
+{
+	FrameArena arena(4096);
+	ArenaAllocator<int> allocator(arena);
+	ArenaVector<int> values(allocator);
+	for (int i = 0; i < 100; i++)
+	{
+		values.push_back(i);
+	}
+
+	CHECK(values.size() == 100 && values[99] == 99);
+	CHECK(arena.getStats().UsedBytes >= 100 * sizeof(int));
+	CHECK(arena.getStats().BlockAllocations == 1);
+}
+
+TEST(FrameArena, ArenasSumTheirStats)
+{
+	FrameArenas arenas(3, 1024);
+	CHECK(arenas.getThreadCount() == 3);
+	for (int thread = 0; thread < 3; thread++)
+	{
+		arenas.get(thread).allocate(100, 1);
+	}
+
+	FrameArena::Stats total = arenas.getStats();
+	CHECK(total.UsedBytes == 300);
+	CHECK(total.CapacityBytes == 3 * 1024);
+
+	arenas.reset();
+	CHECK(arenas.getStats().UsedBytes == 0);
+	CHECK(arenas.getStats().PeakBytes == 300);
+}
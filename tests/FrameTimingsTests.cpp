@@ -0,0 +1,52 @@
+// FrameTimingsTests.cpp
+
+#include "TestFramework.h"
+#include "utilities/FrameTimings.h"
+
+TEST(FrameTimings, PercentilesUseNearestRank)
+{
+	// 1..100 recorded out of order
+	FrameTimings timings;
+	for (int i = 0; i < 100; i++)
+	{
+		timings.record((double)((i * 37) % 100 + 1));
+	}
+
+	CHECK(timings.getPercentile(0.0) == 1.0);
+	CHECK(timings.getPercentile(1.0) == 1.0);
+	CHECK(timings.getPercentile(50.0) == 50.0);
+	CHECK(timings.getPercentile(95.0) == 95.0);
+	CHECK(timings.getPercentile(99.0) == 99.0);
+	CHECK(timings.getPercentile(99.5) == 100.0);
+	CHECK(timings.getPercentile(100.0) == 100.0);
+}
+
+TEST(FrameTimings, PercentilesClampAndHandleFewSamples)
+{
+	FrameTimings timings;
+	CHECK(timings.getPercentile(50.0) == 0.0);
+
+	timings.record(4.0);
+	CHECK(timings.getPercentile(0.0) == 4.0);
+	CHECK(timings.getPercentile(99.0) == 4.0);
+
+	timings.record(2.0);
+	timings.record(8.0);
+	CHECK(timings.getPercentile(-10.0) == 2.0);
+	CHECK(timings.getPercentile(50.0) == 4.0);
+	CHECK(timings.getPercentile(250.0) == 8.0);
+}
+
+TEST(FrameTimings, PercentilesLeaveTheSamplesInOrder)
+{
+	FrameTimings timings;
+	const double samples[] = { 5.0, 1.0, 3.0 };
+	for (double sample : samples)
+	{
+		timings.record(sample);
+	}
+	timings.getPercentile(50.0);
+
+	CHECK(timings.getSamples()[0] == 5.0 && timings.getSamples()[1] == 1.0 && timings.getSamples()[2] == 3.0);
+	CHECK(timings.getCountAbove(2.0) == 2);
+}
@@ -0,0 +1,228 @@
+// JobSystemTests.cpp
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "TestFramework.h"
+#include "utilities/JobSystem.h"
+
+TEST(JobSystem, WaitRunsEveryCountedJob)
+{
+	JobSystem jobs(4);
+	std::atomic<int> ran{ 0 };
+	JobCounter counter;
+	for (int i = 0; i < 1000; i++)
+	{
+		jobs.run([&ran]() { ran.fetch_add(1); }, &counter);
+	}
+	jobs.wait(counter);
+
+	CHECK(counter.isDone());
+	CHECK(counter.getPending() == 0);
+	CHECK(ran.load() == 1000);
+}
+
+TEST(JobSystem, MoreJobsThanThePoolHolds)
+{
+	JobSystem jobs(2);
+	std::atomic<int> ran{ 0 };
+	JobCounter counter;
+	for (int i = 0; i < JobSystem::JobPoolSize * 3; i++)
+	{
+		jobs.run([&ran]() { ran.fetch_add(1); }, &counter);
+	}
+	jobs.wait(counter);
+
+	CHECK(ran.load() == JobSystem::JobPoolSize * 3);
+}
+
+TEST(JobSystem, DependentJobsRunAfterTheirDependency)
+{
+	JobSystem jobs(4);
+	std::atomic<int> first{ 0 };
+	std::atomic<int> seenBySecond{ -1 };
+
+	JobCounter firstDone;
+	JobCounter secondDone;
+	for (int i = 0; i < 64; i++)
+	{
+		jobs.run([&first]()
+		{
+			std::this_thread::yield();
+			first.fetch_add(1);
+		}, &firstDone);
+	}
+	jobs.run([&first, &seenBySecond]() { seenBySecond.store(first.load()); }, &secondDone, JOB_PRIORITY_NORMAL, &firstDone);
+	jobs.wait(secondDone);
+
+	CHECK(firstDone.isDone());
+	CHECK(seenBySecond.load() == 64);
+}
+
+TEST(JobSystem, DependencyChainsRunInOrder)
+{
+	JobSystem jobs(3);
+	const int chainLength = 32;
+	std::vector<int> order;
+	order.reserve(chainLength);
+
+	// Each link waits on the one before it, so no two links ever overlap
+	std::vector<JobCounter> links(chainLength);
+	for (int i = 0; i < chainLength; i++)
+	{
+		jobs.run([&order, i]() { order.push_back(i); }, &links[i], JOB_PRIORITY_NORMAL, i > 0 ? &links[i - 1] : nullptr);
+	}
+	jobs.wait(links[chainLength - 1]);
+
+	CHECK((int)order.size() == chainLength);
+	for (int i = 0; i < (int)order.size(); i++)
+	{
+		CHECK(order[i] == i);
+	}
+}
+
+TEST(JobSystem, FinishedDependencyDoesNotDelay)
+{
+	JobSystem jobs(1);
+	JobCounter finished;
+	JobCounter counter;
+	bool ran = false;
+	jobs.run([&ran]() { ran = true; }, &counter, JOB_PRIORITY_NORMAL, &finished);
+	jobs.wait(counter);
+
+	CHECK(ran);
+}
+
+TEST(JobSystem, HigherPrioritiesRunFirst)
+{
+	// With one worker nothing runs until the main thread waits, so the order is exact
+	JobSystem jobs(1);
+	std::vector<int> order;
+	JobCounter counter;
+	jobs.run([&order]() { order.push_back(JOB_PRIORITY_LOW); }, &counter, JOB_PRIORITY_LOW);
+	jobs.run([&order]() { order.push_back(JOB_PRIORITY_NORMAL); }, &counter, JOB_PRIORITY_NORMAL);
+	jobs.run([&order]() { order.push_back(JOB_PRIORITY_HIGH); }, &counter, JOB_PRIORITY_HIGH);
+	CHECK(jobs.getQueuedCount() == 3);
+	jobs.wait(counter);
+
+	CHECK(order.size() == 3);
+	CHECK(order.size() == 3 && order[0] == JOB_PRIORITY_HIGH && order[1] == JOB_PRIORITY_NORMAL && order[2] == JOB_PRIORITY_LOW);
+	CHECK(jobs.getQueuedCount() == 0);
+}
+
+TEST(JobSystem, ParallelForCoversEveryIndexOnce)
+{
+	JobSystem jobs(4);
+	const int count = 10007;
+	std::vector<std::atomic<int>> visits(count);
+	for (std::atomic<int>& visit : visits)
+	{
+		visit.store(0);
+	}
+
+	jobs.parallelFor(count, [&visits](int begin, int end)
+	{
+		for (int i = begin; i < end; i++)
+		{
+			visits[i].fetch_add(1);
+		}
+	});
+
+	int wrongCounts = 0;
+	for (const std::atomic<int>& visit : visits)
+	{
+		wrongCounts += visit.load() != 1;
+	}
+	CHECK(wrongCounts == 0);
+}
+
+TEST(JobSystem, ParallelForBatchesAreContiguous)
+{
+	JobSystem jobs(4);
+	const int batchCount = 7;
+	std::vector<int> begins(batchCount, -1);
+	std::vector<int> ends(batchCount, -1);
+
+	jobs.parallelFor(100, [&begins, &ends](int begin, int end, int batch)
+	{
+		begins[batch] = begin;
+		ends[batch] = end;
+	}, batchCount);
+
+	CHECK(begins[0] == 0);
+	CHECK(ends[batchCount - 1] == 100);
+	for (int batch = 1; batch < batchCount; batch++)
+	{
+		CHECK(begins[batch] == ends[batch - 1]);
+	}
+}
+
+TEST(JobSystem, OutsideThreadsCanSubmitAndWait)
+{
+	JobSystem jobs(2);
+	std::atomic<int> ran{ 0 };
+
+	std::vector<std::thread> submitters;
+	for (int thread = 0; thread < 3; thread++)
+	{
+		submitters.emplace_back([&jobs, &ran]()
+		{
+			CHECK(jobs.getCurrentWorker() == -1);
+			JobCounter counter;
+			for (int i = 0; i < 500; i++)
+			{
+				jobs.run([&ran]() { ran.fetch_add(1); }, &counter);
+			}
+			jobs.wait(counter);
+		});
+	}
+	for (std::thread& submitter : submitters)
+	{
+		submitter.join();
+	}
+
+	CHECK(ran.load() == 1500);
+	CHECK(jobs.getStats().JobsRun == 1500);
+}
+
+TEST(JobSystem, OutsideThreadsWrappingTheSharedPool)
+{
+	// Several outside threads cycle through the one shared pool many times over
+	JobSystem jobs(2);
+	const int threadCount = 4;
+	const int jobsPerThread = JobSystem::JobPoolSize * 2;
+	std::atomic<int> ran{ 0 };
+
+	std::vector<std::thread> submitters;
+	for (int thread = 0; thread < threadCount; thread++)
+	{
+		submitters.emplace_back([&jobs, &ran]()
+		{
+			JobCounter counter;
+			for (int i = 0; i < jobsPerThread; i++)
+			{
+				jobs.run([&ran]() { ran.fetch_add(1); }, &counter);
+			}
+			jobs.wait(counter);
+		});
+	}
+	for (std::thread& submitter : submitters)
+	{
+		submitter.join();
+	}
+
+	CHECK(ran.load() == threadCount * jobsPerThread);
+}
+
+TEST(JobSystem, NestedSystemsRestoreTheCreatorsWorker)
+{
+	JobSystem outer(2);
+	CHECK(outer.getCurrentWorker() == 0);
+	{
+		JobSystem inner(2);
+		CHECK(inner.getCurrentWorker() == 0);
+		CHECK(outer.getCurrentWorker() == -1);
+	}
+	CHECK(outer.getCurrentWorker() == 0);
+}
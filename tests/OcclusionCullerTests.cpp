@@ -0,0 +1,161 @@
+// OcclusionCullerTests.cpp
+
+#include <algorithm>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "TestFramework.h"
+#include "rendering/OcclusionBuffer.h"
+#include "rendering/OcclusionCuller.h"
+#include "utilities/JobSystem.h"
+
+namespace
+{
+	// Camera at the origin looking down -Z
+	glm::mat4 getViewProjection()
+	{
+		glm::mat4 projection = glm::perspective(glm::radians(70.0f), 2.0f, 0.1f, 500.0f);
+		glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		return projection * view;
+	}
+
+	// A wall across the whole view, 10 units in front of the camera
+	void rasterizeWall(OcclusionBuffer& buffer, FrameArena& arena, JobSystem& jobs)
+	{
+		ArenaVector<BoundingBox> occluders{ ArenaAllocator<BoundingBox>(arena) };
+		occluders.push_back(BoundingBox(glm::vec3(-100.0f, -100.0f, -12.0f), glm::vec3(100.0f, 100.0f, -10.0f)));
+		buffer.rasterize(getViewProjection(), occluders, arena, jobs, 4);
+	}
+
+	void fillChunk(Chunk& chunk)
+	{
+		for (int y = 0; y < Chunk::Size; y++)
+		{
+			for (int z = 0; z < Chunk::Size; z++)
+			{
+				for (int x = 0; x < Chunk::Size; x++)
+				{
+					chunk.setBlock(x, y, z, BLOCK_STONE);
+				}
+			}
+		}
+	}
+}
+
+TEST(OcclusionCuller, WallHidesBoxesBehindIt)
+{
+	JobSystem jobs(2);
+	FrameArena arena;
+	OcclusionBuffer buffer;
+	rasterizeWall(buffer, arena, jobs);
+
+	CHECK(buffer.isOccluded(BoundingBox(glm::vec3(-1.0f, -1.0f, -30.0f), glm::vec3(1.0f, 1.0f, -28.0f))));
+	CHECK(buffer.isOccluded(BoundingBox(glm::vec3(5.0f, -3.0f, -80.0f), glm::vec3(9.0f, 3.0f, -60.0f))));
+}
+
+TEST(OcclusionCuller, BoxesInFrontOfTheWallStayVisible)
+{
+	JobSystem jobs(2);
+	FrameArena arena;
+	OcclusionBuffer buffer;
+	rasterizeWall(buffer, arena, jobs);
+
+	CHECK(!buffer.isOccluded(BoundingBox(glm::vec3(-1.0f, -1.0f, -6.0f), glm::vec3(1.0f, 1.0f, -4.0f))));
+	// Reaching through the wall is enough to be visible
+	CHECK(!buffer.isOccluded(BoundingBox(glm::vec3(-1.0f, -1.0f, -30.0f), glm::vec3(1.0f, 1.0f, -8.0f))));
+}
+
+TEST(OcclusionCuller, BoxesCrossingTheNearPlaneAreNeverCulled)
+{
+	JobSystem jobs(2);
+	FrameArena arena;
+	OcclusionBuffer buffer;
+	rasterizeWall(buffer, arena, jobs);
+
+	// Mostly behind the wall, but one end reaches behind the camera
+	CHECK(!buffer.isOccluded(BoundingBox(glm::vec3(-1.0f, -1.0f, -40.0f), glm::vec3(1.0f, 1.0f, 5.0f))));
+
+	// An occluder crossing the near plane is dropped rather than clipped
+	ArenaVector<BoundingBox> occluders{ ArenaAllocator<BoundingBox>(arena) };
+	occluders.push_back(BoundingBox(glm::vec3(-100.0f, -100.0f, -12.0f), glm::vec3(100.0f, 100.0f, 1.0f)));
+	buffer.rasterize(getViewProjection(), occluders, arena, jobs, 4);
+	CHECK(!buffer.isOccluded(BoundingBox(glm::vec3(-1.0f, -1.0f, -30.0f), glm::vec3(1.0f, 1.0f, -28.0f))));
+}
+
+TEST(OcclusionCuller, MipsHoldTheMaximumOfTheirChildren)
+{
+	JobSystem jobs(2);
+	FrameArena arena;
+	OcclusionBuffer buffer(100, 50);
+
+	// Occluders at different depths covering part of the view, so the levels are not uniform
+	ArenaVector<BoundingBox> occluders{ ArenaAllocator<BoundingBox>(arena) };
+	occluders.push_back(BoundingBox(glm::vec3(-3.0f, -2.0f, -6.0f), glm::vec3(1.0f, 2.0f, -5.0f)));
+	occluders.push_back(BoundingBox(glm::vec3(0.0f, -8.0f, -25.0f), glm::vec3(12.0f, 1.0f, -20.0f)));
+	buffer.rasterize(getViewProjection(), occluders, arena, jobs, 3);
+
+	CHECK(buffer.getMipCount() > 1);
+	CHECK(buffer.getDepth(buffer.getMipCount() - 1, 0, 0) == 1.0f);
+
+	int width = buffer.getWidth();
+	int height = buffer.getHeight();
+	int wrongTexels = 0;
+	int coveredTexels = 0;
+	for (int level = 1; level < buffer.getMipCount(); level++)
+	{
+		int levelWidth = std::max(1, (width + 1) / 2);
+		int levelHeight = std::max(1, (height + 1) / 2);
+		for (int y = 0; y < levelHeight; y++)
+		{
+			for (int x = 0; x < levelWidth; x++)
+			{
+				// Odd sizes repeat the last row or column
+				int x0 = std::min(x * 2, width - 1);
+				int x1 = std::min(x * 2 + 1, width - 1);
+				int y0 = std::min(y * 2, height - 1);
+				int y1 = std::min(y * 2 + 1, height - 1);
+				float expected = std::max(
+					std::max(buffer.getDepth(level - 1, x0, y0), buffer.getDepth(level - 1, x1, y0)),
+					std::max(buffer.getDepth(level - 1, x0, y1), buffer.getDepth(level - 1, x1, y1)));
+
+				wrongTexels += buffer.getDepth(level, x, y) != expected;
+				coveredTexels += level == 1 && expected < 1.0f;
+			}
+		}
+		width = levelWidth;
+		height = levelHeight;
+	}
+
+	CHECK(wrongTexels == 0);
+	CHECK(coveredTexels > 0);
+}
+
+TEST(OcclusionCuller, SolidChunkHidesTheChunksBehindIt)
+{
+	// Camera in the middle of chunk (0, 0, 0) looking down -Z at a solid chunk
+	Chunk wall(glm::ivec3(0, 0, -1));
+	Chunk hidden(glm::ivec3(0, 0, -3));
+	Chunk beside(glm::ivec3(-3, 0, -1));
+	fillChunk(wall);
+	wall.rebuildOccluders();
+	hidden.rebuildOccluders();
+	beside.rebuildOccluders();
+
+	glm::vec3 cameraPosition(8.0f, 8.0f, 8.0f);
+	glm::mat4 projection = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, 500.0f);
+	glm::mat4 view = glm::lookAt(cameraPosition, cameraPosition + glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+	JobSystem jobs(2);
+	FrameArena arena;
+	OcclusionCuller culler;
+	std::vector<const Chunk*> candidates = { &wall, &hidden, &beside };
+	const std::vector<const Chunk*>& visible = culler.cull(candidates, cameraPosition, projection * view, arena, jobs);
+
+	CHECK(std::find(visible.begin(), visible.end(), &wall) != visible.end());
+	CHECK(std::find(visible.begin(), visible.end(), &hidden) == visible.end());
+	// Off screen chunks are left to frustum culling
+	CHECK(std::find(visible.begin(), visible.end(), &beside) != visible.end());
+	CHECK(culler.getStats().OccluderBoxes == 1);
+	CHECK(culler.getStats().ChunksTested == 3);
+	CHECK(culler.getStats().ChunksOccluded == 1);
+}
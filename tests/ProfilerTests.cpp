@@ -0,0 +1,110 @@
+// ProfilerTests.cpp
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "TestFramework.h"
+#include "utilities/Profiler.h"
+
+namespace
+{
+	void recordZones(int count)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			Profiler::record("Test zone", (uint64_t)i, (uint64_t)i + 1);
+		}
+	}
+}
+
+TEST(Profiler, FlushKeepsNothingWithoutACapture)
+{
+	Profiler::endCapture();
+	Profiler::flush();
+	Profiler::clear();
+
+	recordZones(100);
+	Profiler::flush();
+	CHECK(!Profiler::isCapturing());
+	CHECK(Profiler::getEventCount() == 0);
+	CHECK(Profiler::getDroppedCount() == 0);
+}
+
+TEST(Profiler, CaptureKeepsTheMostRecentZones)
+{
+	Profiler::flush();
+	Profiler::beginCapture(64);
+	CHECK(Profiler::isCapturing());
+
+	recordZones(50);
+	Profiler::flush();
+	CHECK(Profiler::getEventCount() == 50);
+	CHECK(Profiler::getDroppedCount() == 0);
+
+	// Past the capacity the oldest zones are overwritten, the count stays put
+	recordZones(50);
+	Profiler::flush();
+	CHECK(Profiler::getEventCount() == 64);
+	CHECK(Profiler::getDroppedCount() == 36);
+
+	Profiler::clear();
+	CHECK(Profiler::getEventCount() == 0);
+	CHECK(Profiler::isCapturing());
+
+	Profiler::endCapture();
+	recordZones(10);
+	Profiler::flush();
+	CHECK(Profiler::getEventCount() == 0);
+}
+
+TEST(Profiler, ZonesLappedBeforeAFlushAreDropped)
+{
+	Profiler::flush();
+	Profiler::beginCapture(Profiler::RingCapacity * 2);
+	Profiler::clear();
+
+	recordZones((int)Profiler::RingCapacity + 10);
+	Profiler::flush();
+	// The oldest zone of a full ring is where the writer goes next, so it is not trusted either
+	CHECK(Profiler::getEventCount() == Profiler::RingCapacity - 1);
+	CHECK(Profiler::getDroppedCount() == 11);
+
+	Profiler::endCapture();
+	Profiler::clear();
+}
+
+TEST(Profiler, TrackZonesAreKeptOnlyWhileCapturing)
+{
+	uint32_t track = Profiler::addTrack("Test track");
+	CHECK(Profiler::addTrack("Test track") == track);
+	CHECK(Profiler::addTrack("Other test track") != track);
+
+	Profiler::endCapture();
+	Profiler::recordTrack(track, "Test pass", 10, 20);
+	CHECK(Profiler::getEventCount() == 0);
+
+	Profiler::flush();
+	Profiler::beginCapture(64);
+	std::string name = "Test pass";
+	Profiler::recordTrack(track, name, 10, 20);
+	// The name is copied, the caller's string may go away
+	name = "Changed";
+	CHECK(Profiler::getEventCount() == 1);
+
+	const char* path = "profiler_track_test.json";
+	CHECK(Profiler::writeChromeTrace(path));
+	std::ifstream input(path);
+	std::stringstream trace;
+	trace << input.rdbuf();
+	input.close();
+	std::remove(path);
+
+	std::string tid = "\"tid\":" + std::to_string(track);
+	CHECK(trace.str().find("\"args\":{\"name\":\"Test track\"}") != std::string::npos);
+	CHECK(trace.str().find("{\"name\":\"Test pass\",\"ph\":\"X\",\"pid\":1," + tid + ",") != std::string::npos);
+
+	Profiler::endCapture();
+	Profiler::clear();
+}
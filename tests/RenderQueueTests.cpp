@@ -0,0 +1,144 @@
+// RenderQueueTests.cpp
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "TestFramework.h"
+#include "rendering/RenderQueue.h"
+#include "utilities/JobSystem.h"
+
+namespace
+{
+	bool isSortedAndStable(const ArenaVector<RenderQueue::SortEntry>& entries)
+	{
+		for (size_t i = 1; i < entries.size(); i++)
+		{
+			const RenderQueue::SortEntry& previous = entries[i - 1];
+			const RenderQueue::SortEntry& current = entries[i];
+			if (previous.Key > current.Key || (previous.Key == current.Key && previous.Index > current.Index))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+TEST(RenderQueue, RadixSortIsStable)
+{
+	FrameArena arena;
+	ArenaAllocator<RenderQueue::SortEntry> allocator(arena);
+	ArenaVector<RenderQueue::SortEntry> entries(allocator);
+	ArenaVector<RenderQueue::SortEntry> scratch(allocator);
+
+	// Few distinct keys, spread over every byte, so most entries tie with many others
+	std::mt19937_64 random(42);
+	for (uint32_t i = 0; i < 5000; i++)
+	{
+		uint64_t key = (random() % 16) * 0x0101010101010101ull;
+		entries.push_back({ key, i });
+	}
+
+	RenderQueue::radixSort(entries, scratch);
+	CHECK(entries.size() == 5000);
+	CHECK(isSortedAndStable(entries));
+}
+
+TEST(RenderQueue, RadixSortSkipsSharedBytes)
+{
+	FrameArena arena;
+	ArenaAllocator<RenderQueue::SortEntry> allocator(arena);
+	ArenaVector<RenderQueue::SortEntry> entries(allocator);
+	ArenaVector<RenderQueue::SortEntry> scratch(allocator);
+
+	// Only the top byte differs, every other pass is skipped
+	const uint64_t topBytes[] = { 3, 1, 2, 1, 0, 3 };
+	for (uint32_t i = 0; i < 6; i++)
+	{
+		entries.push_back({ (topBytes[i] << 56) | 0x00ABCDEF12345678ull, i });
+	}
+
+	RenderQueue::radixSort(entries, scratch);
+	CHECK(isSortedAndStable(entries));
+	CHECK(entries[0].Index == 4);
+	CHECK(entries[1].Index == 1 && entries[2].Index == 3);
+	CHECK(entries[4].Index == 0 && entries[5].Index == 5);
+}
+
+TEST(RenderQueue, RadixSortHandlesEmptyAndSingleInputs)
+{
+	FrameArena arena;
+	ArenaAllocator<RenderQueue::SortEntry> allocator(arena);
+	ArenaVector<RenderQueue::SortEntry> entries(allocator);
+	ArenaVector<RenderQueue::SortEntry> scratch(allocator);
+
+	RenderQueue::radixSort(entries, scratch);
+	CHECK(entries.empty());
+
+	entries.push_back({ 7, 0 });
+	RenderQueue::radixSort(entries, scratch);
+	CHECK(entries.size() == 1 && entries[0].Key == 7);
+}
+
+TEST(RenderQueue, KeysOrderByPassThenStateThenDepth)
+{
+	uint64_t nearOpaque = RenderQueue::makeKey(RenderQueue::PASS_OPAQUE, 5, 9, 1.0f);
+	uint64_t farOpaque = RenderQueue::makeKey(RenderQueue::PASS_OPAQUE, 5, 9, 100.0f);
+	uint64_t otherProgram = RenderQueue::makeKey(RenderQueue::PASS_OPAQUE, 6, 0, 0.0f);
+	uint64_t nearTransparent = RenderQueue::makeKey(RenderQueue::PASS_TRANSPARENT, 0, 0, 1.0f, true);
+	uint64_t farTransparent = RenderQueue::makeKey(RenderQueue::PASS_TRANSPARENT, 0, 0, 100.0f, true);
+
+	CHECK(nearOpaque < farOpaque);
+	CHECK(farOpaque < otherProgram);
+	CHECK(otherProgram < farTransparent);
+	CHECK(farTransparent < nearTransparent);
+	CHECK(RenderQueue::getPass(nearTransparent) == RenderQueue::PASS_TRANSPARENT);
+}
+
+TEST(RenderQueue, RecordedPacketsSortTheSameOnAnyWorkerCount)
+{
+	const int itemCount = 2000;
+	std::vector<MeshHandle> firstOrder;
+
+	for (int workers : { 1, 3 })
+	{
+		JobSystem jobs(workers);
+		RenderQueue renderQueue(4);
+		FrameArenas arenas(renderQueue.getMaxThreads());
+		renderQueue.beginFrame(arenas);
+		renderQueue.record(itemCount, jobs, [](RenderQueue::Recorder& recorder, int item)
+		{
+			// Ties on the key keep submission order, Mesh tells the items apart
+			DrawPacket packet;
+			packet.Key = RenderQueue::makeKey(RenderQueue::PASS_OPAQUE, item % 7, 0, (float)(item % 11));
+			packet.Mesh = (MeshHandle)item;
+			recorder.submit(packet);
+		});
+		renderQueue.sort();
+
+		const std::vector<DrawPacket>& sorted = renderQueue.getSorted();
+		CHECK((int)sorted.size() == itemCount);
+		CHECK(renderQueue.getStats().PacketsSubmitted == itemCount);
+
+		std::vector<MeshHandle> order;
+		for (size_t i = 0; i < sorted.size(); i++)
+		{
+			order.push_back(sorted[i].Mesh);
+			if (i > 0)
+			{
+				CHECK(sorted[i - 1].Key < sorted[i].Key || (sorted[i - 1].Key == sorted[i].Key && sorted[i - 1].Mesh < sorted[i].Mesh));
+			}
+		}
+
+		if (firstOrder.empty())
+		{
+			firstOrder = order;
+		}
+		else
+		{
+			CHECK(order == firstOrder);
+		}
+	}
+}
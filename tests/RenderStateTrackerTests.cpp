@@ -0,0 +1,147 @@
+// RenderStateTrackerTests.cpp
+
+#include "TestFramework.h"
+#include "rendering/RenderStateTracker.h"
+
+namespace
+{
+	// Stand-ins for GL enums, the tracker only compares them
+	const uint32_t TEXTURE_2D = 0x0DE1;
+	const uint32_t TEXTURE_2D_ARRAY = 0x8C1A;
+	const uint32_t ARRAY_BUFFER = 0x8892;
+	const uint32_t ELEMENT_ARRAY_BUFFER = 0x8893;
+	const uint32_t DEPTH_TEST = 0x0B71;
+	const uint32_t BLEND = 0x0BE2;
+}
+
+TEST(RenderStateTracker, FirstCallAlwaysIssues)
+{
+	RenderStateTracker tracker;
+	CHECK(tracker.useProgram(0));
+	CHECK(tracker.bindVertexArray(0));
+	CHECK(tracker.activeTexture(0));
+	CHECK(tracker.bindTexture(0, TEXTURE_2D, 0));
+	CHECK(tracker.bindBuffer(ARRAY_BUFFER, 0));
+	CHECK(tracker.setCapability(DEPTH_TEST, false));
+	CHECK(tracker.depthMask(true));
+	CHECK(tracker.getStats().CallsIssued == 7);
+	CHECK(tracker.getStats().CallsAvoided == 0);
+}
+
+TEST(RenderStateTracker, RedundantCallsAreElided)
+{
+	RenderStateTracker tracker;
+	CHECK(tracker.useProgram(3));
+	CHECK(!tracker.useProgram(3));
+	CHECK(tracker.useProgram(4));
+
+	CHECK(tracker.bindVertexArray(7));
+	CHECK(!tracker.bindVertexArray(7));
+
+	CHECK(tracker.blendFunc(1, 2));
+	CHECK(!tracker.blendFunc(1, 2));
+	CHECK(tracker.blendFunc(1, 3));
+
+	CHECK(tracker.colorMask(true, true, true, false));
+	CHECK(!tracker.colorMask(true, true, true, false));
+	CHECK(tracker.colorMask(true, true, true, true));
+
+	CHECK(tracker.depthFunc(0x0201));
+	CHECK(!tracker.depthFunc(0x0201));
+	CHECK(tracker.cullFace(0x0405));
+	CHECK(!tracker.cullFace(0x0405));
+	CHECK(tracker.polygonMode(0x1B02));
+	CHECK(!tracker.polygonMode(0x1B02));
+
+	CHECK(tracker.getStats().CallsIssued == 10);
+	CHECK(tracker.getStats().CallsAvoided == 7);
+
+	tracker.resetStats();
+	CHECK(tracker.getStats().CallsIssued == 0 && tracker.getStats().CallsAvoided == 0);
+}
+
+TEST(RenderStateTracker, TexturesAreTrackedPerUnitAndTarget)
+{
+	RenderStateTracker tracker;
+	CHECK(tracker.bindTexture(0, TEXTURE_2D, 5));
+	CHECK(!tracker.bindTexture(0, TEXTURE_2D, 5));
+
+	// Same name on another unit or another target is a different binding
+	CHECK(tracker.bindTexture(1, TEXTURE_2D, 5));
+	CHECK(tracker.bindTexture(0, TEXTURE_2D_ARRAY, 5));
+	CHECK(!tracker.bindTexture(0, TEXTURE_2D, 5));
+	CHECK(!tracker.bindTexture(0, TEXTURE_2D_ARRAY, 5));
+
+	// Units past the tracked range are never elided
+	CHECK(tracker.bindTexture(RenderStateTracker::MaxTextureUnits, TEXTURE_2D, 5));
+	CHECK(tracker.bindTexture(RenderStateTracker::MaxTextureUnits, TEXTURE_2D, 5));
+}
+
+TEST(RenderStateTracker, BuffersAndCapabilitiesAreTrackedPerTarget)
+{
+	RenderStateTracker tracker;
+	CHECK(tracker.bindBuffer(ARRAY_BUFFER, 2));
+	CHECK(tracker.bindBuffer(ELEMENT_ARRAY_BUFFER, 2));
+	CHECK(!tracker.bindBuffer(ARRAY_BUFFER, 2));
+	CHECK(tracker.bindBuffer(ARRAY_BUFFER, 0));
+
+	CHECK(tracker.setCapability(DEPTH_TEST, true));
+	CHECK(tracker.setCapability(BLEND, false));
+	CHECK(!tracker.setCapability(DEPTH_TEST, true));
+	CHECK(!tracker.setCapability(BLEND, false));
+	CHECK(tracker.setCapability(BLEND, true));
+}
+
+TEST(RenderStateTracker, EvictedTargetsAreReissued)
+{
+	RenderStateTracker tracker;
+	for (int target = 0; target < RenderStateTracker::MaxBufferTargets; target++)
+	{
+		CHECK(tracker.bindBuffer(100 + target, 1));
+	}
+
+	// One target too many takes the last slot, so the target it held is unknown again
+	uint32_t lastTarget = 100 + RenderStateTracker::MaxBufferTargets - 1;
+	CHECK(tracker.bindBuffer(999, 1));
+	CHECK(!tracker.bindBuffer(100, 1));
+	CHECK(tracker.bindBuffer(lastTarget, 1));
+}
+
+TEST(RenderStateTracker, InvalidateForgetsEverything)
+{
+	RenderStateTracker tracker;
+	tracker.useProgram(3);
+	tracker.bindVertexArray(7);
+	tracker.activeTexture(2);
+	tracker.bindTexture(2, TEXTURE_2D, 5);
+	tracker.bindBuffer(ARRAY_BUFFER, 9);
+	tracker.setCapability(DEPTH_TEST, true);
+	tracker.blendFunc(1, 2);
+	tracker.depthFunc(0x0201);
+	tracker.depthMask(false);
+	tracker.colorMask(true, false, true, false);
+	tracker.cullFace(0x0405);
+	tracker.polygonMode(0x1B02);
+
+	// Code outside the tracker may have changed any of it, so nothing may be skipped
+	tracker.invalidate();
+	tracker.resetStats();
+	CHECK(tracker.useProgram(3));
+	CHECK(tracker.bindVertexArray(7));
+	CHECK(tracker.activeTexture(2));
+	CHECK(tracker.bindTexture(2, TEXTURE_2D, 5));
+	CHECK(tracker.bindBuffer(ARRAY_BUFFER, 9));
+	CHECK(tracker.setCapability(DEPTH_TEST, true));
+	CHECK(tracker.blendFunc(1, 2));
+	CHECK(tracker.depthFunc(0x0201));
+	CHECK(tracker.depthMask(false));
+	CHECK(tracker.colorMask(true, false, true, false));
+	CHECK(tracker.cullFace(0x0405));
+	CHECK(tracker.polygonMode(0x1B02));
+	CHECK(tracker.getStats().CallsIssued == 12);
+	CHECK(tracker.getStats().CallsAvoided == 0);
+
+	// And once re-issued, the state is tracked again
+	CHECK(!tracker.useProgram(3));
+	CHECK(!tracker.bindTexture(2, TEXTURE_2D, 5));
+}
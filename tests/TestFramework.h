@@ -0,0 +1,43 @@
+// TestFramework.h
+
+#ifndef TEST_FRAMEWORK_H
+#define TEST_FRAMEWORK_H
+
+#include <vector>
+
+// Just enough of a test framework for the core. TEST registers a function
+// under a suite, CHECK records a failure and carries on so one run reports
+// every broken expectation.
+struct TestCase
+{
+	const char* Suite;
+	const char* Name;
+	void (*Function)();
+};
+
+std::vector<TestCase>& getTestCases();
+void reportFailure(const char* file, int line, const char* expression);
+
+struct TestRegistrar
+{
+	TestRegistrar(const char* suite, const char* name, void (*function)())
+	{
+		getTestCases().push_back({ suite, name, function });
+	}
+};
+
+#define TEST(suite, name) \
+	static void suite##_##name(); \
+	static TestRegistrar suite##_##name##_registrar(#suite, #name, suite##_##name); \
+	static void suite##_##name()
+
+#define CHECK(expression) \
+	do \
+	{ \
+		if (!(expression)) \
+		{ \
+			reportFailure(__FILE__, __LINE__, #expression); \
+		} \
+	} while (0)
+
+#endif
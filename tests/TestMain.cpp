@@ -0,0 +1,60 @@
+// TestMain.cpp
+//
+// Runs every registered test, or only the suites named on the command line.
+// Exits non-zero if any check failed, which is what ctest looks at.
+
+#include <cstring>
+#include <iostream>
+
+#include "TestFramework.h"
+
+namespace
+{
+	int failures = 0;
+}
+
+std::vector<TestCase>& getTestCases()
+{
+	static std::vector<TestCase> testCases;
+	return testCases;
+}
+
+void reportFailure(const char* file, int line, const char* expression)
+{
+	std::cout << file << ':' << line << ": CHECK(" << expression << ") failed\n";
+	failures++;
+}
+
+int main(int argc, char** argv)
+{
+	int testsRun = 0;
+	int testsFailed = 0;
+	for (const TestCase& testCase : getTestCases())
+	{
+		bool selected = argc < 2;
+		for (int i = 1; i < argc; i++)
+		{
+			selected = selected || std::strcmp(argv[i], testCase.Suite) == 0;
+		}
+		if (!selected)
+		{
+			continue;
+		}
+
+		int failuresBefore = failures;
+		testCase.Function();
+		testsRun++;
+
+		bool passed = failures == failuresBefore;
+		testsFailed += passed ? 0 : 1;
+		std::cout << (passed ? "PASS " : "FAIL ") << testCase.Suite << '.' << testCase.Name << '\n';
+	}
+
+	std::cout << testsRun - testsFailed << " of " << testsRun << " tests passed\n";
+	if (testsRun == 0)
+	{
+		std::cout << "ERROR::TESTS::NO_TESTS_SELECTED\n";
+		return 1;
+	}
+	return testsFailed > 0 ? 1 : 0;
+}
@@ -0,0 +1,129 @@
+// WorkStealingDequeTests.cpp
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "TestFramework.h"
+#include "utilities/WorkStealingDeque.h"
+
+TEST(WorkStealingDeque, OwnerPopsNewestFirst)
+{
+	int items[3] = { 0, 1, 2 };
+	WorkStealingDeque<int> deque(4);
+	for (int& item : items)
+	{
+		CHECK(deque.push(&item));
+	}
+
+	CHECK(deque.pop() == &items[2]);
+	CHECK(deque.pop() == &items[1]);
+	CHECK(deque.pop() == &items[0]);
+	CHECK(deque.pop() == nullptr);
+}
+
+TEST(WorkStealingDeque, ThievesStealOldestFirst)
+{
+	int items[3] = { 0, 1, 2 };
+	WorkStealingDeque<int> deque(4);
+	for (int& item : items)
+	{
+		deque.push(&item);
+	}
+
+	CHECK(deque.steal() == &items[0]);
+	CHECK(deque.steal() == &items[1]);
+	CHECK(deque.pop() == &items[2]);
+	CHECK(deque.steal() == nullptr);
+}
+
+TEST(WorkStealingDeque, PushFailsWhenFull)
+{
+	int items[5] = {};
+	WorkStealingDeque<int> deque(4);
+	for (int i = 0; i < 4; i++)
+	{
+		CHECK(deque.push(&items[i]));
+	}
+	CHECK(!deque.push(&items[4]));
+
+	// Stealing one makes room again, and the ring wraps around correctly
+	CHECK(deque.steal() == &items[0]);
+	CHECK(deque.push(&items[4]));
+	CHECK(deque.pop() == &items[4]);
+}
+
+TEST(WorkStealingDeque, EveryItemIsTakenExactlyOnce)
+{
+	const int itemCount = 100000;
+	const int thiefCount = 3;
+
+	std::vector<int> items(itemCount);
+	std::vector<std::atomic<int>> taken(itemCount);
+	for (std::atomic<int>& count : taken)
+	{
+		count.store(0);
+	}
+
+	WorkStealingDeque<int> deque(256);
+	std::atomic<bool> done{ false };
+	auto take = [&](int* item)
+	{
+		taken[item - items.data()].fetch_add(1);
+	};
+
+	std::vector<std::thread> thieves;
+	for (int thief = 0; thief < thiefCount; thief++)
+	{
+		thieves.emplace_back([&]()
+		{
+			while (!done.load())
+			{
+				if (int* item = deque.steal())
+				{
+					take(item);
+				}
+				else
+				{
+					std::this_thread::yield();
+				}
+			}
+		});
+	}
+
+	// The owner mixes pushes and pops so both ends are contended
+	for (int i = 0; i < itemCount; i++)
+	{
+		while (!deque.push(&items[i]))
+		{
+			if (int* item = deque.pop())
+			{
+				take(item);
+			}
+		}
+		if (i % 3 == 0)
+		{
+			if (int* item = deque.pop())
+			{
+				take(item);
+			}
+		}
+	}
+	while (int* item = deque.pop())
+	{
+		take(item);
+	}
+
+	done.store(true);
+	for (std::thread& thief : thieves)
+	{
+		thief.join();
+	}
+
+	int wrongCounts = 0;
+	for (const std::atomic<int>& count : taken)
+	{
+		wrongCounts += count.load() != 1;
+	}
+	CHECK(wrongCounts == 0);
+}